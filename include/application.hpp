@@ -101,6 +101,23 @@ protected:
 									  ", or '" + opt4 +
 									  "' must be specified.");
   }
+  void mode_options(const po::variables_map& vm,
+						  const char* opt1,
+						  const char* opt2,
+						  const char* opt3,
+						  const char* opt4,
+						  const char* opt5) const {
+	 TRACE("Checking alternative options '" << opt1 <<
+			 "', '" << opt2 << "', '" << opt3 << "', '" << opt4 <<
+			 "', and '" << opt5 << "'.");
+	 if (!vm[opt1].as<bool>() && !vm[opt2].as<bool>()
+		  && !vm[opt3].as<bool>() && !vm[opt4].as<bool>()
+		  && !vm[opt5].as<bool>())
+		throw std::logic_error(std::string("At least one of the options '")
+									  + opt1 + "', '" + opt2 + "', '" + opt3 +
+									  "', '" + opt4 + "', or '" + opt5 +
+									  "' must be specified.");
+  }
 // Function used to check that 'opt1' and 'opt2' are not specified
 // at the same time.
   void conflicting_options(const po::variables_map& vm,
@@ -126,6 +143,21 @@ protected:
 		  throw std::logic_error(std::string("Option '") + for_what
 										 + "' requires option '" + required_option + "'.");
   }
+// Function used to check that of 'for_what' is specified, then at least
+// one of 'required_option1' or 'required_option2' is specified too.
+  void option_dependency(const po::variables_map& vm,
+								 const char* for_what,
+								 const char* required_option1,
+								 const char* required_option2) const {
+	 TRACE("Checking dependency between options '" << for_what <<
+			 "' and '" << required_option1 << "' or '" << required_option2 << "'.");
+	 if (vm.count(for_what) && !vm[for_what].defaulted())
+		if ((vm.count(required_option1) == 0 || vm[required_option1].defaulted()) &&
+			 (vm.count(required_option2) == 0 || vm[required_option2].defaulted()))
+		  throw std::logic_error(std::string("Option '") + for_what
+										 + "' requires option '" + required_option1
+										 + "' or option '" + required_option2 + "'.");
+  }
 
   virtual int execution(int argc,
 								char** argv,
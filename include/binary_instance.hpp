@@ -0,0 +1,157 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * binary_instance.hpp
+ *
+ * A binary format of the SAT instances that can be memory-mapped and
+ * loaded into a SAT solver without parsing.
+ *
+ * All the integers are stored in the byte order of the machine that has
+ * written the file and each section starts at a multiple of 8 bytes:
+ *
+ * header:      binary_instance_header_t
+ * variables:   no_of_vars records (kind, i1, i2) of 3 uint32 (the variable
+ *              i+1 of the instance, see 'pedcnf_t::vars()')
+ * clauses:     no_of_clauses+1 uint64 offsets (clause i is composed by the
+ *              literals in [offset[i], offset[i+1])), followed by
+ *              no_of_clause_lits int32 literals
+ * xor-clauses: no_of_xor_clauses+1 uint64 offsets, followed by
+ *              no_of_xor_lits int32 literals (as in the DIMACS extended
+ *              syntax, a xor-clause is satisfied if the xor of its literals
+ *              is true)
+ *
+ **/
+
+#ifndef __BINARY_INSTANCE_HPP__
+#define __BINARY_INSTANCE_HPP__
+
+#include "configuration.h"
+
+#include "log.hpp"
+#include "pedcnf.hpp"
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+
+struct binary_instance_header_t {
+  char magic[8];
+  boost::uint32_t version;
+// BYTE_ORDER_MARK as written by the machine that has written the file
+  boost::uint32_t byte_order;
+  boost::uint64_t no_of_vars;
+  boost::uint64_t no_of_clauses;
+  boost::uint64_t no_of_clause_lits;
+  boost::uint64_t no_of_xor_clauses;
+  boost::uint64_t no_of_xor_lits;
+  boost::uint64_t reserved;
+};
+
+
+class binary_instance_t:
+  public log_able_t< binary_instance_t >
+{
+public:
+
+  static const char MAGIC[8];
+  static const boost::uint32_t FORMAT_VERSION;
+  static const boost::uint32_t BYTE_ORDER_MARK;
+
+  typedef pedcnf_t::clause_t clause_t;
+  typedef std::set<clause_t> clauses_t;
+
+private:
+
+  boost::iostreams::mapped_file_source _file;
+  const binary_instance_header_t* _header;
+  const boost::uint32_t* _vars;
+  const boost::uint64_t* _clause_offsets;
+  const boost::int32_t* _clause_lits;
+  const boost::uint64_t* _xor_offsets;
+  const boost::int32_t* _xor_lits;
+
+public:
+
+// Map the file and check its structure (a std::logic_error is thrown if
+// the file is not a valid binary instance)
+  explicit binary_instance_t(const std::string& file_name);
+
+// Check if the file starts as a binary instance
+  static bool is_binary_instance(const std::string& file_name);
+
+// Write the instance composed by the variables 'vars', the clauses
+// 'clauses', and the xor-clauses 'xor_clauses'
+  static void write(std::ostream& out,
+						  const pedcnf_t::varvec_t& vars,
+						  const clauses_t& clauses,
+						  const clauses_t& xor_clauses);
+
+  size_t no_of_vars() const {
+	 return _header->no_of_vars;
+  };
+
+  size_t no_of_clauses() const {
+	 return _header->no_of_clauses;
+  };
+
+  size_t no_of_xor_clauses() const {
+	 return _header->no_of_xor_clauses;
+  };
+
+// The variable i+1
+  pedcnf_t::pedvar_t var(const size_t i) const;
+
+  const boost::int32_t* clause_begin(const size_t i) const {
+	 return _clause_lits + _clause_offsets[i];
+  };
+
+  const boost::int32_t* clause_end(const size_t i) const {
+	 return _clause_lits + _clause_offsets[i+1];
+  };
+
+  const boost::int32_t* xor_clause_begin(const size_t i) const {
+	 return _xor_lits + _xor_offsets[i];
+  };
+
+  const boost::int32_t* xor_clause_end(const size_t i) const {
+	 return _xor_lits + _xor_offsets[i+1];
+  };
+
+#ifdef INTERNAL_SAT_SOLVER
+// Add the variables, the clauses, and the xor-clauses of the instance to
+// 'solver'
+  void load(SAT_solver_iface_t& solver) const;
+#endif // INTERNAL_SAT_SOLVER
+
+};
+
+#endif // __BINARY_INSTANCE_HPP__
@@ -0,0 +1,98 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * clause_buffer.hpp
+ *
+ * Structures to store clauses in a flat array of literals and to check
+ * quickly if an assignment satisfies them.
+ *
+ **/
+
+#ifndef __CLAUSE_BUFFER_HPP__
+#define __CLAUSE_BUFFER_HPP__
+
+#include "log.hpp"
+
+#include <set>
+#include <vector>
+
+#include <boost/foreach.hpp>
+
+
+// A sequence of clauses (or xor-clauses) stored in a single array of
+// literals, where each clause is terminated by 0.
+class clause_buffer_t
+  :
+  public log_able_t<clause_buffer_t>
+{
+public:
+
+// The values of the variables (the value of variable v is in position v,
+// position 0 is not used)
+  typedef std::vector<unsigned char> value_table_t;
+
+private:
+
+  const bool _xor_clauses;
+  std::vector<int> _lits;
+  size_t _no_of_clauses;
+
+  class check_task_t;
+
+  bool is_satisfied(const int* clause, const value_table_t& vals) const;
+
+public:
+
+  explicit clause_buffer_t(const bool xor_clauses= false)
+		:_xor_clauses(xor_clauses), _no_of_clauses(0)
+  {};
+
+  void add_clause(const std::set<int>& clause);
+
+// Add every clause of a collection of clauses (such as a set of clauses)
+  template <typename T_CLAUSES>
+  void add_clauses(const T_CLAUSES& clauses) {
+	 BOOST_FOREACH( const typename T_CLAUSES::value_type& clause, clauses ) {
+		add_clause(clause);
+	 }
+  };
+
+  size_t no_of_clauses() const {
+	 return _no_of_clauses;
+  };
+
+// Check if every clause is satisfied by 'vals'.
+// The check stops at the first falsified clause.  The clauses are split
+// into chunks that are checked on 'n_threads' threads (0 means all the
+// available hardware threads).
+  bool is_satisfied_by(const value_table_t& vals,
+							  const unsigned int n_threads= 1) const;
+
+};
+
+#endif // __CLAUSE_BUFFER_HPP__
@@ -0,0 +1,99 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * dimacs_reader.hpp
+ *
+ * A fast reader of SAT instances in the DIMACS format (also with the
+ * xor-clauses of the extended syntax, i.e. lines such as 'x1 2 -3 0') that
+ * adds the clauses directly to the internal SAT solver.
+ *
+ * The file is memory-mapped and scanned by a hand-written parser (compressed
+ * files are decompressed in memory first).
+ * The trailer of the SATLIB instances (a line '%' followed by a line '0')
+ * ends the instance.
+ *
+ **/
+
+#ifndef __DIMACS_READER_HPP__
+#define __DIMACS_READER_HPP__
+
+#include "configuration.h"
+
+#ifdef INTERNAL_SAT_SOLVER
+
+#include "log.hpp"
+#include "sat_solver_interface.hpp"
+
+#include <string>
+
+
+class dimacs_reader_t:
+  public log_able_t< dimacs_reader_t >
+{
+private:
+
+  size_t _no_of_vars;
+  size_t _no_of_clauses;
+  size_t _no_of_xor_clauses;
+
+public:
+
+  dimacs_reader_t()
+		:_no_of_vars(0), _no_of_clauses(0), _no_of_xor_clauses(0)
+  {};
+
+// Parse the instance stored in [begin, end) and add its clauses to
+// 'solver' (a std::logic_error is thrown if the instance is malformed)
+  void load(const char* begin, const char* end,
+				SAT_solver_iface_t& solver);
+
+// Parse the instance stored in file 'file_name' (possibly compressed)
+  void load(const std::string& file_name,
+				SAT_solver_iface_t& solver);
+
+// The number of variables declared by the problem line (at most the
+// largest int, while the variables of the solver are created only when they
+// are used)
+  size_t no_of_vars() const {
+	 return _no_of_vars;
+  };
+
+// The number of (or-)clauses read
+  size_t no_of_clauses() const {
+	 return _no_of_clauses;
+  };
+
+  size_t no_of_xor_clauses() const {
+	 return _no_of_xor_clauses;
+  };
+
+};
+
+#endif // INTERNAL_SAT_SOLVER
+
+#endif // __DIMACS_READER_HPP__
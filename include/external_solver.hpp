@@ -0,0 +1,91 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * external_solver.hpp
+ *
+ * Execution of an external SAT solver through pipes: the SAT instance is
+ * written in DIMACS format directly to the standard input of the solver and
+ * the result is read from its standard output (in the format of the SAT
+ * competitions) while the solver runs, without temporary files.
+ *
+ **/
+
+#ifndef __EXTERNAL_SOLVER_HPP__
+#define __EXTERNAL_SOLVER_HPP__
+
+#include "configuration.h"
+
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+
+#include "log.hpp"
+#include "pedcnf.hpp"
+
+#include <string>
+#include <vector>
+
+
+class external_solver_t:
+  public log_able_t< external_solver_t >
+{
+private:
+
+  const std::string _cmdline;
+  int _exit_status;
+
+public:
+
+// 'cmdline' is executed by the shell.  The solver must read the instance
+// from its standard input (the marker %%INPUT%% is replaced by
+// '/dev/stdin') and print the result on its standard output (the marker
+// %%OUTPUT%% is replaced by '/dev/stdout').
+  explicit external_solver_t(const std::string& cmdline);
+
+// Execute the solver on the clauses of 'cnf' and read the assignment into
+// 'cnf'.
+// Return true if the clauses are satisfiable.  'decided' is false if the
+// solver has not stated whether the clauses are satisfiable or not (for
+// example, because it has failed).
+  bool solve(pedcnf_t& cnf,
+				 const std::vector<std::string>& headers,
+				 bool& decided);
+
+// The exit status of the last execution of the solver (-1 if it has not
+// terminated normally)
+  int exit_status() const {
+	 return _exit_status;
+  };
+
+  const std::string& cmdline() const {
+	 return _cmdline;
+  };
+
+};
+
+#endif // ONLY_INTERNAL_SAT_SOLVER
+
+#endif // __EXTERNAL_SOLVER_HPP__
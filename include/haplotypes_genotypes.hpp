@@ -421,12 +421,21 @@ public:
   };
 
   bool is_compatible_with(const generic_fixlen_vector_t<_base_t,_reader,_writer>& v) const {
-  typedef generic_fixlen_vector_t<_base_t,_reader,_writer> v_t;
   if (size() != v.size())
 	 return false;
-  const typename v_t::base* v1it= begin();
-  const typename v_t::base* v2it= v.begin();
-  for (; v1it != end(); ++v1it, ++v2it) {
+  return is_compatible_with(v, 0, size());
+};
+
+// Check the compatibility only on the positions in [first, last)
+  bool is_compatible_with(const generic_fixlen_vector_t<_base_t,_reader,_writer>& v,
+								  const size_t first, const size_t last) const {
+  typedef generic_fixlen_vector_t<_base_t,_reader,_writer> v_t;
+  MY_ASSERT_DBG(first <= last);
+  MY_ASSERT_DBG(last <= size());
+  MY_ASSERT_DBG(last <= v.size());
+  const typename v_t::base* v1it= begin()+first;
+  const typename v_t::base* v2it= v.begin()+first;
+  for (; v1it != begin()+last; ++v1it, ++v2it) {
 	 if ( (*v1it != v_t::base::MISS) &&
 			(*v2it != v_t::base::MISS) &&
 			(*v1it != *v2it) ) {
@@ -0,0 +1,262 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * hc_verification.hpp
+ *
+ * Fast verification of haplotype configurations: the haplotypes and the
+ * genotypes are packed into bit-vectors (64 loci per word) and the
+ * individuals are checked in parallel.
+ *
+ **/
+
+#ifndef __HC_VERIFICATION_HPP__
+#define __HC_VERIFICATION_HPP__
+
+#include "pedigree.hpp"
+#include "mendelian_check.hpp"
+#include "parallel.hpp"
+#include "log.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/cstdint.hpp>
+
+#include <log4cxx/logger.h>
+
+
+// A haplotype packed into two bit-vectors: the positions where the allele
+// is missing and the positions where the allele is the second one.
+class packed_haplotype_t {
+public:
+  typedef packed_genotype_t::word_t word_t;
+  static const size_t WORD_BITS= packed_genotype_t::WORD_BITS;
+
+  std::vector<word_t> miss;
+  std::vector<word_t> allele2;
+
+  template <typename T_HAPLOTYPE>
+  void set(const T_HAPLOTYPE& h, const size_t len) {
+	 const size_t n_words= packed_genotype_t::no_of_words(len);
+	 miss.assign(n_words, 0);
+	 allele2.assign(n_words, 0);
+	 for (size_t l= 0; l < len; ++l) {
+		const word_t bit= ((word_t)1) << (l % WORD_BITS);
+		if (h[l] == T_HAPLOTYPE::base::MISS) {
+		  miss[l / WORD_BITS] |= bit;
+		} else if (h[l] == T_HAPLOTYPE::base::ALLELE2) {
+		  allele2[l / WORD_BITS] |= bit;
+		}
+	 }
+  }
+
+// There must be no position of 'mask' where both haplotypes are known and
+// differ
+  bool is_compatible_with(const packed_haplotype_t& h,
+								  const std::vector<word_t>& mask) const {
+	 for (size_t w= 0; w < mask.size(); ++w) {
+		if (mask[w] & ~miss[w] & ~h.miss[w] & (allele2[w] ^ h.allele2[w]))
+		  return false;
+	 }
+	 return true;
+  }
+};
+
+
+// The haplotype configuration of a family packed into bit-vectors.
+// The three checks are equivalent to those of basic_pedigree_t
+// (is_completely_haplotyped, is_consistent, and is_zero_recombinant), but
+// they process 64 loci at a time and the individuals are checked on
+// 'n_threads' threads (0 means all the available hardware threads).
+template <typename T_FAMILY>
+class packed_haplotype_configuration_t:
+  public log_able_t< packed_haplotype_configuration_t<T_FAMILY> >
+{
+private:
+  typedef packed_genotype_t::word_t word_t;
+  static const size_t WORD_BITS= packed_genotype_t::WORD_BITS;
+
+  typedef bool (packed_haplotype_configuration_t::*check_t)(const size_t) const;
+
+  const T_FAMILY& _ped;
+  const size_t _len;
+  const unsigned int _n_threads;
+  std::vector<packed_genotype_t> _g;
+  std::vector<packed_haplotype_t> _hp;
+  std::vector<packed_haplotype_t> _hm;
+  std::vector<word_t> _range;
+
+// Task that packs the i-th individual
+  class pack_task_t {
+  private:
+	 packed_haplotype_configuration_t& _phc;
+  public:
+	 pack_task_t(packed_haplotype_configuration_t& phc)
+		  :_phc(phc)
+	 {};
+
+	 void operator()(const size_t i) {
+		const typename T_FAMILY::individual_t& ind= _phc._ped.get_by_progr(i);
+		_phc._g[i].set(ind.g(), _phc._len);
+		_phc._hp[i].set(ind.hp(), _phc._len);
+		_phc._hm[i].set(ind.hm(), _phc._len);
+	 };
+  };
+
+// Task that executes a check on the i-th individual
+  class check_task_t {
+  private:
+	 const packed_haplotype_configuration_t& _phc;
+	 const check_t _check;
+	 std::vector<char>& _ok;
+  public:
+	 check_task_t(const packed_haplotype_configuration_t& phc,
+					  const check_t check,
+					  std::vector<char>& ok)
+		  :_phc(phc), _check(check), _ok(ok)
+	 {};
+
+	 void operator()(const size_t i) {
+		_ok[i]= (_phc.*_check)(i);
+	 };
+  };
+
+  bool check_all(const check_t check) const {
+	 std::vector<char> ok(_ped.size(), false);
+	 check_task_t task(*this, check, ok);
+	 parallel_for(_ped.size(), task, _n_threads);
+	 return std::find(ok.begin(), ok.end(), false) == ok.end();
+  };
+
+  void set_range(const size_t first, const size_t last) {
+	 std::fill(_range.begin(), _range.end(), 0);
+	 for (size_t l= first; l < last; ++l) {
+		_range[l / WORD_BITS] |= ((word_t)1) << (l % WORD_BITS);
+	 }
+  };
+
+  bool is_completely_haplotyped(const size_t i) const {
+	 for (size_t w= 0; w < _range.size(); ++w) {
+		if ((_hp[i].miss[w] | _hm[i].miss[w]) & _range[w])
+		  return false;
+	 }
+	 return true;
+  };
+
+  bool is_consistent(const size_t i) const {
+	 const packed_genotype_t& g= _g[i];
+	 const packed_haplotype_t& hp= _hp[i];
+	 const packed_haplotype_t& hm= _hm[i];
+	 for (size_t w= 0; w < _range.size(); ++w) {
+		const word_t kp= ~hp.miss[w];
+		const word_t km= ~hm.miss[w];
+		const word_t err=
+		  (g.homo1[w] & ((kp & hp.allele2[w]) | (km & hm.allele2[w]))) |
+		  (g.homo2[w] & ((kp & ~hp.allele2[w]) | (km & ~hm.allele2[w]))) |
+		  (g.heter[w] & kp & km & ~(hp.allele2[w] ^ hm.allele2[w]));
+		if (err & _range[w])
+		  return false;
+	 }
+	 return true;
+  };
+
+  bool is_zero_recombinant(const size_t i) const {
+	 const typename T_FAMILY::individual_t& ind= _ped.get_by_progr(i);
+	 if (ind.has_father()) {
+		const size_t f= ind.father().progr_id();
+		if (!( _hp[i].is_compatible_with(_hp[f], _range) ||
+				 _hp[i].is_compatible_with(_hm[f], _range) ))
+		  return false;
+	 }
+	 if (ind.has_mother()) {
+		const size_t m= ind.mother().progr_id();
+		if (!( _hm[i].is_compatible_with(_hp[m], _range) ||
+				 _hm[i].is_compatible_with(_hm[m], _range) ))
+		  return false;
+	 }
+	 return true;
+  };
+
+public:
+
+  packed_haplotype_configuration_t(const T_FAMILY& ped,
+											  const unsigned int n_threads= 0)
+		:_ped(ped), _len(ped.genotype_length()), _n_threads(n_threads),
+		 _g(ped.size()), _hp(ped.size()), _hm(ped.size()),
+		 _range(packed_genotype_t::no_of_words(_len), 0)
+  {
+	 pack_task_t task(*this);
+	 parallel_for(_ped.size(), task, _n_threads);
+	 set_range(0, _len);
+  };
+
+  bool is_completely_haplotyped() const {
+	 return check_all(&packed_haplotype_configuration_t::is_completely_haplotyped);
+  };
+
+  bool is_consistent() const {
+	 return check_all(&packed_haplotype_configuration_t::is_consistent);
+  };
+
+  bool is_zero_recombinant() {
+	 return is_zero_recombinant(0, _len);
+  };
+
+  bool is_zero_recombinant(const size_t first, const size_t last) {
+	 MY_ASSERT(first <= last);
+	 MY_ASSERT(last <= _len);
+	 set_range(first, last);
+	 const bool ok= check_all(&packed_haplotype_configuration_t::is_zero_recombinant);
+	 set_range(0, _len);
+	 return ok;
+  };
+
+};
+
+
+// Check that the haplotype configuration of a family is complete,
+// consistent with the genotypes, and zero-recombinant
+template <typename T_FAMILY>
+bool
+is_valid_ZRHC(const T_FAMILY& ped, const unsigned int n_threads= 0) {
+  log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("hc_verification"));
+  DEBUG("Verifying the haplotype configuration...");
+  packed_haplotype_configuration_t<T_FAMILY> phc(ped, n_threads);
+  const bool complete= phc.is_completely_haplotyped();
+  DEBUG("The haplotype configuration is " << (complete ? "" : "NOT ") << "complete.");
+  const bool consistent= complete && phc.is_consistent();
+  DEBUG("The haplotype configuration is " << (consistent ? "" : "NOT ") <<
+		  "consistent with the genotypes.");
+  const bool zr= consistent && phc.is_zero_recombinant();
+  DEBUG("The haplotype configuration is " << (zr ? "" : "NOT ") <<
+		  "zero-recombinant.");
+  return zr;
+}
+
+
+#endif // __HC_VERIFICATION_HPP__
@@ -0,0 +1,490 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * incremental_solver.hpp
+ *
+ * Incremental solution of a family whose genotypes change: only the
+ * constraints affected by the changed genotypes are encoded again, while
+ * the solver keeps its learnt clauses and starts the search from the
+ * previous model.
+ *
+ * The constraints between each individual and its parents at each locus
+ * are guarded by a selector and the instance is solved assuming that every
+ * selector is true.  When a genotype changes, the constraints of the
+ * affected (individual, locus) pairs are disabled and added again under new
+ * selectors.
+ * The state of the solver (genotypes, variables and clauses of the
+ * instance, model, and short learnt clauses) can be saved to a stream and
+ * loaded by a later run, which encodes again only the constraints affected
+ * by the genotypes that have changed since then.
+ *
+ **/
+
+#ifndef __INCREMENTAL_SOLVER_HPP__
+#define __INCREMENTAL_SOLVER_HPP__
+
+#include "configuration.h"
+
+#ifdef INTERNAL_SAT_SOLVER
+
+#include "log.hpp"
+#include "assertion.hpp"
+#include "utility.hpp"
+#include "pedigree.hpp"
+#include "pedcnf.hpp"
+#include "ped2cnf.hpp"
+
+#include <set>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <utility>
+
+#include <boost/foreach.hpp>
+#include <boost/scoped_ptr.hpp>
+
+
+template <typename T_FAMILY>
+class incremental_solver_t:
+  public log_able_t< incremental_solver_t<T_FAMILY> >
+{
+public:
+
+  typedef typename T_FAMILY::individual_t individual_t;
+  typedef typename T_FAMILY::gen_t::base g;
+  typedef typename T_FAMILY::id_t id_t;
+
+// The maximum length of the learnt clauses that are saved
+  static const size_t MAX_LEARNT_SIZE= 20;
+
+  static const unsigned int STATE_VERSION= 2;
+
+private:
+
+  typedef ped2cnf_conv_t<typename T_FAMILY::gen_t, typename T_FAMILY::hap_t,
+								 typename T_FAMILY::phen_t, typename T_FAMILY::id_t,
+								 pedcnf_t> conv_t;
+
+  conv_t _conv;
+  boost::scoped_ptr<pedcnf_t> _cnf;
+  bool _has_model;
+
+// The individuals, parents (progressive ids), children, and genotypes
+// (locus l of individual i is at position i*_len+l) of the encoded family
+  size_t _len;
+  std::vector<id_t> _ids;
+  std::vector<size_t> _fathers;
+  std::vector<size_t> _mothers;
+  std::vector< std::vector<size_t> > _children;
+  std::vector<g> _genotypes;
+
+  std::string _options;
+
+  static size_t parent_progr(const individual_t& ind, const bool mother) {
+	 if (mother) {
+		return ind.has_mother() ? ind.mother().progr_id() : T_FAMILY::not_existent_progr;
+	 } else {
+		return ind.has_father() ? ind.father().progr_id() : T_FAMILY::not_existent_progr;
+	 }
+  };
+
+  void set_structure(const T_FAMILY& family) {
+	 _len= family.genotype_length();
+	 _ids.clear();
+	 _fathers.clear();
+	 _mothers.clear();
+	 _children.assign(family.size(), std::vector<size_t>());
+	 _genotypes.clear();
+	 _genotypes.reserve(family.size() * _len);
+	 for (size_t i= 0; i < family.size(); ++i) {
+		const individual_t& ind= family.get_by_progr(i);
+		_ids.push_back(ind.id());
+		_fathers.push_back(parent_progr(ind, false));
+		_mothers.push_back(parent_progr(ind, true));
+		if (ind.has_father())
+		  _children[ind.father().progr_id()].push_back(i);
+		if (ind.has_mother())
+		  _children[ind.mother().progr_id()].push_back(i);
+		for (size_t l= 0; l < _len; ++l)
+		  _genotypes.push_back(ind.g(l));
+	 }
+  };
+
+  static bool read_kind(const std::string& str, ped_var_kind& kind) {
+	 for (size_t k= 0; k < ped_var_kind::N_VALUES; ++k) {
+		if (str == ped_var_kind::str_values[k]) {
+		  kind= ped_var_kind::enum_values[k];
+		  return true;
+		}
+	 }
+	 return false;
+  };
+
+// Check if a clause has a selector that has been replaced by a new one
+  static bool has_retired_selector(const std::vector<int>& clause,
+											  const std::vector<bool>& retired) {
+	 BOOST_FOREACH( const int lit, clause ) {
+		if (retired[std::abs(lit)])
+		  return true;
+	 }
+	 return false;
+  };
+
+  static void write_clause(std::ostream& os, const std::vector<int>& clause) {
+	 BOOST_FOREACH( const int lit, clause ) {
+		os << lit << " ";
+	 }
+	 os << "0\n";
+  };
+
+// Read the section 'name' of clauses over the variables 1..no_of_vars
+  static bool read_clauses(std::istream& is, const std::string& name,
+									const size_t no_of_vars,
+									std::vector< std::vector<int> >& clauses) {
+	 std::string word;
+	 size_t no_of_clauses;
+	 if (!(is >> word >> no_of_clauses) || (word != name))
+		return false;
+	 clauses.assign(no_of_clauses, std::vector<int>());
+	 for (size_t i= 0; i < no_of_clauses; ++i) {
+		int lit;
+		while ((is >> lit) && (lit != 0)) {
+		  if ((size_t)std::abs(lit) > no_of_vars)
+			 return false;
+		  clauses[i].push_back(lit);
+		}
+		if (!is || clauses[i].empty())
+		  return false;
+	 }
+	 return true;
+  };
+
+// Read a variable written as kind_i1_i2
+  static bool read_var(const std::string& str, pedcnf_t::pedvar_t& var) {
+	 std::string s= str;
+	 std::replace(s.begin(), s.end(), '_', ' ');
+	 std::istringstream is(s);
+	 std::string kind_str;
+	 size_t i1, i2;
+	 ped_var_kind kind= ped_var_kind::DUMMY;
+	 if (!(is >> kind_str >> i1 >> i2) || !read_kind(kind_str, kind))
+		return false;
+	 var= boost::make_tuple(kind, i1, i2);
+	 return true;
+  };
+
+public:
+
+// The constraints are never guarded by symmetry-breaking clauses nor
+// encoded with xor-clauses (such clauses could not be disabled).
+// 'options' identifies the encoding options (the saved state can be loaded
+// only with the same options).
+  explicit incremental_solver_t(const bool s_vars_first= false,
+										  const std::string& options= "")
+		:_conv(false, s_vars_first, true), _has_model(false), _len(0),
+		 _options(options)
+  {};
+
+  bool is_initialized() const {
+	 return _cnf.get() != NULL;
+  };
+
+  pedcnf_t& cnf() {
+	 MY_ASSERT(is_initialized());
+	 return *_cnf;
+  };
+
+  const pedcnf_t& cnf() const {
+	 MY_ASSERT(is_initialized());
+	 return *_cnf;
+  };
+
+// Encode the whole family
+  void initialize(const T_FAMILY& family) {
+	 L_DEBUG("Encoding the whole family (" << family.size() <<
+				" individuals and " << family.genotype_length() << " loci)...");
+	 set_structure(family);
+	 _cnf.reset(new pedcnf_t);
+	 _cnf->set_incremental(true);
+	 _cnf->keep_clauses();
+	 _conv.add_loci(*_cnf, family, 0, _len, 0);
+	 _has_model= false;
+  };
+
+// Check if 'family' has the same individuals (in the same order), the same
+// parents, and the same number of loci of the encoded family
+  bool has_same_structure(const T_FAMILY& family) const {
+	 if ((family.size() != _ids.size()) || (family.genotype_length() != _len))
+		return false;
+	 for (size_t i= 0; i < family.size(); ++i) {
+		const individual_t& ind= family.get_by_progr(i);
+		if ((ind.id() != _ids[i]) ||
+			 (parent_progr(ind, false) != _fathers[i]) ||
+			 (parent_progr(ind, true) != _mothers[i]))
+		  return false;
+	 }
+	 return true;
+  };
+
+// Encode again the constraints affected by the genotypes of 'family' that
+// differ from those of the encoded family, that is the constraints between
+// each changed individual and its parents and between its children and
+// the individual itself (at the changed loci).
+// Return the number of (individual, locus) pairs that have been encoded
+// again.
+  size_t update(const T_FAMILY& family) {
+	 MY_ASSERT(is_initialized());
+	 MY_ASSERT(has_same_structure(family));
+	 std::set< std::pair<size_t, size_t> > changed;
+	 size_t no_of_changed_genotypes= 0;
+	 for (size_t i= 0; i < family.size(); ++i) {
+		const individual_t& ind= family.get_by_progr(i);
+		for (size_t l= 0; l < _len; ++l) {
+		  g& old_g= _genotypes[i*_len + l];
+		  if (old_g == ind.g(l))
+			 continue;
+		  L_TRACE("Genotype of individual " << ind.id() << " at locus " << l <<
+					 " changed from " << old_g << " to " << ind.g(l));
+		  old_g= ind.g(l);
+		  ++no_of_changed_genotypes;
+		  if (ind.has_father() || ind.has_mother())
+			 changed.insert(std::make_pair(i, l));
+		  BOOST_FOREACH( const size_t c, _children[i] ) {
+			 changed.insert(std::make_pair(c, l));
+		  }
+		}
+	 }
+	 typedef std::pair<size_t, size_t> pair_t;
+	 BOOST_FOREACH( const pair_t& p, changed ) {
+		_conv.renew_constraints(*_cnf, family.get_by_progr(p.first), p.second);
+	 }
+	 L_INFO(no_of_changed_genotypes << " genotypes have changed: the "
+			  "constraints of " << changed.size() << " (individual, locus) "
+			  "pairs have been encoded again.");
+	 return changed.size();
+  };
+
+// Solve the instance (starting from the previous model, if any).
+// Return true if it is satisfiable.
+  bool solve() {
+	 MY_ASSERT(is_initialized());
+	 if (_has_model) {
+		_cnf->seed_phases(_cnf->vals());
+	 }
+	 std::vector<pedcnf_t::pedvar_t> core;
+	 const bool is_sat= _cnf->solve_with_selectors(core);
+	 if (is_sat) {
+		_has_model= true;
+	 } else if (!core.empty()) {
+		L_DEBUG("The constraints of " << core.size() << " (individual, locus) "
+				  "pairs make the family infeasible.");
+	 }
+	 return is_sat;
+  };
+
+  bool is_interrupted() const {
+	 return is_initialized() && _cnf->is_interrupted();
+  };
+
+// Save the genotypes of the encoded family, the variables and the clauses
+// of the instance, the model (if any), and the short learnt clauses.
+// The clauses disabled by a retired selector are not saved.
+  void save_state(std::ostream& os) const {
+	 MY_ASSERT(is_initialized());
+	 os << "ZRHCstar incremental state " << STATE_VERSION << "\n";
+	 os << "options " << _options << "\n";
+	 os << "family " << _ids.size() << " " << _len << "\n";
+	 for (size_t i= 0; i < _ids.size(); ++i) {
+		os << _ids[i] << " ";
+		if (_fathers[i] != T_FAMILY::not_existent_progr) os << _fathers[i]; else os << "-";
+		os << " ";
+		if (_mothers[i] != T_FAMILY::not_existent_progr) os << _mothers[i]; else os << "-";
+		os << " ";
+		for (size_t l= 0; l < _len; ++l)
+		  os << _genotypes[i*_len + l];
+		os << "\n";
+	 }
+	 const pedcnf_t::varvec_t& vars= _cnf->vars();
+	 os << "variables " << vars.size() << "\n";
+	 BOOST_FOREACH( const pedcnf_t::pedvar_t& var, vars ) {
+		os << var << "\n";
+	 }
+// The selectors that have been replaced by a new one
+	 std::vector<bool> retired(vars.size() + 1, false);
+	 for (size_t v= 0; v < vars.size(); ++v) {
+		retired[v+1]= (vars[v].get<0>() == ped_var_kind::SELECTOR);
+	 }
+	 BOOST_FOREACH( const pedcnf_t::varmap_t::value_type& sel, _cnf->selectors() ) {
+		retired[sel.second]= false;
+	 }
+	 std::vector<const std::vector<int>*> clauses;
+	 BOOST_FOREACH( const std::vector<int>& clause, _cnf->kept_clauses() ) {
+		if ((clause.size() == 1) || !has_retired_selector(clause, retired))
+		  clauses.push_back(&clause);
+	 }
+	 os << "clauses " << clauses.size() << "\n";
+	 BOOST_FOREACH( const std::vector<int>* clause, clauses ) {
+		write_clause(os, *clause);
+	 }
+	 os << "model " << (_has_model ? vars.size() : 0) << "\n";
+	 if (_has_model) {
+		BOOST_FOREACH( const bool val, _cnf->vals() ) {
+		  os << (val ? '1' : '0');
+		}
+		os << "\n";
+	 }
+	 std::vector< std::vector<int> > learnts;
+	 _cnf->learnt_clauses(learnts, MAX_LEARNT_SIZE);
+	 clauses.clear();
+	 BOOST_FOREACH( const std::vector<int>& clause, learnts ) {
+		if (!has_retired_selector(clause, retired))
+		  clauses.push_back(&clause);
+	 }
+	 os << "learnts " << clauses.size() << "\n";
+	 BOOST_FOREACH( const std::vector<int>* clause, clauses ) {
+		write_clause(os, *clause);
+	 }
+  };
+
+// Load a state saved by 'save_state': the saved instance is restored (with
+// the same numbering of the variables, thus without encoding the family
+// again), the saved learnt clauses are added, and the saved model seeds
+// the search.
+// Return false if the state is malformed or it has been saved with
+// different options.
+  bool load_state(std::istream& is) {
+	 std::string line, word;
+	 unsigned int version;
+	 if (!std::getline(is, line))
+		return false;
+	 std::istringstream header(line);
+	 if (!(header >> word) || (word != "ZRHCstar") ||
+		  !(header >> word) || (word != "incremental") ||
+		  !(header >> word) || (word != "state") ||
+		  !(header >> version) || (version != STATE_VERSION)) {
+		L_WARN("The incremental state is malformed or it has been saved by a "
+				 "different version of the program.");
+		return false;
+	 }
+	 if (!std::getline(is, line) || (line != "options " + _options)) {
+		L_WARN("The incremental state has been saved with different options.");
+		return false;
+	 }
+	 size_t n, len;
+	 if (!(is >> word >> n >> len) || (word != "family") || (len == 0))
+		return false;
+// Build the saved family
+	 T_FAMILY family(len);
+	 std::vector< std::pair<std::string, std::string> > parents(n);
+	 for (size_t i= 0; i < n; ++i) {
+		id_t id;
+		std::string genotype;
+		if (!(is >> id >> parents[i].first >> parents[i].second >> genotype) ||
+			 (genotype.size() != len) ||
+			 (id == T_FAMILY::not_existent_id) || family.exists(id))
+		  return false;
+		individual_t& ind= family.add_individual(id);
+		std::istringstream gis(genotype);
+		gis >> ind.g();
+	 }
+	 for (size_t i= 0; i < n; ++i) {
+		size_t parent[2]= { T_FAMILY::not_existent_progr, T_FAMILY::not_existent_progr };
+		const std::string* strs[2]= { &parents[i].first, &parents[i].second };
+		for (size_t j= 0; j < 2; ++j) {
+		  if (*strs[j] != "-") {
+			 std::istringstream pis(*strs[j]);
+			 if (!(pis >> parent[j]) || (parent[j] >= n))
+				return false;
+		  }
+		}
+		if ((parent[0] != T_FAMILY::not_existent_progr) &&
+			 !family.get_by_progr(parent[0]).gender().is_not_female())
+		  return false;
+		if ((parent[1] != T_FAMILY::not_existent_progr) &&
+			 !family.get_by_progr(parent[1]).gender().is_not_male())
+		  return false;
+		family.add_trio_by_progr(i, parent[0], parent[1]);
+	 }
+	 size_t no_of_vars;
+	 if (!(is >> word >> no_of_vars) || (word != "variables"))
+		return false;
+	 pedcnf_t::varvec_t vars;
+	 vars.reserve(no_of_vars);
+	 for (size_t v= 0; v < no_of_vars; ++v) {
+		pedcnf_t::pedvar_t var(ped_var_kind::DUMMY, 0, 0);
+		if (!(is >> word) || !read_var(word, var))
+		  return false;
+		vars.push_back(var);
+	 }
+	 std::vector< std::vector<int> > clauses;
+	 if (!read_clauses(is, "clauses", no_of_vars, clauses))
+		return false;
+	 size_t model_size;
+	 std::string model;
+	 if (!(is >> word >> model_size) || (word != "model") ||
+		  ((model_size != 0) && (model_size != no_of_vars)) ||
+		  ((model_size > 0) && (!(is >> model) || (model.size() != model_size))))
+		return false;
+	 std::vector< std::vector<int> > learnts;
+	 if (!read_clauses(is, "learnts", no_of_vars, learnts))
+		return false;
+
+	 set_structure(family);
+	 _cnf.reset(new pedcnf_t);
+	 _cnf->set_incremental(true);
+	 _cnf->keep_clauses();
+	 _has_model= false;
+	 BOOST_FOREACH( const pedcnf_t::pedvar_t& var, vars ) {
+		_cnf->add_var(var);
+	 }
+	 BOOST_FOREACH( const std::vector<int>& clause, clauses ) {
+		_cnf->add_clause(pedcnf_t::clause_t(clause.begin(), clause.end()));
+	 }
+	 const size_t no_of_added= _cnf->add_learnt_clauses(learnts);
+	 if (!model.empty()) {
+		pedcnf_t::valvec_t vals(model.size(), false);
+		for (size_t v= 0; v < model.size(); ++v) {
+		  vals[v]= (model[v] == '1');
+		}
+		_cnf->seed_phases(vals);
+	 }
+	 L_INFO("Incremental state loaded: " << n << " individuals, " <<
+			  vars.size() << " variables, " << clauses.size() << " clauses, and " <<
+			  no_of_added << " learnt clauses.");
+	 return true;
+  };
+
+};
+
+#endif // INTERNAL_SAT_SOLVER
+
+#endif // __INCREMENTAL_SOLVER_HPP__
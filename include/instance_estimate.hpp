@@ -0,0 +1,112 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * instance_estimate.hpp
+ *
+ * Functions to estimate the size of the SAT instance of a pedigree (and
+ * the memory needed to solve it) before encoding it.
+ *
+ **/
+
+#ifndef __INSTANCE_ESTIMATE_HPP__
+#define __INSTANCE_ESTIMATE_HPP__
+
+#include <iostream>
+
+
+// Statistics of a pedigree file (in PLINK format) collected without
+// building the pedigree
+class pedigree_file_stats_t {
+public:
+  size_t individuals;
+  size_t founders;
+  size_t loci;
+  size_t genotypes;
+  size_t missing_genotypes;
+  size_t heterozygous_genotypes;
+
+  pedigree_file_stats_t()
+		:individuals(0), founders(0), loci(0), genotypes(0),
+		 missing_genotypes(0), heterozygous_genotypes(0)
+  {};
+
+  double missing_rate() const {
+	 return (genotypes > 0) ? ((double)missing_genotypes / genotypes) : 0.0;
+  };
+};
+
+std::ostream&
+operator<<(std::ostream& out, const pedigree_file_stats_t& stats);
+
+
+// Scan a pedigree file and collect its statistics.
+// Only the number of fields of each row is checked: malformed files are
+// reported when the pedigree is actually read.
+void
+scan_pedigree_file(std::istream& in, pedigree_file_stats_t& stats);
+
+
+// The estimated size of the SAT instance of a pedigree and the estimated
+// memory (in megabytes, excluding the memory used by the program before
+// reading the pedigree) needed to encode and solve it
+class instance_estimate_t {
+public:
+  double variables;
+  double clauses;
+  double xor_clauses;
+  double memory_mb;
+
+  instance_estimate_t()
+		:variables(0.0), clauses(0.0), xor_clauses(0.0), memory_mb(0.0)
+  {};
+};
+
+std::ostream&
+operator<<(std::ostream& out, const instance_estimate_t& estimate);
+
+
+// Estimate the memory (in megabytes, as above) needed to encode and solve
+// a SAT instance of the given size derived from a pedigree with the given
+// number of genotypes
+double
+estimate_memory_mb(const instance_estimate_t& instance,
+						 const size_t genotypes,
+						 const bool xor_clauses);
+
+
+// Estimate the SAT instance of a pedigree with the given statistics (with
+// or without xor-clauses).
+// The estimate is a linear model of the number of heterozygous and missing
+// genotypes, of the number of (non-founder, locus) pairs, and of the number
+// of individuals, fitted on the instances of randomly generated pedigrees.
+instance_estimate_t
+estimate_instance(const pedigree_file_stats_t& stats,
+						const bool xor_clauses);
+
+
+#endif // __INSTANCE_ESTIMATE_HPP__
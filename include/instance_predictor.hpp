@@ -0,0 +1,212 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * instance_predictor.hpp
+ *
+ * Functions to compute the size of the SAT instance of a pedigree without
+ * encoding it.
+ *
+ **/
+
+#ifndef __INSTANCE_PREDICTOR_HPP__
+#define __INSTANCE_PREDICTOR_HPP__
+
+#include "pedigree.hpp"
+#include "instance_estimate.hpp"
+#include "log.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+#include <log4cxx/logger.h>
+
+
+// The number of clauses (or xor-clauses) that 'ped2cnf_conv_t' adds for the
+// constraint between a parent and an individual at a locus, and the
+// variables that the constraint uses.
+// The constraint is the xor of the parent terms (h_pl + s_pi if the parent
+// is heterozygous, h_pl + s_pi*w_pl if it is not genotyped) and of the
+// individual terms (h_il if it is heterozygous, h_il (+ w_il for the mother)
+// if it is not genotyped), while homozygous genotypes only change its
+// constant.  A xor of k > 1 terms gives 2^(k-1) clauses (or a single
+// xor-clause), a single term gives a unit clause, and each product s*w
+// gives a dummy variable and 3 more clauses.
+template <typename T_GENOTYPE,
+			 typename T_HAPLOTYPE,
+			 typename T_PHENOTYPE,
+			 typename T_ID>
+class constraint_size_t {
+public:
+  typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
+  typedef typename family_t::g g;
+
+  size_t clauses;
+  size_t xor_clauses;
+  bool uses_parent_h_s;
+  bool uses_parent_w;
+  bool uses_individual_h;
+  bool uses_individual_w;
+
+  constraint_size_t(const g& parent_g, const g& individual_g,
+						  const bool is_mother, const bool xor_clauses_)
+		:clauses(0), xor_clauses(0),
+		 uses_parent_h_s(!is_homozigous(parent_g)),
+		 uses_parent_w(!is_genotyped(parent_g)),
+		 uses_individual_h(!is_homozigous(individual_g)),
+		 uses_individual_w(is_mother && !is_genotyped(individual_g))
+  {
+	 const size_t k= (uses_parent_h_s ? 2 : 0) +
+		(uses_individual_h ? 1 : 0) + (uses_individual_w ? 1 : 0);
+	 if (k == 0) {
+// Mendelian error between two homozygous genotypes (empty clause)
+		if (parent_g != individual_g)
+		  clauses= 1;
+	 } else if (k == 1) {
+		clauses= 1;
+	 } else if (xor_clauses_) {
+		xor_clauses= 1;
+	 } else {
+		clauses= ((size_t)1) << (k-1);
+	 }
+	 if (uses_parent_w)
+		clauses+= 3;
+  };
+};
+
+
+// Compute the number of variables, clauses, and xor-clauses of the SAT
+// instance of the pedigree on the given loci (in the same way as
+// 'ped2cnf_conv_t' with the same options) without encoding it, and
+// estimate the memory needed to solve it.
+// It takes time linear in the number of genotypes and a bit for each of
+// them.
+template <typename T_GENOTYPE,
+			 typename T_HAPLOTYPE,
+			 typename T_PHENOTYPE,
+			 typename T_ID>
+instance_estimate_t
+predict_instance(const basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
+					  const std::vector<size_t>& loci,
+					  const bool xor_clauses,
+					  const bool break_symmetries= false,
+					  const bool guard_constraints= false) {
+  log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("instance_predictor"));
+  typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
+  typedef typename family_t::individual_t individual_t;
+  typedef constraint_size_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> constraint_t;
+  const size_t n_loci= loci.size();
+// The h and w variables used, indexed by individual and position in 'loci'
+  std::vector<bool> h(ped.size() * n_loci, false);
+  std::vector<bool> w(ped.size() * n_loci, false);
+  size_t s_vars= 0;
+  size_t dummy_vars= 0;
+  size_t sel_vars= 0;
+  size_t clauses= 0;
+  size_t xor_cls= 0;
+  BOOST_FOREACH( const individual_t& ind,
+					  ped.individuals() ) {
+	 if (guard_constraints && (ind.has_father() || ind.has_mother())) {
+		sel_vars+= n_loci;
+	 }
+	 for (size_t p= 0; p < 2; ++p) {
+		const bool is_mother= (p == 1);
+		if (!(is_mother ? ind.has_mother() : ind.has_father()))
+		  continue;
+		const individual_t& parent= is_mother ? ind.mother() : ind.father();
+		bool uses_s= false;
+		for (size_t j= 0; j < n_loci; ++j) {
+		  const size_t l= loci[j];
+		  const constraint_t c(parent.g(l), ind.g(l), is_mother, xor_clauses);
+		  clauses+= c.clauses;
+		  xor_cls+= c.xor_clauses;
+		  if (c.uses_parent_h_s) {
+			 uses_s= true;
+			 h[parent.progr_id() * n_loci + j]= true;
+		  }
+		  if (c.uses_parent_w) {
+			 w[parent.progr_id() * n_loci + j]= true;
+			 ++dummy_vars;
+		  }
+		  if (c.uses_individual_h)
+			 h[ind.progr_id() * n_loci + j]= true;
+		  if (c.uses_individual_w)
+			 w[ind.progr_id() * n_loci + j]= true;
+		}
+		if (uses_s)
+		  ++s_vars;
+	 }
+  }
+  if (break_symmetries) {
+	 BOOST_FOREACH( const individual_t& ind,
+						 ped.individuals() ) {
+		if (!ind.is_founder() || !ind.has_children())
+		  continue;
+		size_t j= 0;
+		while ((j < n_loci) && !is_heterozygous(ind.g(loci[j])))
+		  ++j;
+		if (j < n_loci)
+		  ++clauses;
+	 }
+  }
+  instance_estimate_t e;
+  e.variables= std::count(h.begin(), h.end(), true) +
+	 std::count(w.begin(), w.end(), true) +
+	 s_vars + dummy_vars + sel_vars;
+  e.clauses= clauses;
+  e.xor_clauses= xor_cls;
+  e.memory_mb= estimate_memory_mb(e, ped.size() * n_loci, xor_clauses);
+  DEBUG("Predicted SAT instance: " << e << " (" << s_vars <<
+		  " s variables and " << dummy_vars << " dummy variables).");
+  return e;
+}
+
+// Compute the size of the SAT instance of the loci in [first, last)
+template <typename T_GENOTYPE,
+			 typename T_HAPLOTYPE,
+			 typename T_PHENOTYPE,
+			 typename T_ID>
+instance_estimate_t
+predict_instance(const basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
+					  const size_t first, const size_t last,
+					  const bool xor_clauses,
+					  const bool break_symmetries= false,
+					  const bool guard_constraints= false) {
+  MY_ASSERT(first <= last);
+  MY_ASSERT(last <= ped.genotype_length());
+  std::vector<size_t> loci;
+  loci.reserve(last - first);
+  for (size_t l= first; l < last; ++l)
+	 loci.push_back(l);
+  return predict_instance(ped, loci, xor_clauses, break_symmetries,
+								  guard_constraints);
+}
+
+
+#endif // __INSTANCE_PREDICTOR_HPP__
@@ -0,0 +1,152 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * locus_dedup.hpp
+ *
+ * Functions to find the loci that do not need to be encoded in the SAT
+ * instance.
+ *
+ **/
+
+#ifndef __LOCUS_DEDUP_HPP__
+#define __LOCUS_DEDUP_HPP__
+
+#include "pedigree.hpp"
+#include "log.hpp"
+
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <log4cxx/logger.h>
+
+
+// A locus where every individual is genotyped and homozygous has fixed
+// haplotypes.  If it is also Mendelian-consistent, it does not constrain
+// the s variables and it does not need to be encoded.
+template <typename T_GENOTYPE,
+			 typename T_HAPLOTYPE,
+			 typename T_PHENOTYPE,
+			 typename T_ID>
+bool
+is_trivial_locus(const basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
+					  const size_t l) {
+  typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
+  BOOST_FOREACH( const typename family_t::individual_t& ind,
+					  ped.individuals() ) {
+	 if (!is_genotyped(ind.g(l)) || !is_homozigous(ind.g(l)))
+		return false;
+	 if (ind.has_father() && (ind.father().g(l) != ind.g(l)))
+		return false;
+	 if (ind.has_mother() && (ind.mother().g(l) != ind.g(l)))
+		return false;
+  }
+  return true;
+}
+
+template <typename T_GENOTYPE,
+			 typename T_HAPLOTYPE,
+			 typename T_PHENOTYPE,
+			 typename T_ID>
+bool
+have_same_genotypes(const basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
+						  const size_t l1, const size_t l2) {
+  typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
+  BOOST_FOREACH( const typename family_t::individual_t& ind,
+					  ped.individuals() ) {
+	 if (ind.g(l1) != ind.g(l2))
+		return false;
+  }
+  return true;
+}
+
+// Two loci with the same genotypes for every individual give the same
+// constraints (up to a renaming of the h and w variables), thus, once the
+// s variables are fixed, they have the same solutions.
+// For each locus l, 'locus_rep[l]' is set to the locus whose variables give
+// the haplotypes of l, and the loci that have to be encoded are stored in
+// 'encoded_loci'.  Trivial loci (see 'is_trivial_locus') are not encoded
+// and are represented by themselves (their haplotypes do not depend on any
+// variable).
+template <typename T_GENOTYPE,
+			 typename T_HAPLOTYPE,
+			 typename T_PHENOTYPE,
+			 typename T_ID>
+void
+compute_locus_representatives(const basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
+										std::vector<size_t>& locus_rep,
+										std::vector<size_t>& encoded_loci) {
+  log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("locus_dedup"));
+  typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
+  typedef boost::unordered_multimap<size_t, size_t> hash2locus_t;
+  DEBUG("Looking for equivalent loci...");
+  locus_rep.resize(ped.genotype_length());
+  encoded_loci.clear();
+  hash2locus_t reps;
+  size_t no_of_trivial= 0;
+  for (size_t l= 0; l < ped.genotype_length(); ++l) {
+	 locus_rep[l]= l;
+	 if (is_trivial_locus(ped, l)) {
+		TRACE("Locus " << l << " is trivial.");
+		++no_of_trivial;
+		continue;
+	 }
+	 size_t hash= 0;
+	 BOOST_FOREACH( const typename family_t::individual_t& ind,
+						 ped.individuals() ) {
+		const typename family_t::g& g= ind.g(l);
+		boost::hash_combine(hash,
+								  !is_genotyped(g) ? 0 :
+								  (is_heterozygous(g) ? 1 :
+									(g == family_t::g::HOMO1) ? 2 : 3));
+	 }
+	 std::pair<hash2locus_t::const_iterator, hash2locus_t::const_iterator> range=
+		reps.equal_range(hash);
+	 for (; range.first != range.second; ++range.first) {
+		if (have_same_genotypes(ped, range.first->second, l)) {
+		  locus_rep[l]= range.first->second;
+		  break;
+		}
+	 }
+	 if (locus_rep[l] == l) {
+		reps.insert(std::make_pair(hash, l));
+		encoded_loci.push_back(l);
+	 } else {
+		TRACE("Locus " << l << " is equivalent to locus " << locus_rep[l] << ".");
+	 }
+  }
+  INFO("Loci to encode: " << encoded_loci.size() << " out of " <<
+		 ped.genotype_length() << " (" << no_of_trivial << " trivial loci, " <<
+		 (ped.genotype_length() - no_of_trivial - encoded_loci.size()) <<
+		 " loci equivalent to other loci).");
+}
+
+
+#endif // __LOCUS_DEDUP_HPP__
@@ -0,0 +1,229 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * locus_windows.hpp
+ *
+ * Structures to split the loci of a pedigree into (possibly overlapping)
+ * windows that are encoded and solved independently.
+ *
+ **/
+
+#ifndef __LOCUS_WINDOWS_HPP__
+#define __LOCUS_WINDOWS_HPP__
+
+#include "pedigree.hpp"
+#include "pedcnf.hpp"
+#include "log.hpp"
+#include "assertion.hpp"
+
+#include <vector>
+#include <stdexcept>
+#include <ostream>
+
+#include <boost/foreach.hpp>
+
+
+// A window of loci [first, last).
+// The haplotypes of the loci in [owned, last) are computed from the
+// solution of the window, while the loci in [first, owned) are shared with
+// the previous windows and are only used to stitch the phases.
+struct locus_window_t {
+  size_t first;
+  size_t owned;
+  size_t last;
+
+  locus_window_t(const size_t first_, const size_t owned_, const size_t last_)
+		:first(first_), owned(owned_), last(last_)
+  {};
+};
+
+inline std::ostream&
+operator<<(std::ostream& out, const locus_window_t& window) {
+  return (out << "[" << window.first << ", " << window.last << ")");
+}
+
+// Split the loci [0, genotype_length) into windows of 'window_size' loci
+// such that two consecutive windows share 'window_overlap' loci.
+// The last window could be shorter.
+// A window size equal to 0 means a single window.
+inline std::vector<locus_window_t>
+compute_locus_windows(const size_t genotype_length,
+							 const size_t window_size,
+							 const size_t window_overlap) {
+  std::vector<locus_window_t> windows;
+  if ((window_size == 0) || (window_size >= genotype_length)) {
+	 windows.push_back(locus_window_t(0, 0, genotype_length));
+	 return windows;
+  }
+  if (window_overlap >= window_size) {
+	 throw std::logic_error(std::string("The window overlap must be "
+													"smaller than the window size."));
+  }
+  const size_t step= window_size - window_overlap;
+  size_t first= 0;
+  size_t last= 0;
+  do {
+	 const size_t owned= last;
+	 last= std::min(first + window_size, genotype_length);
+	 windows.push_back(locus_window_t(first, owned, last));
+	 first+= step;
+  } while (last < genotype_length);
+  return windows;
+}
+
+
+// The values of the h and w variables of a window (and the
+// heterozygosity of each individual in the corresponding solution).
+// It keeps only one byte for each individual and each locus of the
+// window, thus the SAT instance can be released as soon as the window
+// has been solved.
+class window_model_t {
+private:
+
+  static const unsigned char H_BIT= 1;
+  static const unsigned char W_BIT= 2;
+  static const unsigned char HETER_BIT= 4;
+
+  size_t _first;
+  size_t _len;
+  std::vector<unsigned char> _vals;
+
+  void set_bits(const pedcnf_t::varmap_t& map,
+					 const pedcnf_t& cnf,
+					 const unsigned char bit) {
+	 BOOST_FOREACH( const pedcnf_t::varmap_t::value_type& v, map ) {
+		const size_t l= boost::get<1>(v.first);
+		if ((_first <= l) && (l < _first+_len) && cnf.vals()[v.second-1]) {
+		  _vals[boost::get<0>(v.first)*_len + l-_first] |= bit;
+		}
+	 }
+  };
+
+public:
+
+  window_model_t()
+		:_first(0), _len(0)
+  {};
+
+  template <typename T_GENOTYPE,
+				typename T_HAPLOTYPE,
+				typename T_PHENOTYPE,
+				typename T_ID>
+  void set(const basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
+			  const pedcnf_t& cnf,
+			  const locus_window_t& window) {
+	 typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
+	 _first= window.first;
+	 _len= window.last - window.first;
+	 _vals.assign(ped.size() * _len, 0);
+	 set_bits(cnf.h(), cnf, H_BIT);
+	 set_bits(cnf.w(), cnf, W_BIT);
+	 BOOST_FOREACH( const typename family_t::individual_t& ind,
+						 ped.individuals() ) {
+		unsigned char* v= &_vals[ind.progr_id()*_len];
+		for (size_t l= window.first; l < window.last; ++l, ++v) {
+		  if (is_heterozygous(ind.g(l)) ||
+				(!is_genotyped(ind.g(l)) && ((*v) & W_BIT))) {
+			 (*v) |= HETER_BIT;
+		  }
+		}
+	 }
+  };
+
+  void clear() {
+	 std::vector<unsigned char>().swap(_vals);
+  };
+
+  bool h(const size_t i, const size_t l) const {
+	 return get(i, l) & H_BIT;
+  };
+
+  bool w(const size_t i, const size_t l) const {
+	 return get(i, l) & W_BIT;
+  };
+
+  bool is_heterozygous_at(const size_t i, const size_t l) const {
+	 return get(i, l) & HETER_BIT;
+  };
+
+private:
+
+  unsigned char get(const size_t i, const size_t l) const {
+	 MY_ASSERT_DBG((_first <= l) && (l < _first+_len));
+	 return _vals[i*_len + l-_first];
+  };
+
+};
+
+
+// Swapping the haplotypes of a founder does not modify the haplotypes of
+// its descendants (the s variables are negated accordingly).
+// Thus the phases of the founders computed on a window are aligned to the
+// phases already computed on the shared loci [first, owned): the
+// haplotypes of a founder on [owned, last) are swapped if its phases
+// disagree on the majority of the shared heterozygous loci.
+// It returns the number of founders whose haplotypes have been swapped.
+template <typename T_GENOTYPE,
+			 typename T_HAPLOTYPE,
+			 typename T_PHENOTYPE,
+			 typename T_ID>
+size_t
+stitch_founder_phases(basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
+							 const window_model_t& model,
+							 const locus_window_t& window) {
+  typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
+  size_t no_of_swaps= 0;
+  BOOST_FOREACH( typename family_t::individual_t& ind,
+					  ped.individuals() ) {
+	 if (!ind.is_founder())
+		continue;
+	 size_t agree= 0;
+	 size_t disagree= 0;
+	 for (size_t l= window.first; l < window.owned; ++l) {
+		if (model.is_heterozygous_at(ind.progr_id(), l) &&
+			 is_heterozygous(ind.g(l))) {
+		  const bool stitched_phase= (ind.hp(l) == family_t::h::ALLELE2);
+		  if (model.h(ind.progr_id(), l) == stitched_phase) {
+			 ++agree;
+		  } else {
+			 ++disagree;
+		  }
+		}
+	 }
+	 if (disagree > agree) {
+		for (size_t l= window.owned; l < window.last; ++l) {
+		  std::swap(ind.hp(l), ind.hm(l));
+		}
+		++no_of_swaps;
+	 }
+  }
+  return no_of_swaps;
+}
+
+
+#endif // __LOCUS_WINDOWS_HPP__
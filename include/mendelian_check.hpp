@@ -0,0 +1,145 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * mendelian_check.hpp
+ *
+ * Fast check of the Mendelian consistency of the genotyped trios of a
+ * pedigree (performed before encoding the pedigree).
+ *
+ **/
+
+#ifndef __MENDELIAN_CHECK_HPP__
+#define __MENDELIAN_CHECK_HPP__
+
+#include "pedigree.hpp"
+#include "log.hpp"
+
+#include <vector>
+#include <utility>
+#include <limits>
+
+#include <boost/cstdint.hpp>
+#include <boost/foreach.hpp>
+
+#include <log4cxx/logger.h>
+
+
+// The genotypes of an individual packed into three bit-vectors (one bit for
+// each locus): homozygous 1/1, homozygous 2/2, and heterozygous.
+// Missing genotypes have no bit set.
+class packed_genotype_t {
+public:
+  typedef boost::uint64_t word_t;
+  static const size_t WORD_BITS= std::numeric_limits<word_t>::digits;
+
+  std::vector<word_t> homo1;
+  std::vector<word_t> homo2;
+  std::vector<word_t> heter;
+
+  static size_t no_of_words(const size_t len) {
+	 return (len + WORD_BITS - 1) / WORD_BITS;
+  }
+
+  template <typename T_GENOTYPE>
+  void set(const T_GENOTYPE& g, const size_t len) {
+	 const size_t n_words= no_of_words(len);
+	 homo1.assign(n_words, 0);
+	 homo2.assign(n_words, 0);
+	 heter.assign(n_words, 0);
+	 for (size_t l= 0; l < len; ++l) {
+		const word_t bit= ((word_t)1) << (l % WORD_BITS);
+		if (is_heterozygous(g[l])) {
+		  heter[l / WORD_BITS] |= bit;
+		} else if (is_homozigous(g[l])) {
+		  if (g[l] == T_GENOTYPE::base::HOMO1) {
+			 homo1[l / WORD_BITS] |= bit;
+		  } else {
+			 homo2[l / WORD_BITS] |= bit;
+		  }
+		}
+	 }
+  }
+};
+
+// For each pair (child, parent) and (child, father, mother), the following
+// genotypes are Mendelian-inconsistent:
+//   - child 1/1 and a parent 2/2,
+//   - child 2/2 and a parent 1/1,
+//   - child 1/2 and both parents 1/1 or both parents 2/2.
+// Each such locus prevents any haplotype configuration (thus any
+// zero-recombinant one).
+// The offending pairs (progressive id of the child, locus) are stored in
+// 'errors'.  The check processes 64 loci at a time.
+template <typename T_GENOTYPE,
+			 typename T_HAPLOTYPE,
+			 typename T_PHENOTYPE,
+			 typename T_ID>
+bool
+check_mendelian_consistency(const basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
+									 std::vector< std::pair<size_t, size_t> >& errors) {
+  log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("mendelian_check"));
+  typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
+  typedef packed_genotype_t::word_t word_t;
+  const size_t WORD_BITS= packed_genotype_t::WORD_BITS;
+  DEBUG("Checking the Mendelian consistency of the pedigree...");
+  errors.clear();
+  const size_t len= ped.genotype_length();
+  const size_t n_words= packed_genotype_t::no_of_words(len);
+  std::vector<packed_genotype_t> packed(ped.size());
+  BOOST_FOREACH( const typename family_t::individual_t& ind,
+					  ped.individuals() ) {
+	 packed[ind.progr_id()].set(ind.g(), len);
+  }
+  const std::vector<word_t> none(n_words, 0);
+  BOOST_FOREACH( const typename family_t::individual_t& ind,
+					  ped.individuals() ) {
+	 if (ind.is_founder())
+		continue;
+	 const packed_genotype_t& c= packed[ind.progr_id()];
+	 const std::vector<word_t>& f1= ind.has_father() ? packed[ind.father().progr_id()].homo1 : none;
+	 const std::vector<word_t>& f2= ind.has_father() ? packed[ind.father().progr_id()].homo2 : none;
+	 const std::vector<word_t>& m1= ind.has_mother() ? packed[ind.mother().progr_id()].homo1 : none;
+	 const std::vector<word_t>& m2= ind.has_mother() ? packed[ind.mother().progr_id()].homo2 : none;
+	 for (size_t w= 0; w < n_words; ++w) {
+		word_t err=
+		  (c.homo1[w] & (f2[w] | m2[w])) |
+		  (c.homo2[w] & (f1[w] | m1[w])) |
+		  (c.heter[w] & ((f1[w] & m1[w]) | (f2[w] & m2[w])));
+		for (size_t bit= 0; err != 0; ++bit, err >>= 1) {
+		  if (err & 1) {
+			 errors.push_back(std::make_pair(ind.progr_id(), w * WORD_BITS + bit));
+		  }
+		}
+	 }
+  }
+  DEBUG("Found " << errors.size() << " Mendelian errors.");
+  return errors.empty();
+}
+
+
+#endif // __MENDELIAN_CHECK_HPP__
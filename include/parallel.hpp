@@ -0,0 +1,313 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * parallel.hpp
+ *
+ * Simple functions to execute independent tasks on a pool of threads.
+ *
+ **/
+
+#ifndef __PARALLEL_HPP__
+#define __PARALLEL_HPP__
+
+#include "log.hpp"
+#include "assertion.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+
+
+// Number of threads to use if 'n_threads' threads are requested
+// (0 means 'all the available hardware threads')
+inline unsigned int
+effective_no_of_threads(const unsigned int n_threads) {
+  if (n_threads > 0)
+	 return n_threads;
+  const unsigned int hw_threads= boost::thread::hardware_concurrency();
+  return (hw_threads > 0) ? hw_threads : 1;
+}
+
+
+// Execute 'task(i)' for each i in [0, n) on (at most) 'n_threads' threads.
+// Tasks are assigned dynamically to the threads, thus their order of
+// execution is not specified.
+// If the tasks have a weight (e.g. their expected memory usage), a task is
+// started only if the total weight of the running tasks does not exceed
+// 'budget' (a task heavier than the budget is executed alone).
+// The tasks are started in increasing order of i, but a task that does not
+// fit the budget is postponed and the following ones that fit are started.
+// If a task throws an exception, the remaining tasks are not started and
+// the exception is re-thrown (as a std::logic_error or as an
+// assertion_failed_exception) after all the threads have terminated.
+template <typename T_TASK>
+class parallel_for_t:
+  public log_able_t< parallel_for_t<T_TASK> >,
+  boost::noncopyable
+{
+private:
+
+  T_TASK& _task;
+  const size_t _n;
+  const std::vector<double>* const _weights;
+  const double _budget;
+
+  boost::mutex _mutex;
+  boost::condition_variable _cond;
+  size_t _next;
+  bool _failed;
+  bool _assertion_failed;
+  std::string _error;
+
+// Used only if the tasks have a weight
+  std::list<size_t> _pending;
+  double _used;
+  size_t _running;
+
+  bool get_next(size_t& i) {
+	 boost::mutex::scoped_lock lock(_mutex);
+	 if (_weights == NULL) {
+		if (_failed || (_next >= _n))
+		  return false;
+		i= _next;
+		++_next;
+		return true;
+	 }
+	 while (!_failed && !_pending.empty()) {
+		for (std::list<size_t>::iterator it= _pending.begin();
+			  it != _pending.end(); ++it) {
+		  const double w= (*_weights)[*it];
+		  if ((_running == 0) || (_used + w <= _budget)) {
+			 i= *it;
+			 _pending.erase(it);
+			 _used += w;
+			 ++_running;
+			 return true;
+		  }
+		}
+		_cond.wait(lock);
+	 }
+	 return false;
+  };
+
+  void release(const size_t i) {
+	 if (_weights == NULL)
+		return;
+	 {
+		boost::mutex::scoped_lock lock(_mutex);
+		_used -= (*_weights)[i];
+		--_running;
+	 }
+	 _cond.notify_all();
+  };
+
+  void fail(const std::string& error, const bool assertion_failed) {
+	 boost::mutex::scoped_lock lock(_mutex);
+	 if (!_failed) {
+		_failed= true;
+		_assertion_failed= assertion_failed;
+		_error= error;
+	 }
+	 _cond.notify_all();
+  };
+
+  void worker() {
+	 size_t i;
+	 while (get_next(i)) {
+		try {
+		  _task(i);
+		} catch (std::exception& e) {
+		  L_ERROR("Task " << i << " failed: " << e.what());
+		  fail(e.what(), false);
+		} catch (assertion_failed_exception& e) {
+		  L_ERROR("Task " << i << " failed: " << e.what());
+		  fail(e.what(), true);
+		}
+		release(i);
+	 }
+  };
+
+public:
+
+  parallel_for_t(T_TASK& task, const size_t n)
+		:_task(task), _n(n), _weights(NULL), _budget(0.0), _next(0),
+		 _failed(false), _assertion_failed(false), _used(0.0), _running(0)
+  {};
+
+  parallel_for_t(T_TASK& task, const size_t n,
+					  const std::vector<double>& weights, const double budget)
+		:_task(task), _n(n), _weights(&weights), _budget(budget), _next(0),
+		 _failed(false), _assertion_failed(false), _used(0.0), _running(0)
+  {
+	 MY_ASSERT( weights.size() == n );
+	 for (size_t i= 0; i < n; ++i)
+		_pending.push_back(i);
+  };
+
+  void run(const unsigned int n_threads) {
+	 const size_t threads= std::min((size_t)effective_no_of_threads(n_threads),
+											  _n);
+	 L_DEBUG("Executing " << _n << " tasks on " << threads << " threads...");
+	 if (threads <= 1) {
+		worker();
+	 } else {
+		boost::thread_group group;
+		for (size_t t= 0; t < threads; ++t) {
+		  group.create_thread(boost::bind(&parallel_for_t::worker, this));
+		}
+		group.join_all();
+	 }
+	 if (_failed) {
+		if (_assertion_failed)
+		  throw assertion_failed_exception(_error);
+		throw std::logic_error(_error);
+	 }
+	 L_DEBUG("All the tasks have been executed.");
+  };
+
+};
+
+template <typename T_TASK>
+void parallel_for(const size_t n, T_TASK& task, const unsigned int n_threads) {
+  parallel_for_t<T_TASK> pf(task, n);
+  pf.run(n_threads);
+}
+
+template <typename T_TASK>
+void parallel_for(const size_t n, T_TASK& task,
+						const std::vector<double>& weights, const double budget,
+						const unsigned int n_threads) {
+  parallel_for_t<T_TASK> pf(task, n, weights, budget);
+  pf.run(n_threads);
+}
+
+
+// A fixed set of threads that execute the submitted tasks (in order of
+// submission) until the pool is destroyed.
+// It is meant for long-running processes that receive work over time, so
+// that threads are not created for each piece of work.
+// A task that throws an exception is reported and does not stop the pool.
+class thread_pool_t:
+  public log_able_t<thread_pool_t>,
+  boost::noncopyable
+{
+public:
+
+  typedef boost::function<void ()> task_t;
+
+private:
+
+  boost::mutex _mutex;
+  boost::condition_variable _cond;
+  boost::condition_variable _idle_cond;
+  std::list<task_t> _tasks;
+  size_t _running;
+  bool _stopping;
+  boost::thread_group _group;
+
+  bool get_next(task_t& task) {
+	 boost::mutex::scoped_lock lock(_mutex);
+	 while (!_stopping && _tasks.empty())
+		_cond.wait(lock);
+	 if (_tasks.empty())
+		return false;
+	 task= _tasks.front();
+	 _tasks.pop_front();
+	 ++_running;
+	 return true;
+  };
+
+  void worker() {
+	 task_t task;
+	 while (get_next(task)) {
+		try {
+		  task();
+		} catch (std::exception& e) {
+		  L_ERROR("Task failed: " << e.what());
+		} catch (assertion_failed_exception& e) {
+		  L_ERROR("Task failed: " << e.what());
+		}
+		{
+		  boost::mutex::scoped_lock lock(_mutex);
+		  --_running;
+		}
+		_idle_cond.notify_all();
+	 }
+  };
+
+public:
+
+  explicit thread_pool_t(const unsigned int n_threads)
+		:_running(0), _stopping(false)
+  {
+	 const unsigned int threads= effective_no_of_threads(n_threads);
+	 L_DEBUG("Starting a pool of " << threads << " threads...");
+	 for (unsigned int t= 0; t < threads; ++t) {
+		_group.create_thread(boost::bind(&thread_pool_t::worker, this));
+	 }
+  };
+
+// The pending tasks are executed before the threads terminate
+  ~thread_pool_t() {
+	 {
+		boost::mutex::scoped_lock lock(_mutex);
+		_stopping= true;
+	 }
+	 _cond.notify_all();
+	 _group.join_all();
+  };
+
+  size_t size() const {
+	 return _group.size();
+  };
+
+  void submit(const task_t& task) {
+	 {
+		boost::mutex::scoped_lock lock(_mutex);
+		_tasks.push_back(task);
+	 }
+	 _cond.notify_one();
+  };
+
+// Wait until every submitted task has been executed
+  void wait() {
+	 boost::mutex::scoped_lock lock(_mutex);
+	 while (!_tasks.empty() || (_running > 0))
+		_idle_cond.wait(lock);
+  };
+
+};
+
+
+#endif // __PARALLEL_HPP__
@@ -49,6 +49,7 @@
 #include <iomanip>
 
 #include <boost/foreach.hpp>
+#include <boost/iterator/counting_iterator.hpp>
 
 
 
@@ -90,6 +91,10 @@ public:
 // Data members
 private:
 
+  const bool _break_symmetries;
+  const bool _s_vars_first;
+  const bool _guard_constraints;
+
 public:
 
 // Methods
@@ -159,8 +164,15 @@ private:
 	 }
 	 constant = constant % 2;
 	 if (constraint.children.empty()) {
-		MY_ASSERT_DBG(constant == 0);
-		L_TRACE("     ANF: empty");
+		if (constant == 0) {
+		  L_TRACE("     ANF: empty");
+		} else {
+// Mendelian error between two homozygous genotypes: the instance is
+// unsatisfiable
+		  L_DEBUG("Mendelian error between individuals " << progr_id_parent <<
+					 " and " << progr_id_ind << " at locus " << locus << ".");
+		  cnf.add_clause(typename T_PEDCNF::clause_t());
+		}
 	 } else {
 		if (constraint.children.size() == 1) {
 		  if (constant == 0) {
@@ -181,21 +193,104 @@ private:
 	 }
   };
 
-public:
+// The haplotypes of a founder can be swapped (and, accordingly, the
+// s variables of its children can be negated) without affecting the
+// satisfiability of the instance.
+// Each founder with children is thus forced to carry allele 1 on its
+// paternal haplotype at its first heterozygous locus.
+// Only the loci in [encoded_from, last) are considered and the constraint
+// is added only if such locus is in [first, last) (i.e. if it has not
+// been added while encoding the previous loci).
+  template <typename T_IT>
+  void add_symmetry_breaking_constraints(T_PEDCNF& cnf,
+													  const pedigree_t& ped,
+													  const T_IT first,
+													  const T_IT last,
+													  const T_IT encoded_from) {
+	 size_t no_of_constraints= 0;
+	 BOOST_FOREACH( const individual_t& ind,
+						 ped.individuals() ) {
+		if (!ind.is_founder() || !ind.has_children())
+		  continue;
+		T_IT l= encoded_from;
+		while ((l != last) && !is_heterozygous(ind.g(*l)))
+		  ++l;
+		if ((l != last) && (first <= l)) {
+		  L_TRACE("Fixing the phase of founder " << ind.progr_id() <<
+					 " at locus " << *l);
+		  typename T_PEDCNF::clause_t clause;
+		  clause.insert(-cnf.get_h(ind.progr_id(), *l));
+		  cnf.add_clause(clause);
+		  ++no_of_constraints;
+		}
+	 }
+	 L_DEBUG("Added " << no_of_constraints <<
+				" symmetry-breaking constraints.");
+  };
 
-  T_PEDCNF* convert(const pedigree_t& ped) {
-	 T_PEDCNF* pcnf= new T_PEDCNF;
-	 T_PEDCNF& cnf= *pcnf;
+// Once every s variable is fixed, the instance decomposes into independent
+// per-locus problems that are solved by unit propagation.
+// Allocating the s variables before any other variable gives them the
+// smallest indices, thus the solver branches on them first among the
+// variables with the same activity (i.e. at the beginning of the search,
+// before VSIDS activity takes over).
+// Only the s variables of parents that are not homozygous at every
+// encoded locus are allocated (the others do not appear in any
+// constraint).
+  template <typename T_IT>
+  void allocate_s_vars(T_PEDCNF& cnf,
+							  const pedigree_t& ped,
+							  const T_IT first,
+							  const T_IT last) {
+	 BOOST_FOREACH( const individual_t& ind,
+						 ped.individuals() ) {
+		if (ind.has_father() &&
+			 !is_homozygous_everywhere(ind.father(), first, last)) {
+		  cnf.get_s(ind.father().progr_id(), ind.progr_id());
+		}
+		if (ind.has_mother() &&
+			 !is_homozygous_everywhere(ind.mother(), first, last)) {
+		  cnf.get_s(ind.mother().progr_id(), ind.progr_id());
+		}
+	 }
+	 L_DEBUG("Allocated " << cnf.s().size() << " s variables in advance.");
+  };
+
+  template <typename T_IT>
+  bool is_homozygous_everywhere(const individual_t& ind,
+										  const T_IT first,
+										  const T_IT last) const {
+	 for (T_IT l= first; l != last; ++l) {
+		if (!is_homozigous(ind.g(*l)))
+		  return false;
+	 }
+	 return true;
+  };
+
+// Add to 'cnf' the constraints of the loci in the sequence [first, last).
+// 'encoded_from' is the first locus of the sequence that has been encoded
+// in 'cnf' (by this call or by the previous ones) and it is used to add
+// the symmetry-breaking constraints only once.
+  template <typename T_IT>
+  void add_constraints(T_PEDCNF& cnf,
+							  const pedigree_t& ped,
+							  const T_IT first, const T_IT last,
+							  const T_IT encoded_from) {
+	 if (_s_vars_first) {
+		allocate_s_vars(cnf, ped, first, last);
+	 }
 	 BOOST_FOREACH( const individual_t& ind,
 						 ped.individuals() ) {
 		L_TRACE("Considering individual " << ind.progr_id());
 		if (ind.has_father()) {
 		  L_TRACE(" --> father " << ind.father().progr_id());
 		  const individual_t& parent= ind.father();
-		  for (size_t l= 0; l < ped.genotype_length(); ++l) {
+		  for (T_IT it= first; it != last; ++it) {
+			 const size_t l= *it;
 			 L_TRACE("  locus = " << l <<
 						", g_f = " << parent.g(l) <<
 						", g_i = " << ind.g(l));
+			 set_selector(cnf, ind, l);
 			 add_constraint(cnf,
 								 parent.g(l), ind.g(l),
 								 l,
@@ -206,10 +301,12 @@ public:
 		if (ind.has_mother()) {
 		  L_TRACE(" --> mother " << ind.mother().progr_id());
 		  const individual_t& parent= ind.mother();
-		  for (size_t l= 0; l < ped.genotype_length(); ++l) {
+		  for (T_IT it= first; it != last; ++it) {
+			 const size_t l= *it;
 			 L_TRACE("  locus = " << l <<
 						", g_f = " << parent.g(l) <<
 						", g_i = " << ind.g(l));
+			 set_selector(cnf, ind, l);
 			 add_constraint(cnf,
 								 parent.g(l), ind.g(l),
 								 l,
@@ -218,11 +315,116 @@ public:
 		  }
 		}
 	 }
+	 cnf.set_selector(0);
+	 if (_break_symmetries) {
+		add_symmetry_breaking_constraints(cnf, ped, first, last, encoded_from);
+	 }
+  };
+
+// If the constraints are guarded, the constraints between an individual
+// and its parents at a locus form a group that is enabled by a selector
+// variable (see pedcnf_t::solve_with_selectors).
+  void set_selector(T_PEDCNF& cnf,
+						  const individual_t& ind,
+						  const size_t l) const {
+	 if (_guard_constraints) {
+		cnf.set_selector(cnf.get_selector(ind.progr_id(), l));
+	 }
+  };
+
+  void log_size(const T_PEDCNF& cnf) const {
 	 L_INFO("The SAT instance is composed by " <<
 			  std::setw(8) << cnf.vars().size() << " variables and " <<
 			  std::setw(8) << cnf.no_of_clauses() << " clauses");
+  };
+
+public:
+
+  explicit ped2cnf_conv_t(const bool break_symmetries= false,
+								  const bool s_vars_first= false,
+								  const bool guard_constraints= false)
+		:_break_symmetries(break_symmetries), _s_vars_first(s_vars_first),
+		 _guard_constraints(guard_constraints)
+  {};
+
+  T_PEDCNF* convert(const pedigree_t& ped) {
+	 return convert(ped, 0, ped.genotype_length());
+  };
+
+// Encode only the loci in [first, last)
+  T_PEDCNF* convert(const pedigree_t& ped,
+						  const size_t first, const size_t last) {
+	 T_PEDCNF* pcnf= new T_PEDCNF;
+	 add_loci(*pcnf, ped, first, last, first);
+	 log_size(*pcnf);
 	 return pcnf;
   };
+
+// Encode only the given loci (in the given order)
+  T_PEDCNF* convert(const pedigree_t& ped,
+						  const std::vector<size_t>& loci) {
+	 BOOST_FOREACH( const size_t l, loci ) {
+		MY_ASSERT(l < ped.genotype_length());
+	 }
+	 T_PEDCNF* pcnf= new T_PEDCNF;
+	 add_constraints(*pcnf, ped, loci.begin(), loci.end(), loci.begin());
+	 log_size(*pcnf);
+	 return pcnf;
+  };
+
+// If the s variables are numbered first, allocate the s variables of
+// every locus of the pedigree, thus the s variables of the loci encoded
+// later (e.g. block by block with 'add_loci') are numbered before the
+// variables of the loci already encoded.
+  void number_s_vars_first(T_PEDCNF& cnf,
+									const pedigree_t& ped) {
+	 if (_s_vars_first) {
+		typedef boost::counting_iterator<size_t> locus_it;
+		allocate_s_vars(cnf, ped, locus_it(0), locus_it(ped.genotype_length()));
+	 }
+  };
+
+// Encode again the constraints between an individual and its parents at
+// locus l (e.g. after their genotypes have changed).
+// The constraints must be guarded: the previous ones are disabled and the
+// new ones are guarded by a new selector.
+  void renew_constraints(T_PEDCNF& cnf,
+								 const individual_t& ind,
+								 const size_t l) {
+	 MY_ASSERT(_guard_constraints);
+	 cnf.set_selector(cnf.renew_selector(ind.progr_id(), l));
+	 if (ind.has_father()) {
+		add_constraint(cnf,
+							ind.father().g(l), ind.g(l),
+							l,
+							ind.father().progr_id(), ind.progr_id(),
+							false);
+	 }
+	 if (ind.has_mother()) {
+		add_constraint(cnf,
+							ind.mother().g(l), ind.g(l),
+							l,
+							ind.mother().progr_id(), ind.progr_id(),
+							true);
+	 }
+	 cnf.set_selector(0);
+  };
+
+// Add to 'cnf' the constraints of the loci in [first, last).
+// 'encoded_from' is the first locus that has been encoded in 'cnf' (by
+// this call or by the previous ones) and it is used to add the
+// symmetry-breaking constraints only once.
+  void add_loci(T_PEDCNF& cnf,
+					 const pedigree_t& ped,
+					 const size_t first, const size_t last,
+					 const size_t encoded_from) {
+	 MY_ASSERT(encoded_from <= first);
+	 MY_ASSERT(first <= last);
+	 MY_ASSERT(last <= ped.genotype_length());
+	 typedef boost::counting_iterator<size_t> locus_it;
+	 add_constraints(cnf, ped, locus_it(first), locus_it(last),
+						  locus_it(encoded_from));
+  };
 };
 
 template <
@@ -235,8 +437,11 @@ pedcnf_t*
 ped2cnf(const basic_pedigree_t<T_GENOTYPE,
 						T_HAPLOTYPE,
 						T_PHENOTYPE,
-						T_ID>& ped) {
-  ped2cnf_conv_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID, pedcnf_t> conv;
+						T_ID>& ped,
+		  const bool break_symmetries= false,
+		  const bool s_vars_first= false) {
+  ped2cnf_conv_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID, pedcnf_t>
+	 conv(break_symmetries, s_vars_first);
   return conv.convert(ped);
 }
 
@@ -250,8 +455,11 @@ pedcnf_ext_t*
 ped2cnf_ext(const basic_pedigree_t<T_GENOTYPE,
 											  T_HAPLOTYPE,
 											  T_PHENOTYPE,
-											  T_ID>& ped) {
-  ped2cnf_conv_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID, pedcnf_ext_t> conv;
+											  T_ID>& ped,
+				const bool break_symmetries= false,
+				const bool s_vars_first= false) {
+  ped2cnf_conv_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID, pedcnf_ext_t>
+	 conv(break_symmetries, s_vars_first);
   return conv.convert(ped);
 }
 
@@ -39,6 +39,7 @@
 #include "data.hpp"
 #include "log.hpp"
 #include "utility.hpp"
+#include "clause_buffer.hpp"
 
 // Include the SAT solver interface (if asked to do so)
 #include "sat_solver_interface.hpp"
@@ -53,11 +54,11 @@
 
 
 class ped_var_kind
-  :public enum_like_t<ped_var_kind, 4, 3>
+  :public enum_like_t<ped_var_kind, 5, 3>
 {
 private:
 
-  typedef enum_like_t<ped_var_kind, 4, 3> base;
+  typedef enum_like_t<ped_var_kind, 5, 3> base;
 
   ped_var_kind(const int val)
 		:base(val)
@@ -73,6 +74,7 @@ public:
   static const ped_var_kind W;
   static const ped_var_kind S;
   static const ped_var_kind DUMMY;
+  static const ped_var_kind SELECTOR;
 
   static const int int_values[];
   static const std::string str_values[];
@@ -109,14 +111,26 @@ private:
   varmap_t _w;
   varmap_t _s;
   varmap_t _dummy;
+  varmap_t _sel;
 
   varvec_t _vars;
   valvec_t _vals;
 
   size_t _no_of_clauses;
 
+  std::vector<size_t> _locus_rep;
+
+// If not 0, the negation of this variable is added to each clause
+  int _selector;
+
+// The clauses added so far, if they are kept (see 'keep_clauses')
+  bool _keep_clauses;
+  std::vector< std::vector<int> > _kept_clauses;
+
 #ifndef ONLY_INTERNAL_SAT_SOLVER
   clauses_t _clauses;
+// The same clauses (each one once), used to check assignments
+  clause_buffer_t _clause_buffer;
 #endif // ONLY_INTERNAL_SAT_SOLVER
 
 
@@ -143,11 +157,20 @@ private:
   bool get_val(const varmap_t& map,
 					const size_t i1, const size_t i2) const;
 
+  void add_clause_impl(const clause_t& clause);
+
+protected:
+
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+// The values of the variables as a table indexed by variable
+  void get_value_table(clause_buffer_t::value_table_t& vals) const;
+#endif // ONLY_INTERNAL_SAT_SOLVER
+
 
 public:
 
   pedcnf_t()
-		:_no_of_clauses(0)
+		:_no_of_clauses(0), _selector(0), _keep_clauses(false)
   {};
 
   virtual ~pedcnf_t() {
@@ -169,12 +192,50 @@ public:
 
   int get_dummy(const int v1, const int v2) const;
 
+// The selector of the constraints of individual i (and its parents) at
+// locus l
+  int get_selector(const size_t i, const size_t l);
+
+// Add a new variable with the given kind and indexes (e.g. to restore an
+// instance with the same numbering of the variables).
+// A selector replaces the current selector of its group.
+// Return the new variable.
+  int add_var(const pedvar_t& var);
+
+// Replace the selector of the constraints of individual i at locus l with
+// a new variable and disable the constraints guarded by the old selector
+// (e.g. to encode them again after a genotype has changed).
+// Return the new selector.
+  int renew_selector(const size_t i, const size_t l);
+
+// Guard the following clauses with the given selector (0 means no
+// selector), i.e. the clauses are enforced only when the selector is true
+  void set_selector(const int sel) {
+	 _selector= sel;
+  };
+
+  int selector() const {
+	 return _selector;
+  };
+
+// The values of h_i_l and w_i_l.
+// If locus l has not been encoded since it is equivalent to another
+// locus (its representative), the values of the variables of the
+// representative are returned.
   bool h(const size_t i, const size_t l) const {
-	 return get_val(_h, i, l);
+	 return get_val(_h, i, locus_representative(l));
   };
 
   bool w(const size_t i, const size_t l) const {
-	 return get_val(_w, i, l);
+	 return get_val(_w, i, locus_representative(l));
+  };
+
+  void set_locus_representatives(const std::vector<size_t>& locus_rep) {
+	 _locus_rep= locus_rep;
+  };
+
+  size_t locus_representative(const size_t l) const {
+	 return (l < _locus_rep.size()) ? _locus_rep[l] : l;
   };
 
   bool s(const size_t p, const size_t i) const {
@@ -201,6 +262,10 @@ public:
 	 return _dummy;
   };
 
+  const varmap_t& selectors() const {
+	 return _sel;
+  };
+
   const varvec_t& vars() const {
 	 return _vars;
   };
@@ -219,10 +284,27 @@ public:
 	 return _no_of_clauses;
   };
 
+  virtual size_t no_of_xor_clauses() const {
+	 return 0;
+  };
+
   void add_clause(const clause_t& clause);
 
+// Keep the clauses added from now on (as given to the SAT solver), so that
+// the instance can be saved also without the external SAT solvers
+  void keep_clauses() {
+	 _keep_clauses= true;
+  };
+
+  const std::vector< std::vector<int> >& kept_clauses() const {
+	 return _kept_clauses;
+  };
+
 #ifndef ONLY_INTERNAL_SAT_SOLVER
-  virtual bool is_satisfying_assignment() const;
+// Check if the current assignment satisfies every clause.
+// The clauses can be checked on 'n_threads' threads (0 means all the
+// available hardware threads).
+  virtual bool is_satisfying_assignment(const unsigned int n_threads= 1) const;
 
   virtual std::ostream& clauses_to_dimacs_format(std::ostream& out) const;
   virtual std::ostream& clauses_to_dimacs_format(std::ostream& out,
@@ -230,6 +312,9 @@ public:
   virtual std::ostream& clauses_to_dimacs_format(std::ostream& out,
 																 const std::vector< std::string >& notes) const;
 
+// Write the instance in the binary format (see 'binary_instance.hpp')
+  virtual std::ostream& clauses_to_binary_format(std::ostream& out) const;
+
   std::string clauses_to_dimacs_format() const {
 	 std::ostringstream out;
 	 clauses_to_dimacs_format(out);
@@ -247,23 +332,71 @@ public:
   };
 #endif // ONLY_INTERNAL_SAT_SOLVER
 
+// Read the assignment from the result of a SAT solver, either in the
+// MiniSat format or in the format of the SAT competitions (see
+// 'sat_result_reader.hpp').
+// 'decided' is false if the result does not state whether the clauses are
+// satisfiable or not.
+  bool read_assignment(std::istream& in, bool& decided);
+
 // Read the assignment from a file like the following one:
 // SAT/UNSAT
 // 1 -2 3 4 0
+// An undecided result (such as INDET) raises std::logic_error.
   bool assignment_from_minisat_format(std::istream& in);
 
+// Read the assignment from the output of a solver in the format of the
+// SAT competitions:
+// c comment
+// s SATISFIABLE (or s UNSATISFIABLE, or s UNKNOWN)
+// v 1 -2 3
+// v 4 0
+  bool assignment_from_competition_format(std::istream& in, bool& decided);
+
 
 #ifdef INTERNAL_SAT_SOLVER
+  void set_incremental(const bool incremental) {
+	 _solver.set_incremental(incremental);
+  };
+
   bool solve() {
 	 const bool ret= _solver.solve();
 	 if (ret) {
-		for (Var var = 0; var != _solver.no_of_vars(); var++) {
-		  _vals[var]= _solver.model(var);
-		}
-	 } else {
+		_solver.model(_vals);
 	 }
 	 return ret;
   };
+
+// Check if the last solve has been interrupted (i.e., it is not known if
+// the instance is satisfiable)
+  bool is_interrupted() const {
+	 return _solver.is_interrupted();
+  };
+
+// Solve the instance assuming that every selector is true.
+// If the instance is unsatisfiable, 'core' is set to the selectors of a
+// subset of the constraint groups that is still unsatisfiable (the final
+// conflict of the solver, shrunk by solving again only under its
+// selectors until it does not decrease anymore).
+  bool solve_with_selectors(std::vector<pedvar_t>& core);
+
+// Make the solver prefer the given values of the variables (e.g. the
+// last model) when it branches
+  void seed_phases(const valvec_t& vals) {
+	 _solver.set_polarities(vals);
+  };
+
+// The learnt clauses of at most 'max_size' literals over the variables of
+// the instance
+  void learnt_clauses(std::vector< std::vector<int> >& clauses,
+							 const size_t max_size) const;
+
+// Add the learnt clauses (obtained by 'learnt_clauses' from an instance
+// with the same variables and clauses) whose variables are in the
+// instance.
+// It must be called before the first solve.
+// Return the number of added clauses.
+  size_t add_learnt_clauses(const std::vector< std::vector<int> >& clauses);
 #endif // INTERNAL_SAT_SOLVER
 
 };
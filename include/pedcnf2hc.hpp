@@ -39,84 +39,303 @@
 
 #include "pedigree.hpp"
 #include "pedcnf.hpp"
+#include "parallel.hpp"
 #include "log.hpp"
 
+#include <vector>
+#include <algorithm>
+
 #include <log4cxx/logger.h>
 
+#include <boost/cstdint.hpp>
 #include <boost/foreach.hpp>
 
 
+// The values of the h and w variables of a SAT instance stored as two
+// bit-vectors (64 loci per word) for each individual.
+// The values are read once from the model of the instance, thus h(i, l)
+// and w(i, l) do not look up the variable maps.
+// Variables that do not exist in the instance (for example those of
+// not-genotyped individuals without relatives) are false.
+// Loci that have not been encoded get the values of their representative.
+class packed_model_t {
+public:
+  typedef boost::uint64_t word_t;
+  static const size_t WORD_BITS= 64;
+
+private:
+  const size_t _n_words;
+  std::vector<word_t> _h;
+  std::vector<word_t> _w;
+
+  static void set_bits(std::vector<word_t>& bits,
+							  const size_t n_words,
+							  const pedcnf_t::varmap_t& vars,
+							  const pedcnf_t::valvec_t& vals) {
+	 BOOST_FOREACH( const pedcnf_t::varmap_t::value_type& v, vars ) {
+		if (vals[v.second-1]) {
+		  const size_t i= v.first.get<0>();
+		  const size_t l= v.first.get<1>();
+		  bits[i*n_words + l/WORD_BITS] |= ((word_t)1) << (l%WORD_BITS);
+		}
+	 }
+  };
+
+  static bool get_bit(const std::vector<word_t>& bits,
+							 const size_t n_words,
+							 const size_t i, const size_t l) {
+	 return (bits[i*n_words + l/WORD_BITS] >> (l%WORD_BITS)) & 1;
+  };
+
+  static void copy_bit(std::vector<word_t>& bits,
+							  const size_t n_words,
+							  const size_t i, const size_t from, const size_t to) {
+	 const word_t bit= ((word_t)1) << (to%WORD_BITS);
+	 if (get_bit(bits, n_words, i, from)) {
+		bits[i*n_words + to/WORD_BITS] |= bit;
+	 } else {
+		bits[i*n_words + to/WORD_BITS] &= ~bit;
+	 }
+  };
+
+public:
+
+  packed_model_t(const pedcnf_t& cnf,
+					  const size_t no_of_individuals,
+					  const size_t genotype_length)
+		:_n_words((genotype_length + WORD_BITS - 1) / WORD_BITS),
+		 _h(no_of_individuals*_n_words, 0),
+		 _w(no_of_individuals*_n_words, 0)
+  {
+	 set_bits(_h, _n_words, cnf.h(), cnf.vals());
+	 set_bits(_w, _n_words, cnf.w(), cnf.vals());
+	 for (size_t l= 0; l < genotype_length; ++l) {
+		const size_t rep= cnf.locus_representative(l);
+		if (rep != l) {
+		  for (size_t i= 0; i < no_of_individuals; ++i) {
+			 copy_bit(_h, _n_words, i, rep, l);
+			 copy_bit(_w, _n_words, i, rep, l);
+		  }
+		}
+	 }
+  };
+
+  bool h(const size_t i, const size_t l) const {
+	 return get_bit(_h, _n_words, i, l);
+  };
+
+  bool w(const size_t i, const size_t l) const {
+	 return get_bit(_w, _n_words, i, l);
+  };
+
+  size_t no_of_words() const {
+	 return _n_words;
+  };
+
+// The values of the h (w) variables of individual i at the loci of the
+// k-th word (locus l is the bit l%WORD_BITS of the word l/WORD_BITS)
+  word_t h_word(const size_t i, const size_t k) const {
+	 return _h[i*_n_words + k];
+  };
+
+  word_t w_word(const size_t i, const size_t k) const {
+	 return _w[i*_n_words + k];
+  };
+};
+
+
+// The values of the h and w variables of an individual at the loci of a
+// word of a packed model, given by methods h(i, l) and w(i, l) with a shift
+// and a mask (the locus must be in the word, while i is ignored)
+class packed_word_t {
+private:
+  const packed_model_t::word_t _h;
+  const packed_model_t::word_t _w;
+  const size_t _first;
+
+public:
+  packed_word_t(const packed_model_t& model,
+					 const size_t i, const size_t k)
+		:_h(model.h_word(i, k)), _w(model.w_word(i, k)),
+		 _first(k*packed_model_t::WORD_BITS)
+  {};
+
+  bool h(const size_t, const size_t l) const {
+	 return (_h >> (l - _first)) & 1;
+  };
+
+  bool w(const size_t, const size_t l) const {
+	 return (_w >> (l - _first)) & 1;
+  };
+};
+
+
+// Compute the haplotypes of an individual at a locus:
+//   (1) the locus is genotyped and it is homozygous (thus the haplotype
+//       is 'fixed'), or
+//   (2) the values of h_i_l (and w_i_l) give the haplotypes.
+// T_MODEL is any class that gives the values of the h and w variables
+// by methods h(i, l) and w(i, l) (such as pedcnf_t or packed_word_t).
+template <typename T_INDIVIDUAL,
+			 typename T_FAMILY,
+			 typename T_MODEL>
+void compute_locus_HC_from_SAT(log4cxx::LoggerPtr& logger,
+										 T_INDIVIDUAL& ind,
+										 const T_MODEL& cnf,
+										 const size_t locus) {
+  typedef T_FAMILY family_t;
+  if ( ! is_genotyped(ind.g(locus)) ) {
+//      Individual not genotyped ->
+//        -> imputing genotype based on variables w_i_l and h_i_l
+	 TRACE("Individual " << ind.progr_id() << " at locus " << locus
+			 << " is not genotyped.");
+	 bool hil= cnf.h(ind.progr_id(), locus);
+	 bool wil= cnf.w(ind.progr_id(), locus);
+	 TRACE("hil " << hil << "   wil " << wil);
+	 if ( ! wil) {
+		DEBUG("Not-genotyped individual " << ind.progr_id() <<
+				" at locus " << locus << " is imputed as homozygous.");
+		if ( ! hil ) {
+		  ind.g(locus)= family_t::g::HOMO1;
+		} else {
+		  ind.g(locus)= family_t::g::HOMO2;
+		}
+	 } else {
+		DEBUG("Not-genotyped individual " << ind.progr_id() <<
+				" at locus " << locus << " is imputed as heterozygous.");
+		ind.g(locus)= family_t::g::HETER;
+	 }
+  }
+  if ( is_genotyped(ind.g(locus)) ) {
+	 if ( is_homozigous(ind.g(locus)) ) {
+//        Individual genotyped and homozygous ->
+//          -> haplotype is fixed and predetermined
+		TRACE("Individual " << ind.progr_id() << " at locus " << locus
+				<< " is genotyped and homozygous.");
+		ind.hp(locus)= ind.hm(locus)=
+		  homozygous_to_haplotype<typename family_t::h, typename family_t::g>(ind.g(locus));
+	 } else {
+//        Individual genotyped and heterozygous ->
+//          -> haplotype depends on variable h_i_l
+		MY_ASSERT( is_heterozygous(ind.g(locus)) );
+		TRACE("Individual " << ind.progr_id() << " at locus " << locus
+				<< " is genotyped and heterozygous.");
+		bool hil= cnf.h(ind.progr_id(), locus);
+		if ( ! hil) {
+		  ind.hp(locus)= family_t::h::ALLELE1;
+		  ind.hm(locus)= family_t::h::ALLELE2;
+		} else {
+		  ind.hp(locus)= family_t::h::ALLELE2;
+		  ind.hm(locus)= family_t::h::ALLELE1;
+		}
+	 }
+  } else {
+	 MY_FAIL;
+  }
+};
+
+
+// Compute the haplotypes of an individual at the loci in [first, last).
+// T_MODEL is any class that gives the values of the h and w variables
+// by methods h(i, l) and w(i, l) (such as pedcnf_t or packed_model_t).
+template <typename T_INDIVIDUAL,
+			 typename T_FAMILY,
+			 typename T_MODEL>
+void compute_individual_HC_from_SAT(T_INDIVIDUAL& ind,
+												const T_MODEL& cnf,
+												const size_t first, const size_t last) {
+  log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("pedcnf2hc"));
+  TRACE("Considering individual " << ind.progr_id());
+  for (size_t locus= first; locus < last; ++locus) {
+	 compute_locus_HC_from_SAT<T_INDIVIDUAL, T_FAMILY>(logger, ind, cnf, locus);
+  }
+};
+
+
+// Compute the haplotypes of an individual at the first 'n_loci' loci from
+// a packed model, whose values are extracted a word (64 loci) at a time.
+template <typename T_INDIVIDUAL,
+			 typename T_FAMILY>
+void compute_individual_HC_from_packed_model(T_INDIVIDUAL& ind,
+															const packed_model_t& model,
+															const size_t n_loci) {
+  log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("pedcnf2hc"));
+  TRACE("Considering individual " << ind.progr_id());
+  for (size_t k= 0; k < model.no_of_words(); ++k) {
+	 const packed_word_t word(model, ind.progr_id(), k);
+	 const size_t first= k*packed_model_t::WORD_BITS;
+	 const size_t last= std::min(n_loci, first + packed_model_t::WORD_BITS);
+	 for (size_t locus= first; locus < last; ++locus) {
+		compute_locus_HC_from_SAT<T_INDIVIDUAL, T_FAMILY>(logger, ind, word, locus);
+	 }
+  }
+};
+
+
+// Compute the haplotypes of the loci in [first, last).
+// T_MODEL is any class that gives the values of the h and w variables
+// by methods h(i, l) and w(i, l) (such as pedcnf_t).
 template <typename T_GENOTYPE,
 			 typename T_HAPLOTYPE,
 			 typename T_PHENOTYPE,
-			 typename T_ID>
+			 typename T_ID,
+			 typename T_MODEL>
 void compute_ZRHC_from_SAT(basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
-									const pedcnf_t& cnf) {
+									const T_MODEL& cnf,
+									const size_t first, const size_t last) {
   log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("pedcnf2hc"));
   typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
-  INFO("Computing the zero-recombinant haplotype configuration...");
-// For each locus in each individual:
-//   (1) the locus is genotyped and it is homozygous (thus the haplotype
-//       is 'fixed'), or
-//   (2) there exists a H_i[j] variable in the SAT instance.
+  MY_ASSERT(first <= last);
+  MY_ASSERT(last <= ped.genotype_length());
+  DEBUG("Computing the haplotypes of loci [" << first << ", " << last << ")...");
   BOOST_FOREACH( typename family_t::individual_t& ind,
 					  ped.individuals() ) {
-	 TRACE("Considering individual " << ind.progr_id());
-	 for (size_t locus= 0; locus < ped.genotype_length(); ++locus) {
-		if ( ! is_genotyped(ind.g(locus)) ) {
-//        Individual not genotyped ->
-//          -> imputing genotype based on variables w_i_l and h_i_l
-		  TRACE("Individual " << ind.progr_id() << " at locus " << locus
-				  << " is not genotyped.");
-// FIXME: Some variables could not exist.
-		  bool hil= cnf.h(ind.progr_id(), locus);
-		  bool wil= cnf.w(ind.progr_id(), locus);
-		  TRACE("hil " << hil << "   wil " << wil);
-		  if ( ! wil) {
-			 DEBUG("Not-genotyped individual " << ind.progr_id() <<
-					 " at locus " << locus << " is imputed as homozygous.");
-			 if ( ! hil ) {
-				ind.g(locus)= family_t::g::HOMO1;
-			 } else {
-				ind.g(locus)= family_t::g::HOMO2;
-			 }
-		  } else {
-			 DEBUG("Not-genotyped individual " << ind.progr_id() <<
-					 " at locus " << locus << " is imputed as heterozygous.");
-			 ind.g(locus)= family_t::g::HETER;
-		  }
-		}
-		if ( is_genotyped(ind.g(locus)) ) {
-		  if ( is_homozigous(ind.g(locus)) ) {
-//          Individual genotyped and homozygous ->
-//            -> haplotype is fixed and predetermined
-			 TRACE("Individual " << ind.progr_id() << " at locus " << locus
-					 << " is genotyped and homozygous.");
-			 ind.hp(locus)= ind.hm(locus)=
-				homozygous_to_haplotype<typename family_t::h, typename family_t::g>(ind.g(locus));
-		  } else {
-//          Individual genotyped and heterozygous ->
-//            -> haplotype depends on variable h_i_l
-			 MY_ASSERT( is_heterozygous(ind.g(locus)) );
-			 TRACE("Individual " << ind.progr_id() << " at locus " << locus
-					 << " is genotyped and heterozygous.");
-			 bool hil= cnf.h(ind.progr_id(), locus);
-			 if ( ! hil) {
-				ind.hp(locus)= family_t::h::ALLELE1;
-				ind.hm(locus)= family_t::h::ALLELE2;
-			 } else {
-				ind.hp(locus)= family_t::h::ALLELE2;
-				ind.hm(locus)= family_t::h::ALLELE1;
-			 }
-		  }
-		} else {
-		  MY_FAIL;
-		}
-	 }
+	 compute_individual_HC_from_SAT<typename family_t::individual_t,
+											  family_t>(ind, cnf, first, last);
   }
-  INFO("Zero-recombinant haplotype configuration successfully computed.");
 };
 
 
+// Task that computes the haplotypes of the i-th individual from a packed
+// model
+template <typename T_FAMILY>
+class individual_HC_task_t {
+private:
+  T_FAMILY& _ped;
+  const packed_model_t& _model;
+
+public:
+  individual_HC_task_t(T_FAMILY& ped, const packed_model_t& model)
+		:_ped(ped), _model(model)
+  {};
+
+  void operator()(const size_t i) {
+	 compute_individual_HC_from_packed_model<typename T_FAMILY::individual_t,
+														  T_FAMILY>(_ped.get_by_progr(i), _model,
+																		_ped.genotype_length());
+  };
+};
+
+
+// Compute the haplotypes of every locus from the model of 'cnf'.
+// The model is first packed (see packed_model_t), then the individuals
+// are processed on 'n_threads' threads (0 means all the available hardware
+// threads).
+template <typename T_GENOTYPE,
+			 typename T_HAPLOTYPE,
+			 typename T_PHENOTYPE,
+			 typename T_ID>
+void compute_ZRHC_from_SAT(basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID>& ped,
+									const pedcnf_t& cnf,
+									const unsigned int n_threads= 0) {
+  log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("pedcnf2hc"));
+  typedef basic_pedigree_t<T_GENOTYPE, T_HAPLOTYPE, T_PHENOTYPE, T_ID> family_t;
+  INFO("Computing the zero-recombinant haplotype configuration...");
+  const packed_model_t model(cnf, ped.size(), ped.genotype_length());
+  individual_HC_task_t<family_t> task(ped, model);
+  parallel_for(ped.size(), task, n_threads);
+  INFO("Zero-recombinant haplotype configuration successfully computed.");
+};
+
 
 #endif // __PEDCNF2HC_HPP__
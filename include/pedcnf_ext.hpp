@@ -63,6 +63,7 @@ private:
   size_t _no_of_xor_clauses;
 #ifndef ONLY_INTERNAL_SAT_SOLVER
   xor_clauses_t _xor_clauses;
+  clause_buffer_t _xor_clause_buffer;
 #endif // ONLY_INTERNAL_SAT_SOLVER
 
 public:
@@ -76,6 +77,9 @@ public:
 
   pedcnf_ext_t()
 		:_no_of_xor_clauses(0)
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+		, _xor_clause_buffer(true)
+#endif // ONLY_INTERNAL_SAT_SOLVER
   {};
 
 // Override functions
@@ -87,12 +91,18 @@ public:
 	 return pedcnf_t::no_of_clauses() + _no_of_xor_clauses;
   };
 
+  virtual size_t no_of_xor_clauses() const {
+	 return _no_of_xor_clauses;
+  };
+
 #ifndef ONLY_INTERNAL_SAT_SOLVER
-  virtual bool is_satisfying_assignment() const;
+  virtual bool is_satisfying_assignment(const unsigned int n_threads= 1) const;
 
   virtual std::ostream& clauses_to_dimacs_format(std::ostream& out,
 																 const std::vector< std::string >& notes) const;
 
+  virtual std::ostream& clauses_to_binary_format(std::ostream& out) const;
+
 // New functions
 
   const xor_clauses_t& xor_clauses() const {
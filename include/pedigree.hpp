@@ -531,15 +531,21 @@ public:
 
 // Check if the haplotypes realize the genotypes
   bool is_zero_recombinant() const {
-	 DEBUG("Checking if the haplotype configuration is zero-recombinant...");
+	 return is_zero_recombinant(0, genotype_length());
+  }
+
+// Check if the haplotypes are zero-recombinant on the loci in [first, last)
+  bool is_zero_recombinant(const size_t first, const size_t last) const {
+	 DEBUG("Checking if the haplotype configuration is zero-recombinant "
+			 "on loci [" << first << ", " << last << ")...");
 	 bool zr= true;
 	 BOOST_FOREACH( const individual_t& ind,
 						 individuals() ) {
 		TRACE("Checking individual " << ind.progr_id());
 		if (ind.has_father()) {
 		  TRACE(" --> father " << ind.father().progr_id());
-		  if (! ( ind.hp().is_compatible_with(ind.father().hp()) ||
-					 ind.hp().is_compatible_with(ind.father().hm()) ) ) {
+		  if (! ( ind.hp().is_compatible_with(ind.father().hp(), first, last) ||
+					 ind.hp().is_compatible_with(ind.father().hm(), first, last) ) ) {
 			 DEBUG("Individual " << ind.progr_id() <<
 					 " has not inherited his paternal haplotype from"
 					 " his father " << ind.father().progr_id());
@@ -549,8 +555,8 @@ public:
 		}
 		if (ind.has_mother()) {
 		  TRACE(" --> mother " << ind.mother().progr_id());
-		  if (! ( ind.hm().is_compatible_with(ind.mother().hp()) ||
-					 ind.hm().is_compatible_with(ind.mother().hm()) ) ) {
+		  if (! ( ind.hm().is_compatible_with(ind.mother().hp(), first, last) ||
+					 ind.hm().is_compatible_with(ind.mother().hm(), first, last) ) ) {
 			 DEBUG("Individual " << ind.progr_id() <<
 					 " has not inherited his maternal haplotype from"
 					 " his mother " << ind.mother().progr_id());
@@ -0,0 +1,230 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * result_cache.hpp
+ *
+ * An on-disk cache of the results (the haplotype configuration or the
+ * verdict that no zero-recombinant haplotype configuration exists) of the
+ * families already solved.
+ *
+ * Each entry is a file of the cache directory whose name is the SHA-1 hash
+ * of the canonical form of the family (the individuals sorted by
+ * identifier, with their parents and genotypes) and of the options that
+ * affect the result.
+ * A haplotype configuration read from the cache is used only if it is
+ * complete, consistent with the genotypes, and zero-recombinant.
+ *
+ **/
+
+#ifndef __RESULT_CACHE_HPP__
+#define __RESULT_CACHE_HPP__
+
+#include "log.hpp"
+#include "utility.hpp"
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+#include <boost/filesystem.hpp>
+
+
+class result_cache_t:
+  public log_able_t< result_cache_t >
+{
+public:
+
+// The version of the format of the entries (entries of other versions are
+// never found, since the version is part of the key)
+  static const unsigned int FORMAT_VERSION;
+
+private:
+
+  const boost::filesystem::path _dir;
+  const std::string _options;
+
+// Compare the individuals of a family by identifier
+  template <typename T_FAMILY>
+  class id_less_t {
+  private:
+	 const T_FAMILY& _family;
+  public:
+	 explicit id_less_t(const T_FAMILY& family)
+		  :_family(family)
+	 {};
+
+	 bool operator()(const size_t p1, const size_t p2) const {
+		return _family.get_by_progr(p1).id() < _family.get_by_progr(p2).id();
+	 };
+  };
+
+// The progressive ids of the individuals sorted by identifier
+  template <typename T_FAMILY>
+  static void canonical_order(const T_FAMILY& family,
+										std::vector<size_t>& order) {
+	 order.clear();
+	 order.reserve(family.size());
+	 for (size_t i= 0; i < family.size(); ++i)
+		order.push_back(i);
+	 std::sort(order.begin(), order.end(), id_less_t<T_FAMILY>(family));
+  };
+
+  template <typename T_FAMILY>
+  static void clear_haplotypes(T_FAMILY& family) {
+	 for (size_t i= 0; i < family.size(); ++i) {
+		typename T_FAMILY::individual_t& ind= family.get_by_progr(i);
+		std::fill(ind.hp().begin(), ind.hp().end(), T_FAMILY::hap_t::base::MISS);
+		std::fill(ind.hm().begin(), ind.hm().end(), T_FAMILY::hap_t::base::MISS);
+	 }
+  };
+
+// Read the entry 'key' (its verdict and the following lines).
+// Return false if the entry does not exist or is malformed.
+  bool read_entry(const std::string& key,
+						bool& is_zrhc,
+						std::vector<std::string>& lines) const;
+
+// Atomically write the entry 'key'
+  void write_entry(const std::string& key,
+						 const std::string& content) const;
+
+  void remove_entry(const std::string& key) const;
+
+public:
+
+// 'options' must describe every option that affects the computed results
+  result_cache_t(const std::string& dir,
+					  const std::string& options);
+
+  const boost::filesystem::path& directory() const {
+	 return _dir;
+  };
+
+// The SHA-1 hash (in hexadecimal notation) of 'text'
+  static std::string hash(const std::string& text);
+
+// The key of a family, that is the hash of its canonical form and of the
+// options of the cache.
+// The key does not depend on the order of the individuals in the pedigree
+// file nor on the family identifier and the phenotypes.
+  template <typename T_FAMILY>
+  std::string key(const T_FAMILY& family) const {
+	 std::vector<size_t> order;
+	 canonical_order(family, order);
+	 std::ostringstream os;
+	 os << "ZRHCstar result cache " << FORMAT_VERSION << "\n" <<
+		_options << "\n" <<
+		family.size() << " " << family.genotype_length() << "\n";
+	 BOOST_FOREACH( const size_t p, order ) {
+		const typename T_FAMILY::individual_t& ind= family.get_by_progr(p);
+		os << ind.id() << " " <<
+		  (ind.has_father() ? tostr(ind.father().id()) : "-") << " " <<
+		  (ind.has_mother() ? tostr(ind.mother().id()) : "-") << " " <<
+		  ind.g() << "\n";
+	 }
+	 return hash(os.str());
+  };
+
+// Look for the result of a family.
+// Return true if the entry 'key' exists and is valid: 'is_zrhc' is set to
+// the verdict and, if a haplotype configuration exists, the haplotypes of
+// 'family' are set to the cached ones.
+// Invalid entries are removed from the cache.
+  template <typename T_FAMILY>
+  bool load(const std::string& key,
+				T_FAMILY& family,
+				bool& is_zrhc) const {
+	 std::vector<std::string> lines;
+	 if (!read_entry(key, is_zrhc, lines)) {
+		L_DEBUG("Entry " << key << " not found in the result cache.");
+		return false;
+	 }
+	 if (!is_zrhc) {
+		L_DEBUG("Entry " << key << " found in the result cache: no "
+				  "zero-recombinant haplotype configuration exists.");
+		return true;
+	 }
+	 std::vector<size_t> order;
+	 canonical_order(family, order);
+	 bool valid= (lines.size() == order.size());
+	 for (size_t i= 0; valid && (i < order.size()); ++i) {
+		typename T_FAMILY::individual_t& ind= family.get_by_progr(order[i]);
+		std::istringstream is(lines[i]);
+		std::string id, hp, hm;
+		valid= (is >> id >> hp >> hm) &&
+		  (id == tostr(ind.id())) &&
+		  (hp.size() == family.genotype_length()) &&
+		  (hm.size() == family.genotype_length());
+		if (valid) {
+		  std::istringstream hp_is(hp);
+		  std::istringstream hm_is(hm);
+		  hp_is >> ind.hp();
+		  hm_is >> ind.hm();
+		}
+	 }
+	 valid= valid &&
+		family.is_completely_haplotyped() &&
+		family.is_consistent() &&
+		family.is_zero_recombinant();
+	 if (!valid) {
+		L_WARN("Entry " << key << " of the result cache is not a valid "
+				 "zero-recombinant haplotype configuration of the family. "
+				 "Removing it...");
+		clear_haplotypes(family);
+		remove_entry(key);
+		return false;
+	 }
+	 L_DEBUG("Entry " << key << " found in the result cache: the cached "
+				"haplotype configuration is valid.");
+	 return true;
+  };
+
+// Store the result of a family (its haplotypes, if 'is_zrhc' is true)
+  template <typename T_FAMILY>
+  void store(const std::string& key,
+				 const T_FAMILY& family,
+				 const bool is_zrhc) const {
+	 std::ostringstream os;
+	 os << (is_zrhc ? "ZRHC" : "NO_ZRHC") << "\n";
+	 if (is_zrhc) {
+		std::vector<size_t> order;
+		canonical_order(family, order);
+		BOOST_FOREACH( const size_t p, order ) {
+		  const typename T_FAMILY::individual_t& ind= family.get_by_progr(p);
+		  os << ind.id() << " " << ind.hp() << " " << ind.hm() << "\n";
+		}
+	 }
+	 write_entry(key, os.str());
+	 L_DEBUG("Entry " << key << " stored in the result cache.");
+  };
+
+};
+
+#endif // __RESULT_CACHE_HPP__
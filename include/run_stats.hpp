@@ -0,0 +1,182 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * run_stats.hpp
+ *
+ * Collection of the running times, the memory usage and the size of the
+ * SAT instances of a run of the program.
+ *
+ **/
+
+#ifndef __RUN_STATS_HPP__
+#define __RUN_STATS_HPP__
+
+#include "log.hpp"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+
+
+// The statistics of a run: the wall-clock and CPU time spent in each phase
+// (such as parsing, encoding, solving, ...) and some named counters
+// (such as the number of variables and clauses of the SAT instance).
+// Phases and counters are reported in the order they are first recorded.
+// The statistics can be recorded from several threads.
+class run_stats_t:
+  public log_able_t<run_stats_t>,
+  boost::noncopyable
+{
+public:
+
+  class phase_t {
+  public:
+	 std::string name;
+	 size_t calls;
+	 double wall_time;
+	 double cpu_time;
+
+	 explicit phase_t(const std::string& name_)
+		  :name(name_), calls(0), wall_time(0.0), cpu_time(0.0)
+	 {};
+  };
+
+  typedef std::vector<phase_t> phases_t;
+  typedef std::vector< std::pair<std::string, long long> > counters_t;
+  typedef std::vector< std::pair<std::string, std::string> > infos_t;
+
+private:
+
+  mutable boost::mutex _mutex;
+  const double _wall_start;
+  const double _cpu_start;
+  phases_t _phases;
+  counters_t _counters;
+  infos_t _infos;
+
+  run_stats_t();
+
+public:
+
+  static run_stats_t&
+  get_run_stats() {
+	 static run_stats_t rs;
+	 return rs;
+  };
+
+// Seconds elapsed since an arbitrary (but fixed) point in time
+  static double wall_time();
+
+// User and system CPU time (in seconds) used by the whole process
+  static double cpu_time();
+
+// CPU time (in seconds) used by the calling thread
+  static double thread_cpu_time();
+
+// Maximum resident set size (in kilobytes) of the process so far
+  static long peak_rss_kb();
+
+// Current resident set size (in kilobytes) of the process (the peak one if
+// the current one is not available)
+  static long current_rss_kb();
+
+  void add_phase_time(const std::string& name,
+							 const double wall_time,
+							 const double cpu_time);
+
+  void set_counter(const std::string& name, const long long value);
+
+  void add_to_counter(const std::string& name, const long long value);
+
+  void set_info(const std::string& name, const std::string& value);
+
+  phases_t phases() const;
+
+  counters_t counters() const;
+
+// The value of the counter 'name' (0 if it has not been recorded)
+  long long counter(const std::string& name) const;
+
+// Forget every phase, counter, and info recorded so far
+  void clear();
+
+// Write the statistics as a JSON object.
+// The overall wall-clock time, CPU time and peak RSS are taken at the
+// moment of the call.
+  std::ostream& write_json(std::ostream& out) const;
+
+};
+
+
+// Record the wall-clock and CPU time elapsed between its construction and
+// its destruction (or the call to 'stop') as a phase of the run statistics.
+// The CPU time is the one of the thread that runs the phase, thus the
+// phases that run concurrently on other threads are not charged to it
+// (but neither are the worker threads started by the phase, which can
+// record their own phases).
+class phase_timer_t:
+  boost::noncopyable
+{
+private:
+
+  const std::string _name;
+  const double _wall_start;
+  const double _cpu_start;
+  bool _running;
+
+public:
+
+  explicit phase_timer_t(const std::string& name)
+		:_name(name),
+		 _wall_start(run_stats_t::wall_time()),
+		 _cpu_start(run_stats_t::thread_cpu_time()),
+		 _running(true)
+  {};
+
+  ~phase_timer_t() {
+	 stop();
+  };
+
+  void stop() {
+	 if (_running) {
+		_running= false;
+		run_stats_t::get_run_stats().
+		  add_phase_time(_name,
+							  run_stats_t::wall_time() - _wall_start,
+							  run_stats_t::thread_cpu_time() - _cpu_start);
+	 }
+  };
+
+};
+
+
+#endif // __RUN_STATS_HPP__
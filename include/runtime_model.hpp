@@ -0,0 +1,111 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * runtime_model.hpp
+ *
+ * A model of the time needed to encode and solve a SAT instance, fitted
+ * on the statistics of previous runs.
+ *
+ **/
+
+#ifndef __RUNTIME_MODEL_HPP__
+#define __RUNTIME_MODEL_HPP__
+
+#include "log.hpp"
+#include "instance_estimate.hpp"
+
+#include <iostream>
+#include <vector>
+
+
+// The size of the SAT instance of a previous run and the (wall-clock)
+// seconds spent to encode and solve it
+class recorded_run_t {
+public:
+  double variables;
+  double clauses;
+  double xor_clauses;
+  double seconds;
+
+  recorded_run_t()
+		:variables(0.0), clauses(0.0), xor_clauses(0.0), seconds(0.0)
+  {};
+};
+
+// Read a run from the statistics saved by 'run_stats_t::write_json'.
+// It returns false if the run has not encoded and solved a SAT instance,
+// or if it has not decided the instance (e.g. the solver has been
+// interrupted or the run has failed).
+bool
+read_recorded_run(std::istream& in, recorded_run_t& run);
+
+
+// A linear model of the running time of the form
+//   seconds = c_0 + c_1 * variables + c_2 * clauses + c_3 * xor_clauses
+// fitted (by least squares) on a set of recorded runs
+class runtime_model_t:
+  public log_able_t<runtime_model_t>
+{
+public:
+
+  static const size_t NO_OF_COEFFICIENTS= 4;
+
+private:
+
+  std::vector<double> _c;
+  size_t _runs;
+
+public:
+
+  runtime_model_t()
+		:_c(NO_OF_COEFFICIENTS, 0.0), _runs(0)
+  {};
+
+// Fit the model on the given runs.
+// The coefficients of the features that cannot be determined by the runs
+// (e.g. the xor-clauses if no run used them) are set to 0.
+  void fit(const std::vector<recorded_run_t>& runs);
+
+  double predict(const instance_estimate_t& instance) const;
+
+  const std::vector<double>& coefficients() const {
+	 return _c;
+  };
+
+  size_t no_of_runs() const {
+	 return _runs;
+  };
+
+  void save(std::ostream& out) const;
+
+  void load(std::istream& in);
+
+};
+
+
+#endif // __RUNTIME_MODEL_HPP__
@@ -0,0 +1,142 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * sat_result_reader.hpp
+ *
+ * A streaming reader of the results of SAT solvers, either in the MiniSat
+ * format:
+ * SAT (or UNSAT, or INDET)
+ * 1 -2 3 4 0
+ *
+ * or in the format of the SAT competitions:
+ * c comment
+ * s SATISFIABLE (or s UNSATISFIABLE, or s UNKNOWN)
+ * v 1 -2 3
+ * v 4 0
+ *
+ * The input is read in large chunks and the literals are parsed by a
+ * hand-written scanner directly into the table of values, so that the
+ * (possibly huge) assignment lines are never buffered as a whole.
+ * A bitmap records the assigned variables, in order to detect conflicting
+ * and missing values.
+ * A malformed result raises a std::logic_error.
+ *
+ **/
+
+#ifndef __SAT_RESULT_READER_HPP__
+#define __SAT_RESULT_READER_HPP__
+
+#include "log.hpp"
+
+#include <string>
+#include <vector>
+#include <istream>
+
+
+class sat_result_reader_t:
+  public log_able_t< sat_result_reader_t >
+{
+public:
+
+  static const size_t DEFAULT_BUFFER_SIZE= 1 << 20;
+
+private:
+
+  std::istream& _in;
+  std::vector<char> _buffer;
+  size_t _pos;
+  size_t _end;
+  bool _eof;
+
+  size_t _no_of_assigned;
+
+// Make sure that the current character is in the buffer.
+// Return false at the end of the input.
+  bool fill() {
+	 if (_pos < _end)
+		return true;
+	 if (_eof)
+		return false;
+	 _end= (size_t)_in.rdbuf()->sgetn(&_buffer[0], _buffer.size());
+	 _pos= 0;
+	 _eof= (_end == 0);
+	 return !_eof;
+  };
+
+// The current character (-1 at the end of the input)
+  int peek() {
+	 return fill() ? (unsigned char)_buffer[_pos] : -1;
+  };
+
+  void advance() {
+	 ++_pos;
+  };
+
+  static bool is_blank(const int c) {
+	 return (c == ' ') || (c == '\t') || (c == '\r');
+  };
+
+  void skip_blanks() {
+	 while (is_blank(peek()))
+		advance();
+  };
+
+// Skip the current line, including the newline
+  void skip_line();
+
+// Read a word (up to a blank or the end of the line)
+  void read_word(std::string& word);
+
+  static void malformed(const std::string& why);
+
+// Read the literals of the current line into 'vals' (the line must contain
+// only integers).
+// Return true if the literal 0 (the end of the assignment) has been read.
+  bool read_literals(std::vector<bool>& vals,
+							std::vector<bool>& assigned);
+
+public:
+
+  explicit sat_result_reader_t(std::istream& in,
+										 const size_t buffer_size= DEFAULT_BUFFER_SIZE);
+
+// Read the result and set the values of the assigned variables in 'vals'
+// (variable i is at position i-1).  The variables that are not assigned by
+// the result are false.
+// Return true if the clauses are satisfiable.  'decided' is false if the
+// result does not state whether the clauses are satisfiable or not.
+  bool read(std::vector<bool>& vals, bool& decided);
+
+// The number of variables assigned by the last call of 'read'
+  size_t no_of_assigned() const {
+	 return _no_of_assigned;
+  };
+
+};
+
+#endif // __SAT_RESULT_READER_HPP__
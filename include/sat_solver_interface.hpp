@@ -72,24 +72,108 @@
 #include "utility.hpp"
 
 #include <set>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <boost/function.hpp>
 
 #include "Solver.h"
 
 
+// The search statistics of the internal SAT solver
+class SAT_solver_stats_t {
+public:
+  uint64_t conflicts;
+  uint64_t decisions;
+  uint64_t propagations;
+  uint64_t restarts;
+  uint64_t clause_db_reductions;
+  uint64_t gauss_calls;
+  uint64_t gauss_conflicts;
+  uint64_t gauss_propagations;
+  uint64_t gauss_unit_truths;
+  uint64_t eliminated_vars;
+  uint64_t xor_eliminated_vars;
+  uint64_t replaced_vars;
+  double subsumer_time;
+  double xor_subsumer_time;
+
+  SAT_solver_stats_t();
+
+// Add the statistics to the counters of the run statistics (prefixed by
+// 'solver_')
+  void add_to_run_stats() const;
+
+};
+
+SAT_solver_stats_t
+operator-(const SAT_solver_stats_t& s1, const SAT_solver_stats_t& s2);
+
+
+// The progress of a running solve
+class SAT_solver_progress_t {
+public:
+  double elapsed_time;
+  uint64_t conflicts;
+  double conflicts_per_second;
+  uint64_t restarts;
+  size_t clauses;
+  size_t learnts;
+  std::string restart_type;
+
+  SAT_solver_progress_t()
+		:elapsed_time(0.0), conflicts(0), conflicts_per_second(0.0),
+		 restarts(0), clauses(0), learnts(0)
+  {};
+};
+
+std::ostream&
+operator<<(std::ostream& out, const SAT_solver_progress_t& progress);
+
+std::ostream&
+operator<<(std::ostream& out, const SAT_solver_stats_t& stats);
+
+
 class SAT_solver_iface_t
   :
   public log_able_t<SAT_solver_iface_t>
 {
+public:
+
+  typedef boost::function<void (const SAT_solver_progress_t&)> progress_callback_t;
+
 private:
   Solver* _solver;
 
   bool _solved;
   bool _sat;
+  bool _incremental;
+  bool _interrupted;
+
+// The statistics already added to the run statistics
+  SAT_solver_stats_t _reported;
+  double _solve_start;
+  double _last_progress;
+
+  static double _progress_interval;
+  static progress_callback_t _progress_callback;
+  static std::string _cancel_file;
+  static bool _handle_signals;
+
+// The budgets of every solve (0 means no limit)
+  static uint64_t _max_conflicts;
+  static double _timeout;
+  static long _max_memory_kb;
+
+// Add the statistics of the last solve to the run statistics
+  void report_statistics();
+
+// Run the solver under the budgets and record if it has been interrupted
+  lbool run_solver(const vec<Lit>& assumps);
 
 public:
-  SAT_solver_iface_t()
-		:_solver(new Solver()), _solved(false), _sat(false)
-  {};
+  SAT_solver_iface_t();
 
   ~SAT_solver_iface_t() {
 	 delete _solver;
@@ -99,18 +183,128 @@ public:
 	 return _solved;
   };
 
+// In incremental mode, clauses can be added also after the instance has
+// been solved (the solver keeps its learnt clauses and the instance has
+// to be solved again).
+  void set_incremental(const bool incremental) {
+	 _incremental= incremental;
+  };
+
+  bool is_incremental() const {
+	 return _incremental;
+  };
+
+// Check if the last solve has been interrupted (since a budget has been
+// exhausted or an interruption has been requested) before deciding if the
+// instance is satisfiable.
+// An interrupted solve returns false, but the instance is not known to be
+// unsatisfiable.
+  bool is_interrupted() const {
+	 return _solved && _interrupted;
+  };
+
   void add_clause(const std::set<int>& clause);
 
   void add_xor_clause(const std::set<int>& clause);
 
+// Create the variables up to variable 'n_vars' (variables start from 1)
+  void reserve_vars(const size_t n_vars);
+
+// Add a clause (or a xor-clause) given as an array of 'n' literals of
+// existing variables (see 'reserve_vars')
+  void add_clause(const int* lits, const size_t n);
+
+  void add_xor_clause(const int* lits, const size_t n);
+
   bool solve();
 
+// Solve the instance under the given assumptions (positive or negative
+// variables, starting from 1).
+// The simplifications that could eliminate the assumed variables are
+// disabled, thus only assumptions should be used on an instance.
+  bool solve(const std::vector<int>& assumptions);
+
+// The assumptions that made the last solve unsatisfiable (negated)
+  void conflict(std::vector<int>& lits) const;
+
   bool model(const unsigned int var) const;
 
+// Copy the whole model into 'vals' (vals[var] is the value of variable
+// var+1).  Variables left unassigned by the solver are false.
+  void model(std::vector<bool>& vals) const;
+
   size_t no_of_vars() const {
 	 return _solver->nVars();
   };
 
+// Make the solver prefer the given values (vals[var] is the preferred
+// value of variable var+1) when it branches, also in the following solves
+// (the phases saved during the search are kept between solves).
+  void set_polarities(const std::vector<bool>& vals);
+
+// The learnt clauses (including the unit ones) of at most 'max_size'
+// literals
+  void learnt_clauses(std::vector< std::vector<int> >& clauses,
+							 const size_t max_size) const;
+
+// Add a clause that is implied by the clauses of the instance.
+// It must be called before the first solve.
+  void add_learnt_clause(const std::vector<int>& clause);
+
+  SAT_solver_stats_t statistics() const;
+
+  SAT_solver_progress_t progress() const;
+
+// Stop the solve if an interruption has been requested, and report the
+// progress if at least 'progress_interval' seconds have passed since it
+// has been reported the last time.
+// It is called by the solver at each restart.
+  void report_progress();
+
+// Set the budgets of every solve: the maximum number of conflicts and the
+// maximum number of seconds of each solve, and the maximum (current)
+// resident set size (in megabytes) of the whole process while a solve
+// runs.  0 means no limit.
+// Time and memory are checked by a single watchdog thread shared by the
+// running solves.
+// Whether a solve has been interrupted is given by 'is_interrupted'.
+  static void set_budgets(const uint64_t max_conflicts,
+								  const double timeout,
+								  const size_t max_memory_mb);
+
+// Set the number of seconds between two progress reports of every solver
+// (0 disables the reports)
+  static void set_progress_interval(const double progress_interval) {
+	 _progress_interval= progress_interval;
+  };
+
+// Set the function that receives the progress reports (by default, they
+// are logged).
+// The function is called by the thread that runs the solver.
+  static void set_progress_callback(const progress_callback_t& progress_callback) {
+	 _progress_callback= progress_callback;
+  };
+
+// Ask every running (and future) solve to stop as soon as possible.
+// It is async-signal-safe.
+  static void request_interrupt();
+
+  static bool is_interrupt_requested();
+
+// Forget the interruption requested so far
+  static void clear_interrupt_request();
+
+// Interrupt every solve as soon as the given file exists
+// (an empty name disables the check)
+  static void set_cancel_file(const std::string& cancel_file) {
+	 _cancel_file= cancel_file;
+  };
+
+// Request an interruption on SIGINT and SIGTERM (a second signal
+// terminates the program)
+  static void handle_signals();
+
+
 };
 
 #endif
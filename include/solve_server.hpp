@@ -0,0 +1,415 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * solve_server.hpp
+ *
+ * A long-running service that solves the pedigrees received on a stream
+ * (such as the standard input or the connections to a Unix domain socket).
+ *
+ **/
+
+#ifndef __SOLVE_SERVER_HPP__
+#define __SOLVE_SERVER_HPP__
+
+#include "configuration.h"
+
+#ifdef INTERNAL_SAT_SOLVER
+
+#include "zrhc_app.hpp"
+#include "parallel.hpp"
+#include "utility.hpp"
+#include "run_stats.hpp"
+#include "log.hpp"
+
+#include <set>
+#include <deque>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/ref.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+
+// The server reads a sequence of requests, each composed by a header line
+// and by a payload of the given number of bytes:
+//
+//   SOLVE <id> <length>\n<pedigree in PLINK format>
+//   QUIT\n
+//
+// and writes a response for each SOLVE request as soon as it has been
+// solved (thus not necessarily in the order of the requests):
+//
+//   <id> <status> <length>\n<payload>
+//
+// where <status> is 'ZRHC' (and the payload is the haplotype
+// configuration), 'NO_ZRHC', 'UNDEF' (if the SAT solver has been
+// interrupted), or 'ERROR' (and the payload is an error message).
+// The ids are chosen by the client and must not contain blanks.
+// A malformed request gets an 'ERROR' response with id '-' and closes
+// the session (after the responses to the previous requests), while a
+// request whose length is not a number or exceeds the maximum request size
+// gets an 'ERROR' response (and its payload, if any, is skipped).
+// The requests of every session are solved by the same pool of threads.
+// At most a few requests per thread are queued: the sessions stop reading
+// new requests until the queue has room.
+// The responses are written by a thread of the session, thus a client that
+// reads them only after sending all its requests does not stop the solving
+// threads (the unread responses are kept in memory).
+// At most 'max_connections' connections to the socket are served at the
+// same time, the others wait to be accepted.
+class solve_server_t:
+  public log_able_t<solve_server_t>,
+  boost::noncopyable
+{
+private:
+
+// The responses of a session are queued by the thread that has solved
+// the request and written by the writer of the session
+  class session_t:
+	 boost::noncopyable
+  {
+  public:
+	 std::ostream& out;
+	 boost::mutex mutex;
+	 boost::condition_variable cond;
+	 size_t pending;
+	 std::deque<std::string> responses;
+	 bool closed;
+
+	 explicit session_t(std::ostream& out_)
+		  :out(out_), pending(0), closed(false)
+	 {};
+
+// Write the queued responses until the session is closed and the queue is
+// empty
+	 void write_responses() {
+		boost::mutex::scoped_lock lock(mutex);
+		while (true) {
+		  while (responses.empty() && !closed)
+			 cond.wait(lock);
+		  if (responses.empty())
+			 return;
+		  std::string response;
+		  response.swap(responses.front());
+		  responses.pop_front();
+		  lock.unlock();
+		  out << response;
+		  out.flush();
+		  lock.lock();
+		}
+	 };
+  };
+
+  const zrhcstar_t& _zrhcstar;
+  thread_pool_t _pool;
+  const size_t _max_request_size;
+  const size_t _max_connections;
+
+// The requests submitted to the pool and not yet answered
+  boost::mutex _queue_mutex;
+  boost::condition_variable _queue_cond;
+  size_t _queued;
+  const size_t _max_queued;
+
+// The connections to the socket that are being served
+  boost::mutex _connections_mutex;
+  boost::condition_variable _connections_cond;
+  std::set<int> _connections;
+
+// Parse the length of a request, that is a decimal number without sign
+  static bool parse_length(const std::string& str, size_t& length) {
+	 if (str.empty())
+		return false;
+	 length= 0;
+	 BOOST_FOREACH( const char c, str ) {
+		if ((c < '0') || (c > '9'))
+		  return false;
+		const size_t digit= c - '0';
+		if (length > (std::numeric_limits<size_t>::max() - digit) / 10)
+		  return false;
+		length= length * 10 + digit;
+	 }
+	 return true;
+  };
+
+// Skip 'length' bytes of the stream
+  static void skip(std::istream& in, size_t length) {
+	 const size_t chunk= std::numeric_limits<std::streamsize>::max();
+	 while ((length > 0) && in) {
+		const size_t n= std::min(length, chunk);
+		in.ignore((std::streamsize)n);
+		length-= n;
+	 }
+  };
+
+  static void respond(session_t& session,
+							 const std::string& id,
+							 const std::string& status,
+							 const std::string& payload) {
+	 std::ostringstream response;
+	 response << id << " " << status << " " << payload.size() << "\n" <<
+		payload;
+	 boost::mutex::scoped_lock lock(session.mutex);
+	 session.responses.push_back(response.str());
+	 session.cond.notify_all();
+  };
+
+  void solve_request(session_t& session,
+							const std::string& id,
+							const std::string& pedigree) {
+	 const double start= run_stats_t::wall_time();
+	 std::string status;
+	 std::string payload;
+	 try {
+		zrhcstar_t::pedigree_t ped;
+		std::istringstream ped_is(pedigree);
+		status= _zrhcstar.solve_pedigree(ped_is, ped, payload);
+		if (status == "ZRHC") {
+		  std::ostringstream hap_os;
+		  _zrhcstar.save_ZRHC(ped, hap_os);
+		  payload= hap_os.str();
+		}
+	 } catch (std::exception& e) {
+		status= "ERROR";
+		payload= e.what();
+	 } catch (assertion_failed_exception& e) {
+		status= "ERROR";
+		payload= e.what();
+	 }
+	 L_DEBUG("Request '" << id << "': " << status << " (" <<
+				(run_stats_t::wall_time() - start) << "s).");
+	 run_stats_t::get_run_stats().add_to_counter("server_" + status, 1);
+	 respond(session, id, status, payload);
+	 {
+		boost::mutex::scoped_lock lock(_queue_mutex);
+		--_queued;
+	 }
+	 _queue_cond.notify_one();
+// The session can be destroyed as soon as the lock is released
+	 boost::mutex::scoped_lock lock(session.mutex);
+	 --session.pending;
+	 session.cond.notify_all();
+  };
+
+  void serve_connection(const int fd) {
+	 L_DEBUG("Serving connection " << fd << "...");
+	 try {
+		namespace io= boost::iostreams;
+		io::stream<io::file_descriptor_source> in(fd, io::never_close_handle);
+		io::stream<io::file_descriptor_sink> out(fd, io::never_close_handle);
+		serve(in, out);
+	 } catch (std::exception& e) {
+		L_ERROR("Connection " << fd << " failed: " << e.what());
+	 }
+	 L_DEBUG("Closing connection " << fd << "...");
+// The server can be destroyed as soon as the lock is released
+	 boost::mutex::scoped_lock lock(_connections_mutex);
+	 _connections.erase(fd);
+	 ::close(fd);
+	 _connections_cond.notify_all();
+  };
+
+public:
+
+  static const size_t DEFAULT_MAX_REQUEST_SIZE= 64*1024*1024;
+  static const size_t DEFAULT_MAX_CONNECTIONS= 64;
+
+// 'max_request_size' is the maximum length (in bytes) of the pedigree of a
+// request
+  solve_server_t(const zrhcstar_t& zrhcstar,
+					  const unsigned int n_threads,
+					  const size_t max_request_size= DEFAULT_MAX_REQUEST_SIZE,
+					  const size_t max_connections= DEFAULT_MAX_CONNECTIONS)
+		:_zrhcstar(zrhcstar), _pool(n_threads),
+		 _max_request_size(max_request_size),
+		 _max_connections(std::max(max_connections, (size_t)1)),
+		 _queued(0), _max_queued(4 * _pool.size())
+  {};
+
+// Serve the requests read from 'in' until the end of the stream, a 'QUIT'
+// request, or an interruption (see 'SAT_solver_iface_t::request_interrupt'),
+// and wait for their responses.
+// It returns the number of SOLVE requests.
+  size_t serve(std::istream& in, std::ostream& out) {
+	 session_t session(out);
+	 boost::thread writer(boost::bind(&session_t::write_responses,
+												 boost::ref(session)));
+	 size_t n_requests= 0;
+	 std::string line;
+	 while (!SAT_solver_iface_t::is_interrupt_requested() &&
+			  std::getline(in, line)) {
+		boost::trim(line);
+		if (line.empty())
+		  continue;
+		std::istringstream header(line);
+		std::string command, id, length_str;
+		size_t length= 0;
+		header >> command;
+		if (command == "QUIT")
+		  break;
+		if ((command != "SOLVE") || !(header >> id >> length_str)) {
+		  L_WARN("Malformed request '" << line << "'.");
+		  respond(session, "-", "ERROR", "malformed request '" + line + "'");
+		  break;
+		}
+		if (!parse_length(length_str, length)) {
+		  L_WARN("Invalid length of request '" << id << "'.");
+		  respond(session, id, "ERROR", "invalid length '" + length_str + "'");
+		  continue;
+		}
+		if (length > _max_request_size) {
+		  L_WARN("Request '" << id << "' is too large (" << length << " bytes).");
+		  skip(in, length);
+		  respond(session, id, "ERROR",
+					 "request too large (at most " + tostr(_max_request_size) +
+					 " bytes)");
+		  continue;
+		}
+		std::string pedigree(length, '\0');
+		if ((length > 0) && !in.read(&pedigree[0], length)) {
+		  L_WARN("Truncated request '" << id << "'.");
+		  respond(session, id, "ERROR", "truncated pedigree");
+		  break;
+		}
+		{
+		  boost::mutex::scoped_lock lock(_queue_mutex);
+		  while (_queued >= _max_queued)
+			 _queue_cond.wait(lock);
+		  ++_queued;
+		}
+		{
+		  boost::mutex::scoped_lock lock(session.mutex);
+		  ++session.pending;
+		}
+		_pool.submit(boost::bind(&solve_server_t::solve_request, this,
+										 boost::ref(session), id, pedigree));
+		++n_requests;
+	 }
+	 {
+		boost::mutex::scoped_lock lock(session.mutex);
+		while (session.pending > 0)
+		  session.cond.wait(lock);
+		session.closed= true;
+		session.cond.notify_all();
+	 }
+	 writer.join();
+	 return n_requests;
+  };
+
+// Serve the connections to the Unix domain socket 'path' (each one as a
+// session) until an interruption is requested.
+// A stale socket file is replaced, while any other file is an error.
+  void serve_socket(const std::string& path) {
+	 sockaddr_un addr;
+	 if (path.size() >= sizeof(addr.sun_path))
+		throw std::logic_error(std::string("Socket name '") + path +
+									  "' is too long.");
+	 struct stat st;
+	 if (::lstat(path.c_str(), &st) == 0) {
+		if (!S_ISSOCK(st.st_mode))
+		  throw std::logic_error(std::string("File '") + path +
+										 "' exists and it is not a socket.");
+		::unlink(path.c_str());
+	 }
+	 const int sfd= ::socket(AF_UNIX, SOCK_STREAM, 0);
+	 if (sfd < 0)
+		throw std::logic_error("Impossible to create a socket.");
+	 memset(&addr, 0, sizeof(addr));
+	 addr.sun_family= AF_UNIX;
+	 strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	 if ((::bind(sfd, (sockaddr*)&addr, sizeof(addr)) != 0) ||
+		  (::listen(sfd, SOMAXCONN) != 0)) {
+		::close(sfd);
+		throw std::logic_error(std::string("Impossible to listen on socket '") +
+									  path + "'.");
+	 }
+// A client that disconnects before its responses must not kill the server
+	 ::signal(SIGPIPE, SIG_IGN);
+	 L_INFO("Listening on socket '" << path << "' with " << _pool.size() <<
+			  " solving threads...");
+	 while (!SAT_solver_iface_t::is_interrupt_requested()) {
+		{
+		  boost::mutex::scoped_lock lock(_connections_mutex);
+		  if (_connections.size() >= _max_connections) {
+			 _connections_cond.timed_wait(lock,
+													boost::posix_time::milliseconds(200));
+			 continue;
+		  }
+		}
+		pollfd pfd;
+		pfd.fd= sfd;
+		pfd.events= POLLIN;
+		pfd.revents= 0;
+		if (::poll(&pfd, 1, 200) <= 0)
+		  continue;
+		const int cfd= ::accept(sfd, NULL, NULL);
+		if (cfd < 0)
+		  continue;
+		{
+		  boost::mutex::scoped_lock lock(_connections_mutex);
+		  _connections.insert(cfd);
+		}
+		boost::thread session(boost::bind(&solve_server_t::serve_connection,
+													 this, cfd));
+		session.detach();
+	 }
+	 L_INFO("Stopping the server...");
+	 ::close(sfd);
+	 ::unlink(path.c_str());
+// Stop reading new requests (the pending ones are still answered)
+	 boost::mutex::scoped_lock lock(_connections_mutex);
+	 BOOST_FOREACH( const int cfd, _connections ) {
+		::shutdown(cfd, SHUT_RD);
+	 }
+	 while (!_connections.empty())
+		_connections_cond.wait(lock);
+  };
+
+};
+
+#endif // INTERNAL_SAT_SOLVER
+
+#endif // __SOLVE_SERVER_HPP__
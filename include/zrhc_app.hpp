@@ -24,6 +24,9 @@
  * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
  *
  **/
+#ifndef __ZRHC_APP_HPP__
+#define __ZRHC_APP_HPP__
+
 #include "configuration.h"
 
 #include "application.hpp"
@@ -35,8 +38,30 @@
 #include "io-pedigree.hpp"
 #include "ped2cnf.hpp"
 #include "pedcnf2hc.hpp"
+#include "locus_windows.hpp"
+#include "locus_dedup.hpp"
+#include "mendelian_check.hpp"
+#include "hc_verification.hpp"
+#include "parallel.hpp"
+#include "run_stats.hpp"
+#include "instance_estimate.hpp"
+#include "instance_predictor.hpp"
+#include "runtime_model.hpp"
+#include "result_cache.hpp"
+#include "incremental_solver.hpp"
+#include "binary_instance.hpp"
+#include "dimacs_reader.hpp"
 
 #include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/thread.hpp>
 
 using namespace std;
 
@@ -53,13 +78,17 @@ public:
 private:
 
   const bool _extended;
+  const bool _break_symmetries;
+  const bool _s_vars_first;
+  const bool _dedup_loci;
+  const result_cache_t* _cache;
 
 public:
 
-  void prepare_pedigree_and_sat(std::istream& ped_is,
-										  pedigree_t& mped,
-										  pedcnf_t*& cnf) const {
+  void read_pedigree(std::istream& ped_is,
+							pedigree_t& mped) const {
 	 L_INFO("Reading pedigree...");
+	 phase_timer_t timer("parsing");
 	 biallelic_genotype_reader_t<> gr;
 	 plink_reader_t<> reader(gr);
 	 reader.read(ped_is, mped);
@@ -73,28 +102,181 @@ public:
 	 }
 
 	 mped.print_stats();
+  }
+
+// Report the Mendelian errors of the pedigree (if any).
+// If the pedigree has Mendelian errors, no haplotype configuration exists
+// and the pedigree does not need to be encoded.
+  bool is_mendelian_consistent(const pedigree_t& mped) const {
+	 L_INFO("Checking Mendelian consistency...");
+	 phase_timer_t timer("mendelian_check");
+	 const family_t& family= mped.families().front();
+	 std::vector< std::pair<size_t, size_t> > errors;
+	 const bool ok= check_mendelian_consistency(family, errors);
+	 if (ok) {
+		L_INFO("The pedigree is Mendelian-consistent.");
+	 } else {
+		typedef std::pair<size_t, size_t> error_t;
+		BOOST_FOREACH( const error_t& error, errors ) {
+		  L_ERROR("Mendelian error in individual " <<
+					 family.get_by_progr(error.first).id() <<
+					 " at locus " << error.second << ".");
+		}
+		L_ERROR("The pedigree has " << errors.size() << " Mendelian errors.");
+	 }
+	 return ok;
+  }
+
+// Add the size of the SAT instance to the run statistics
+  static void record_instance_size(const pedcnf_t& cnf) {
+	 run_stats_t& rs= run_stats_t::get_run_stats();
+	 rs.add_to_counter("variables", cnf.vars().size());
+	 rs.add_to_counter("clauses", cnf.no_of_clauses() - cnf.no_of_xor_clauses());
+	 rs.add_to_counter("xor_clauses", cnf.no_of_xor_clauses());
+	 rs.add_to_counter("dummy_variables", cnf.dummy().size());
+  };
+
+// Encode the loci [first, last) of a family
+  pedcnf_t* encode(const family_t& family,
+						 const size_t first, const size_t last) const {
+	 if (!_extended) {
+		ped2cnf_conv_t<family_t::gen_t, family_t::hap_t,
+							family_t::phen_t, family_t::id_t,
+							pedcnf_t> conv(_break_symmetries, _s_vars_first);
+		return conv.convert(family, first, last);
+	 } else {
+		ped2cnf_conv_t<family_t::gen_t, family_t::hap_t,
+							family_t::phen_t, family_t::id_t,
+							pedcnf_ext_t> conv(_break_symmetries, _s_vars_first);
+		return conv.convert(family, first, last);
+	 }
+  }
+
+// Encode only one locus for each class of equivalent loci
+  pedcnf_t* encode_deduplicated(const family_t& family) const {
+	 std::vector<size_t> locus_rep;
+	 std::vector<size_t> encoded_loci;
+	 compute_locus_representatives(family, locus_rep, encoded_loci);
+	 pedcnf_t* cnf;
+	 if (!_extended) {
+		ped2cnf_conv_t<family_t::gen_t, family_t::hap_t,
+							family_t::phen_t, family_t::id_t,
+							pedcnf_t> conv(_break_symmetries, _s_vars_first);
+		cnf= conv.convert(family, encoded_loci);
+	 } else {
+		ped2cnf_conv_t<family_t::gen_t, family_t::hap_t,
+							family_t::phen_t, family_t::id_t,
+							pedcnf_ext_t> conv(_break_symmetries, _s_vars_first);
+		cnf= conv.convert(family, encoded_loci);
+	 }
+	 cnf->set_locus_representatives(locus_rep);
+	 return cnf;
+  }
+
+  void prepare_pedigree_and_sat(std::istream& ped_is,
+										  pedigree_t& mped,
+										  pedcnf_t*& cnf) const {
+	 read_pedigree(ped_is, mped);
+	 prepare_sat(mped, cnf);
+  }
 
+  void prepare_sat(const pedigree_t& mped,
+						 pedcnf_t*& cnf) const {
 // Prepare the SAT instance
 	 L_INFO("Preparing SAT instance from pedigree...");
-	 if (!_extended) {
-		cnf= ped2cnf(mped.families().front());
+	 phase_timer_t timer("encoding");
+	 const family_t& family= mped.families().front();
+	 if (_dedup_loci) {
+		cnf= encode_deduplicated(family);
 	 } else {
-		cnf= ped2cnf_ext(mped.families().front());
+		cnf= encode(family, 0, family.genotype_length());
 	 }
+	 record_instance_size(*cnf);
 	 L_INFO("SAT instance successfully prepared.");
   }
 
+// Compute the size of the SAT instance that 'prepare_sat' would build,
+// without encoding the pedigree
+  instance_estimate_t predict_sat(const pedigree_t& mped) const {
+	 L_INFO("Predicting the size of the SAT instance...");
+	 phase_timer_t timer("prediction");
+	 const family_t& family= mped.families().front();
+	 std::vector<size_t> loci;
+	 if (_dedup_loci) {
+		std::vector<size_t> locus_rep;
+		compute_locus_representatives(family, locus_rep, loci);
+	 } else {
+		loci.reserve(family.genotype_length());
+		for (size_t l= 0; l < family.genotype_length(); ++l)
+		  loci.push_back(l);
+	 }
+	 return predict_instance(family, loci, _extended, _break_symmetries);
+  }
+
 
 
 public:
 
-  explicit zrhcstar_t(const bool extended=false)
-		:_extended(extended)
+  explicit zrhcstar_t(const bool extended=false,
+							  const bool break_symmetries=false,
+							  const bool s_vars_first=false,
+							  const bool dedup_loci=false)
+		:_extended(extended), _break_symmetries(break_symmetries),
+		 _s_vars_first(s_vars_first), _dedup_loci(dedup_loci), _cache(NULL)
   {};
 
+// The options that affect the computed haplotype configurations (used to
+// key the result cache)
+  std::string options_signature() const {
+	 std::ostringstream os;
+	 os << "xor=" << _extended <<
+		" break-symmetries=" << _break_symmetries <<
+		" inheritance-first=" << _s_vars_first <<
+		" dedup-loci=" << _dedup_loci;
+	 return os.str();
+  };
+
+// Use 'cache' (which must outlive this object) to look for and to store
+// the results of the families
+  void set_result_cache(const result_cache_t* cache) {
+	 _cache= cache;
+  };
+
+// Look for the result of the family in the result cache (if any).
+// Return 'ZRHC' (and 'ped' stores the cached haplotype configuration),
+// 'NO_ZRHC', or an empty string if the result is not cached.
+// 'key' is set to the key of the family (to store its result later).
+  std::string lookup_result(pedigree_t& ped,
+									 std::string& key) const {
+	 key.clear();
+	 if (_cache == NULL)
+		return "";
+	 phase_timer_t timer("cache_lookup");
+	 family_t& family= ped.families().front();
+	 key= _cache->key(family);
+	 bool is_zrhc;
+	 if (_cache->load(key, family, is_zrhc)) {
+		L_INFO("The result of the pedigree has been found in the result cache.");
+		run_stats_t::get_run_stats().add_to_counter("cache_hits", 1);
+		return is_zrhc ? "ZRHC" : "NO_ZRHC";
+	 }
+	 run_stats_t::get_run_stats().add_to_counter("cache_misses", 1);
+	 return "";
+  };
+
+// Store the result of the family in the result cache (if any)
+  void store_result(const std::string& key,
+						  const pedigree_t& ped,
+						  const bool is_zrhc) const {
+	 if (_cache == NULL)
+		return;
+	 _cache->store(key, ped.families().front(), is_zrhc);
+  };
+
   void save_ZRHC(pedigree_t& ped,
 					  std::ostream& hap_os) const {
 	 L_INFO("Saving haplotype configuration...");
+	 phase_timer_t timer("output");
 // FIXME: Improve template instantiation
 	 biallelic_haplotype_pair_writer_t<> hpw;
 	 plink_haplotype_writer_t<> writer(hpw, "\t", "|");
@@ -105,6 +287,7 @@ public:
   bool read_SAT_results(pedcnf_t& cnf,
 								std::istream& res_is) const {
 	 L_INFO("Reading SAT results...");
+	 phase_timer_t timer("result_reading");
 	 const bool is_sat= cnf.assignment_from_minisat_format(res_is);
 	 L_INFO("SAT results successfully read.");
 	 return is_sat;
@@ -128,9 +311,36 @@ public:
 													  pedigree_t& ped,
 													  pedcnf_t*& cnf) const {
 	 prepare_pedigree_and_sat(ped_is, ped, cnf);
+	 save_SAT_instance(*cnf, sat_os, headers);
+  };
+
+  void create_SAT_instance(const pedigree_t& ped,
+									std::ostream& sat_os,
+									const std::vector<std::string>& headers,
+									pedcnf_t*& cnf) const {
+	 prepare_sat(ped, cnf);
+	 save_SAT_instance(*cnf, sat_os, headers);
+  };
+
+  void save_SAT_instance(const pedcnf_t& cnf,
+								 std::ostream& sat_os,
+								 const std::vector<std::string>& headers) const {
 // Output the instance
 	 L_INFO("Saving SAT instance...");
-	 cnf->clauses_to_dimacs_format(sat_os, headers);
+	 phase_timer_t timer("dimacs_writing");
+	 cnf.clauses_to_dimacs_format(sat_os, headers);
+	 L_INFO("SAT instance successfully saved.");
+  };
+
+// Create the SAT instance and save it in the binary format (see
+// 'binary_instance.hpp')
+  void create_binary_SAT_instance(const pedigree_t& ped,
+											 std::ostream& sat_os,
+											 pedcnf_t*& cnf) const {
+	 prepare_sat(ped, cnf);
+	 L_INFO("Saving SAT instance in binary format...");
+	 phase_timer_t timer("binary_writing");
+	 cnf->clauses_to_binary_format(sat_os);
 	 L_INFO("SAT instance successfully saved.");
   };
 
@@ -166,15 +376,17 @@ public:
 #endif // not defined ONLY_INTERNAL_SAT_SOLVER
 
   bool compute_HC_from_model(pedigree_t& ped,
-									  pedcnf_t*& cnf) const {
+									  pedcnf_t*& cnf,
+									  const unsigned int n_threads= 0) const {
 	 pedigree_t::pedigree_t& family= ped.families().front();
 // Compute the actual haplotype configuration
-	 compute_ZRHC_from_SAT(family, *cnf);
+	 phase_timer_t decoding_timer("decoding");
+	 compute_ZRHC_from_SAT(family, *cnf, n_threads);
+	 decoding_timer.stop();
 // Check the haplotype configuration
-	 const bool ok=
-		family.is_completely_haplotyped() &&
-		family.is_consistent() &&
-		family.is_zero_recombinant();
+	 phase_timer_t verification_timer("verification");
+	 const bool ok= is_valid_ZRHC(family, n_threads);
+	 verification_timer.stop();
 	 if (ok) {
 		L_INFO("The computed haplotype configuration is valid.");
 	 } else {
@@ -183,6 +395,753 @@ public:
 	 return ok;
   };
 
+#ifdef INTERNAL_SAT_SOLVER
+
+private:
+
+// Task that encodes and solves a window of loci and keeps only the
+// values of the variables needed to compute the haplotypes.
+// As soon as a window and all the previous ones have been solved, their
+// haplotypes are computed and stitched in order and their models are
+// released, thus only the models of the windows solved out of order are
+// kept in memory.
+  class window_solver_t {
+  private:
+	 const zrhcstar_t& _zrhcstar;
+	 family_t& _family;
+	 const std::vector<locus_window_t>& _windows;
+	 std::vector<window_model_t> _models;
+	 std::vector<char> _solved;
+	 std::vector<char>& _sat;
+	 std::vector<char>& _interrupted;
+	 boost::mutex _mutex;
+	 size_t _next;
+	 bool _failed;
+
+// Compute the haplotypes of the window 'i' and stitch them to the previous
+// windows (the mutex must be held)
+	 void decode(const size_t i) {
+		phase_timer_t timer("decoding");
+		const locus_window_t& window= _windows[i];
+		compute_ZRHC_from_SAT(_family, _models[i], window.owned, window.last);
+		if (i > 0) {
+		  const size_t no_of_swaps=
+			 stitch_founder_phases(_family, _models[i], window);
+		  Q_DEBUG(logger(), "Window " << window << ": swapped the haplotypes of " <<
+					 no_of_swaps << " founders.");
+		}
+	 };
+
+  public:
+	 window_solver_t(const zrhcstar_t& zrhcstar,
+						  family_t& family,
+						  const std::vector<locus_window_t>& windows,
+						  std::vector<char>& sat,
+						  std::vector<char>& interrupted)
+		  :_zrhcstar(zrhcstar), _family(family), _windows(windows),
+			_models(windows.size()), _solved(windows.size(), false),
+			_sat(sat), _interrupted(interrupted), _next(0), _failed(false)
+	 {};
+
+	 void operator()(const size_t i) {
+		const locus_window_t& window= _windows[i];
+// The encoding reads only the genotypes of the family, while the decoding
+// of the previous windows writes only the haplotypes
+		pedcnf_t* cnf= _zrhcstar.encode(_family, window.first, window.last);
+		record_instance_size(*cnf);
+		const bool sat= cnf->solve();
+		const bool interrupted= cnf->is_interrupted();
+		boost::mutex::scoped_lock lock(_mutex);
+		_sat[i]= sat;
+		_interrupted[i]= interrupted;
+		_solved[i]= true;
+		_failed= _failed || !sat || interrupted;
+		if (!_failed) {
+		  _models[i].set(_family, *cnf, window);
+		}
+		delete cnf;
+		for (; !_failed && (_next < _windows.size()) && _solved[_next]; ++_next) {
+		  decode(_next);
+		  _models[_next].clear();
+		}
+	 };
+  };
+
+// Task that encodes and solves a single locus (the s variables are not
+// shared with the other loci).
+// Each locus gets its own small solver: guarding the loci by selectors in
+// a single solver would keep the s variables shared and each solve under
+// a selector would still have to assign the variables of every locus.
+  class locus_checker_t {
+  private:
+	 const zrhcstar_t& _zrhcstar;
+	 const family_t& _family;
+	 std::vector<char>& _sat;
+	 std::vector<char>& _interrupted;
+
+  public:
+	 locus_checker_t(const zrhcstar_t& zrhcstar,
+						  const family_t& family,
+						  std::vector<char>& sat,
+						  std::vector<char>& interrupted)
+		  :_zrhcstar(zrhcstar), _family(family), _sat(sat),
+			_interrupted(interrupted)
+	 {};
+
+	 void operator()(const size_t l) {
+		ped2cnf_conv_t<family_t::gen_t, family_t::hap_t,
+							family_t::phen_t, family_t::id_t,
+							pedcnf_t> conv(_zrhcstar._break_symmetries);
+		pedcnf_t cnf;
+		conv.add_loci(cnf, _family, l, l+1, l);
+		_sat[l]= cnf.solve();
+		_interrupted[l]= cnf.is_interrupted();
+	 };
+  };
+
+public:
+
+// Solve each locus independently of the others (i.e. the s variables are
+// free at each locus).
+// A locus that is infeasible by itself makes the whole family infeasible.
+// The loci that have been proved infeasible are stored in
+// 'infeasible_loci', while the loci whose solve has been interrupted are
+// stored in 'undecided_loci'.
+  bool find_infeasible_loci(const pedigree_t& ped,
+									 std::vector<size_t>& infeasible_loci,
+									 std::vector<size_t>& undecided_loci,
+									 const unsigned int n_threads) const {
+	 const family_t& family= ped.families().front();
+	 L_INFO("Checking the feasibility of each locus on " <<
+			  effective_no_of_threads(n_threads) << " threads...");
+	 phase_timer_t timer("locus_check");
+	 std::vector<char> sat(family.genotype_length(), false);
+	 std::vector<char> interrupted(family.genotype_length(), false);
+	 locus_checker_t checker(*this, family, sat, interrupted);
+	 parallel_for(family.genotype_length(), checker, n_threads);
+	 timer.stop();
+	 infeasible_loci.clear();
+	 undecided_loci.clear();
+	 for (size_t l= 0; l < family.genotype_length(); ++l) {
+		if (interrupted[l]) {
+		  L_WARN("The SAT solver has been interrupted on locus " << l << ".");
+		  undecided_loci.push_back(l);
+		} else if (!sat[l]) {
+		  L_ERROR("Locus " << l << " CANNOT be realized by a "
+					 "zero-recombinant haplotype configuration.");
+		  infeasible_loci.push_back(l);
+		}
+	 }
+	 if (!undecided_loci.empty()) {
+		L_WARN("The feasibility of " << undecided_loci.size() << " loci is "
+				 "unknown, since the SAT solver has been interrupted.");
+	 }
+	 if (!infeasible_loci.empty()) {
+		L_ERROR(infeasible_loci.size() << " loci are infeasible by themselves.");
+	 } else if (undecided_loci.empty()) {
+		L_INFO("Each locus is feasible by itself.");
+	 }
+	 return infeasible_loci.empty();
+  };
+
+// Compute a haplotype configuration that is zero-recombinant on each
+// window of loci.
+// The windows are solved independently on 'n_threads' threads and the
+// phases of the founders are stitched across the overlaps as soon as the
+// previous windows have been solved.
+// The result is 'ZRHC' (and 'ped' stores the haplotype configuration),
+// 'NO_ZRHC' (if some window has been proved infeasible), 'UNDEF' (if the
+// SAT solver has been interrupted on some window and the others are
+// feasible), or 'ERROR'.
+  std::string compute_HC_by_windows(pedigree_t& ped,
+									  const size_t window_size,
+									  const size_t window_overlap,
+									  const unsigned int n_threads) const {
+	 family_t& family= ped.families().front();
+	 const std::vector<locus_window_t> windows=
+		compute_locus_windows(family.genotype_length(),
+									 window_size, window_overlap);
+	 L_INFO("Solving " << windows.size() << " windows of at most " <<
+			  window_size << " loci (overlap: " << window_overlap << " loci) on " <<
+			  effective_no_of_threads(n_threads) << " threads...");
+	 std::vector<char> sat(windows.size(), false);
+	 std::vector<char> interrupted(windows.size(), false);
+	 window_solver_t solver(*this, family, windows, sat, interrupted);
+	 phase_timer_t solving_timer("encoding_and_solving");
+	 parallel_for(windows.size(), solver, n_threads);
+	 solving_timer.stop();
+	 L_INFO("All the windows have been solved.");
+
+	 std::string status= "ZRHC";
+	 for (size_t i= 0; i < windows.size(); ++i) {
+		if (interrupted[i]) {
+		  L_INFO("The SAT solver has been interrupted on window " << windows[i] << ".");
+		  if (status == "ZRHC") {
+			 status= "UNDEF";
+		  }
+		} else if (!sat[i]) {
+		  L_INFO("Window " << windows[i] << " CANNOT be realized by a "
+					"zero-recombinant haplotype configuration.");
+		  status= "NO_ZRHC";
+		}
+	 }
+	 if (status != "ZRHC") {
+		return status;
+	 }
+	 L_INFO("The haplotype configurations of the windows have been stitched.");
+
+// Check the haplotype configuration
+	 phase_timer_t verification_timer("verification");
+	 packed_haplotype_configuration_t<family_t> phc(family, n_threads);
+	 bool ok=
+		phc.is_completely_haplotyped() &&
+		phc.is_consistent();
+	 for (size_t i= 0; ok && (i < windows.size()); ++i) {
+		ok= phc.is_zero_recombinant(windows[i].owned, windows[i].last);
+	 }
+	 verification_timer.stop();
+	 if (ok) {
+		L_INFO("The computed haplotype configuration is valid.");
+	 } else {
+		L_ERROR("The computed haplotype configuration is not valid.");
+	 }
+	 return ok ? "ZRHC" : "ERROR";
+  };
+
+private:
+
+  template <typename T_PEDCNF>
+  bool solve_by_blocks(const family_t& family,
+							  const size_t block_size,
+							  pedcnf_t*& cnf,
+							  size_t& no_of_feasible_loci) const {
+	 ped2cnf_conv_t<family_t::gen_t, family_t::hap_t,
+						 family_t::phen_t, family_t::id_t,
+						 T_PEDCNF> conv(_break_symmetries, _s_vars_first);
+	 T_PEDCNF* pcnf= new T_PEDCNF;
+	 pcnf->set_incremental(true);
+	 cnf= pcnf;
+	 conv.number_s_vars_first(*pcnf, family);
+	 const std::vector<locus_window_t> blocks=
+		compute_locus_windows(family.genotype_length(), block_size, 0);
+	 for (size_t i= 0; i < blocks.size(); ++i) {
+		conv.add_loci(*pcnf, family, blocks[i].first, blocks[i].last, 0);
+		L_DEBUG("Solving block " << blocks[i] << " (" <<
+				  pcnf->vars().size() << " variables and " <<
+				  pcnf->no_of_clauses() << " clauses)...");
+		if (!pcnf->solve()) {
+		  no_of_feasible_loci= blocks[i].first;
+		  if (pcnf->is_interrupted()) {
+			 L_INFO("The SAT solver has been interrupted on the loci " << blocks[i] <<
+					  " (block " << (i+1) << " of " << blocks.size() << ").");
+		  } else {
+			 L_INFO("The loci " << blocks[i] << " make the family infeasible "
+					  "(block " << (i+1) << " of " << blocks.size() << ").");
+		  }
+		  return false;
+		}
+	 }
+	 no_of_feasible_loci= family.genotype_length();
+	 return true;
+  };
+
+public:
+
+// Encode and solve the loci block by block on a single (incremental)
+// SAT solver, thus infeasible families are detected as soon as the
+// first infeasible block is added.
+// 'no_of_feasible_loci' is set to the first locus of such block (or to the
+// genotype length if the family is feasible).
+// The result is 'ZRHC' (and 'ped' stores the haplotype configuration),
+// 'NO_ZRHC', 'UNDEF' (if the SAT solver has been interrupted), or 'ERROR'.
+// xor-clauses are never used, since the internal solver does not
+// correctly restore the variables eliminated by xor-clauses when they
+// appear in the clauses of the following blocks.
+  std::string compute_HC_by_blocks(pedigree_t& ped,
+									 const size_t block_size,
+									 size_t& no_of_feasible_loci) const {
+	 family_t& family= ped.families().front();
+	 L_INFO("Solving the loci incrementally in blocks of " << block_size <<
+			  " loci...");
+	 if (_extended) {
+		L_WARN("xor-clauses are not used when solving incrementally.");
+	 }
+	 pedcnf_t* cnf;
+	 phase_timer_t timer("encoding_and_solving");
+	 const bool is_sat=
+		solve_by_blocks<pedcnf_t>(family, block_size, cnf, no_of_feasible_loci);
+	 timer.stop();
+	 record_instance_size(*cnf);
+	 std::string status;
+	 if (is_sat) {
+		L_INFO("The SAT instance is composed by " <<
+				 std::setw(8) << cnf->vars().size() << " variables and " <<
+				 std::setw(8) << cnf->no_of_clauses() << " clauses");
+		status= compute_HC_from_model(ped, cnf) ? "ZRHC" : "ERROR";
+	 } else {
+		status= cnf->is_interrupted() ? "UNDEF" : "NO_ZRHC";
+	 }
+	 delete cnf;
+	 return status;
+  };
+
+// Encode the constraints between each individual and its parents at each
+// locus under a selector variable, and solve the instance assuming that
+// every selector is true.
+// If the pedigree is infeasible, 'core' is set to the pairs (progressive
+// id of the individual, locus) whose constraints are enough to make the
+// pedigree infeasible.
+// The result is 'ZRHC' (and 'ped' stores the haplotype configuration),
+// 'NO_ZRHC', 'UNDEF' (if the SAT solver has been interrupted before
+// proving that the pedigree is infeasible), or 'ERROR'.
+// xor-clauses are never used, since they cannot be guarded by selectors.
+  std::string compute_HC_with_unsat_core(pedigree_t& ped,
+											 std::vector< std::pair<size_t, size_t> >& core) const {
+	 family_t& family= ped.families().front();
+	 if (_extended) {
+		L_WARN("xor-clauses are not used when computing unsatisfiable cores.");
+	 }
+	 ped2cnf_conv_t<family_t::gen_t, family_t::hap_t,
+						 family_t::phen_t, family_t::id_t,
+						 pedcnf_t> conv(_break_symmetries, _s_vars_first, true);
+	 phase_timer_t encoding_timer("encoding");
+	 pedcnf_t* cnf= conv.convert(family);
+	 encoding_timer.stop();
+	 record_instance_size(*cnf);
+	 phase_timer_t solving_timer("solving");
+	 std::vector<pedcnf_t::pedvar_t> sel_core;
+	 const bool is_sat= cnf->solve_with_selectors(sel_core);
+	 solving_timer.stop();
+	 std::string status;
+	 core.clear();
+	 if (is_sat) {
+		status= compute_HC_from_model(ped, cnf) ? "ZRHC" : "ERROR";
+	 } else if (sel_core.empty() && cnf->is_interrupted()) {
+// An interruption while the core is shrunk still leaves a core
+		status= "UNDEF";
+	 } else {
+		status= "NO_ZRHC";
+		BOOST_FOREACH( const pedcnf_t::pedvar_t& sel, sel_core ) {
+		  core.push_back(std::make_pair(sel.get<1>(), sel.get<2>()));
+		}
+		std::sort(core.begin(), core.end());
+		L_INFO("The following " << core.size() << " (individual, locus) pairs "
+				 "make the pedigree infeasible:");
+		typedef std::pair<size_t, size_t> pair_t;
+		BOOST_FOREACH( const pair_t& p, core ) {
+		  const family_t::individual_t& ind= family.get_by_progr(p.first);
+		  L_INFO("  individual " << ind.id() <<
+					" (father " << (ind.has_father() ? tostr(ind.father().id()) : "-") <<
+					", mother " << (ind.has_mother() ? tostr(ind.mother().id()) : "-") <<
+					") at locus " << p.second);
+		}
+	 }
+	 delete cnf;
+	 return status;
+  };
+
+// Solve the pedigree incrementally with respect to the state saved in
+// 'state_file' by a previous run (if any): if the previous pedigree has
+// the same individuals, parents, and loci, only the constraints affected
+// by the changed genotypes are encoded again, and the saved learnt clauses
+// and model are reused.  The new state is then saved in 'state_file'.
+// The result is 'ZRHC' (and 'ped' stores the haplotype configuration),
+// 'NO_ZRHC', 'UNDEF' (if the SAT solver has been interrupted), or 'ERROR'.
+// xor-clauses and symmetry-breaking clauses are never used, since they
+// cannot be guarded by selectors.
+  std::string compute_HC_incrementally(pedigree_t& ped,
+													const std::string& state_file) const {
+	 family_t& family= ped.families().front();
+	 if (_extended) {
+		L_WARN("xor-clauses are not used when solving incrementally.");
+	 }
+	 if (_break_symmetries) {
+		L_WARN("Symmetries are not broken when solving incrementally.");
+	 }
+	 incremental_solver_t<family_t> solver(_s_vars_first, options_signature());
+	 phase_timer_t encoding_timer("encoding");
+	 bool loaded= false;
+	 if (boost::filesystem::exists(state_file)) {
+		L_INFO("Loading the incremental state from file '" << state_file << "'...");
+		std::ifstream state_is(state_file.c_str());
+		loaded= solver.load_state(state_is) && solver.has_same_structure(family);
+		if (!loaded) {
+		  L_WARN("The incremental state cannot be reused: the pedigree is "
+					"encoded from scratch.");
+		}
+	 }
+	 if (loaded) {
+		const size_t no_of_groups= solver.update(family);
+		run_stats_t::get_run_stats().add_to_counter("incremental_reencoded_groups",
+																  no_of_groups);
+	 } else {
+		solver.initialize(family);
+	 }
+	 encoding_timer.stop();
+	 record_instance_size(solver.cnf());
+	 phase_timer_t solving_timer("solving");
+	 const bool is_sat= solver.solve();
+	 solving_timer.stop();
+	 std::string status;
+	 if (is_sat) {
+		pedcnf_t* cnf= &solver.cnf();
+		status= compute_HC_from_model(ped, cnf) ? "ZRHC" : "ERROR";
+	 } else if (solver.is_interrupted()) {
+		status= "UNDEF";
+	 } else {
+		status= "NO_ZRHC";
+	 }
+	 if ((status == "ZRHC") || (status == "NO_ZRHC")) {
+		L_INFO("Saving the incremental state to file '" << state_file << "'...");
+		const std::string tmp_file= state_file + ".tmp";
+		std::ofstream state_os(tmp_file.c_str());
+		solver.save_state(state_os);
+		state_os.close();
+		if (state_os) {
+		  boost::filesystem::rename(tmp_file, state_file);
+		} else {
+		  L_WARN("Impossible to save the incremental state to file '" <<
+					state_file << "'.");
+		}
+	 }
+	 return status;
+  };
+
+// Solve the SAT instance of file 'sat_file' (in the binary format or in
+// the DIMACS format, possibly compressed and with xor-clauses) with the
+// internal SAT solver and write the result to 'res_os' in the format read
+// by 'compute_HC_from_SAT_results' (SAT or UNSAT, followed by the
+// assignment).
+// The result is 'SAT', 'UNSAT', or 'UNDEF' (if the SAT solver has been
+// interrupted; INDET is written, and reading it back is an error).
+  std::string solve_SAT_instance(const std::string& sat_file,
+											std::ostream& res_os) const {
+	 SAT_solver_iface_t solver;
+	 phase_timer_t loading_timer("instance_loading");
+	 size_t no_of_vars;
+	 run_stats_t& rs= run_stats_t::get_run_stats();
+	 if (binary_instance_t::is_binary_instance(sat_file)) {
+		L_INFO("Loading the binary SAT instance...");
+		const binary_instance_t instance(sat_file);
+		instance.load(solver);
+		no_of_vars= instance.no_of_vars();
+		rs.add_to_counter("variables", instance.no_of_vars());
+		rs.add_to_counter("clauses", instance.no_of_clauses());
+		rs.add_to_counter("xor_clauses", instance.no_of_xor_clauses());
+	 } else {
+		L_INFO("Loading the DIMACS SAT instance...");
+		dimacs_reader_t reader;
+		reader.load(sat_file, solver);
+		no_of_vars= reader.no_of_vars();
+		rs.add_to_counter("variables", reader.no_of_vars());
+		rs.add_to_counter("clauses", reader.no_of_clauses());
+		rs.add_to_counter("xor_clauses", reader.no_of_xor_clauses());
+	 }
+	 loading_timer.stop();
+	 L_INFO("SAT instance successfully loaded.");
+	 phase_timer_t solving_timer("solving");
+	 const bool is_sat= solver.solve();
+	 solving_timer.stop();
+	 phase_timer_t writing_timer("result_writing");
+	 std::string status;
+	 if (is_sat) {
+		status= "SAT";
+		std::vector<bool> vals(no_of_vars, false);
+		solver.model(vals);
+		res_os << "SAT\n";
+		for (size_t i= 0; i < vals.size(); ++i) {
+		  res_os << (vals[i] ? "" : "-") << (i+1) << ' ';
+		}
+		res_os << "0\n";
+	 } else if (solver.is_interrupted()) {
+		status= "UNDEF";
+		res_os << "INDET\n";
+	 } else {
+		status= "UNSAT";
+		res_os << "UNSAT\n";
+	 }
+	 return status;
+  };
+
+// The outcome of the computation on a pedigree file of a batch
+  class batch_job_t {
+  public:
+	 std::string pedigree;
+	 std::string haplotypes;
+	 std::string status;
+	 std::string message;
+	 double time;
+	 instance_estimate_t estimate;
+// The size of the SAT instance of the job (0 if it has not been encoded).
+// The counters of the run statistics sum the instances of every job.
+	 size_t variables;
+	 size_t clauses;
+	 size_t xor_clauses;
+
+	 batch_job_t(const std::string& pedigree_,
+					 const std::string& haplotypes_)
+		  :pedigree(pedigree_), haplotypes(haplotypes_), status("NOT_RUN"),
+			time(0.0), variables(0), clauses(0), xor_clauses(0)
+	 {};
+  };
+
+// Estimate the SAT instance of the pedigree of a job by scanning its file.
+// Unreadable files get an empty estimate (they fail when the job is run).
+  void estimate_batch_job(batch_job_t& job,
+								  const bool in_compress) const {
+	 try {
+		pedigree_file_stats_t stats;
+		file_utility::pistream ped_is=
+		  file_utility::get_file_utility().
+		  get_ifstream(job.pedigree, in_compress);
+		scan_pedigree_file(*ped_is, stats);
+		job.estimate= estimate_instance(stats, _extended);
+		L_DEBUG("Pedigree file '" << job.pedigree << "': " << stats <<
+				  ". Estimated instance: " << job.estimate << ".");
+	 } catch (std::exception& e) {
+		L_WARN("Impossible to estimate the instance of pedigree file '" <<
+				 job.pedigree << "': " << e.what());
+	 } catch (assertion_failed_exception& e) {
+		L_WARN("Impossible to estimate the instance of pedigree file '" <<
+				 job.pedigree << "': " << e.what());
+	 }
+  };
+
+// Read a pedigree and solve it on the calling thread (unless its result is
+// in the result cache).
+// The result is 'ZRHC' (and 'ped' stores the haplotype configuration),
+// 'NO_ZRHC' (also for Mendelian errors), 'UNDEF' (if the SAT solver has
+// been interrupted), or 'ERROR' (and 'message' explains why).
+// If 'job' is not NULL, the size of the SAT instance is stored in it.
+// Malformed pedigrees raise an exception.
+  std::string solve_pedigree(std::istream& ped_is,
+									  pedigree_t& ped,
+									  std::string& message,
+									  batch_job_t* job= NULL) const {
+	 message.clear();
+	 read_pedigree(ped_is, ped);
+	 if (!is_mendelian_consistent(ped)) {
+		message= "Mendelian errors";
+		return "NO_ZRHC";
+	 }
+	 std::string cache_key;
+	 const std::string cached= lookup_result(ped, cache_key);
+	 if (!cached.empty()) {
+		message= "cached";
+		return cached;
+	 }
+	 pedcnf_t* cnf;
+	 prepare_sat(ped, cnf);
+	 if (job != NULL) {
+		job->variables= cnf->vars().size();
+		job->clauses= cnf->no_of_clauses() - cnf->no_of_xor_clauses();
+		job->xor_clauses= cnf->no_of_xor_clauses();
+	 }
+	 phase_timer_t solving_timer("solving");
+	 const bool is_sat= cnf->solve();
+	 solving_timer.stop();
+	 std::string status;
+	 if (is_sat) {
+		if (compute_HC_from_model(ped, cnf, 1)) {
+		  status= "ZRHC";
+		} else {
+		  status= "ERROR";
+		  message= "invalid haplotype configuration";
+		}
+	 } else if (cnf->is_interrupted()) {
+		status= "UNDEF";
+		message= "SAT solver interrupted";
+	 } else {
+		status= "NO_ZRHC";
+	 }
+	 delete cnf;
+	 if ((status == "ZRHC") || (status == "NO_ZRHC")) {
+		store_result(cache_key, ped, status == "ZRHC");
+	 }
+	 return status;
+  };
+
+// Read the pedigree file of a job, solve it, and save its haplotype
+// configuration (if any).
+// The job status is 'ZRHC', 'NO_ZRHC' (also for Mendelian errors),
+// 'UNDEF' (if the SAT solver has been interrupted), or 'ERROR'.
+  void solve_batch_job(batch_job_t& job,
+							  const bool in_compress,
+							  const bool out_compress) const {
+	 const double start= run_stats_t::wall_time();
+	 job.variables= job.clauses= job.xor_clauses= 0;
+	 try {
+		pedigree_t ped;
+		{
+		  file_utility::pistream ped_is=
+			 file_utility::get_file_utility().
+			 get_ifstream(job.pedigree, in_compress);
+		  job.status= solve_pedigree(*ped_is, ped, job.message, &job);
+		}
+		if (job.status == "ZRHC") {
+		  file_utility::postream hap_os=
+			 file_utility::get_file_utility().
+			 get_ofstream(job.haplotypes, out_compress);
+		  save_ZRHC(ped, *hap_os);
+		}
+	 } catch (std::exception& e) {
+		L_ERROR("Pedigree file '" << job.pedigree << "' failed: " << e.what());
+		job.status= "ERROR";
+		job.message= e.what();
+	 } catch (assertion_failed_exception& e) {
+		L_ERROR("Pedigree file '" << job.pedigree << "' failed: " << e.what());
+		job.status= "ERROR";
+		job.message= e.what();
+	 }
+	 job.time= run_stats_t::wall_time() - start;
+	 L_INFO("Pedigree file '" << job.pedigree << "': " << job.status <<
+			  " (" << job.time << "s).");
+  };
+
+private:
+
+// Task that solves the job of position 'order[i]'
+  class batch_solver_t {
+  private:
+	 const zrhcstar_t& _zrhcstar;
+	 std::vector<batch_job_t>& _jobs;
+	 const std::vector<size_t>& _order;
+	 const bool _in_compress;
+	 const bool _out_compress;
+
+  public:
+	 batch_solver_t(const zrhcstar_t& zrhcstar,
+						 std::vector<batch_job_t>& jobs,
+						 const std::vector<size_t>& order,
+						 const bool in_compress,
+						 const bool out_compress)
+		  :_zrhcstar(zrhcstar), _jobs(jobs), _order(order),
+			_in_compress(in_compress), _out_compress(out_compress)
+	 {};
+
+	 void operator()(const size_t i) {
+		_zrhcstar.solve_batch_job(_jobs[_order[i]], _in_compress, _out_compress);
+	 };
+  };
+
+// Task that estimates the instance of the job of position i
+  class batch_estimator_t {
+  private:
+	 const zrhcstar_t& _zrhcstar;
+	 std::vector<batch_job_t>& _jobs;
+	 const bool _in_compress;
+
+  public:
+	 batch_estimator_t(const zrhcstar_t& zrhcstar,
+							 std::vector<batch_job_t>& jobs,
+							 const bool in_compress)
+		  :_zrhcstar(zrhcstar), _jobs(jobs), _in_compress(in_compress)
+	 {};
+
+	 void operator()(const size_t i) {
+		_zrhcstar.estimate_batch_job(_jobs[i], _in_compress);
+	 };
+  };
+
+public:
+
+// Solve every job of the batch on 'n_threads' threads.
+// The SAT instance of each job is estimated (from a scan of the pedigree
+// file) before solving, and the jobs are started from the largest
+// estimated instance, so that a few large pedigrees do not keep a single
+// thread busy at the end of the batch.
+// If 'memory_budget_mb' is positive, a job is started only if the total
+// estimated memory of the running jobs stays within the budget (smaller
+// jobs are started meanwhile if they fit, and a job larger than the budget
+// is solved alone).
+// A failing job does not stop the others.
+  void solve_batch(std::vector<batch_job_t>& jobs,
+						 const unsigned int n_threads,
+						 const bool in_compress,
+						 const bool out_compress,
+						 const double memory_budget_mb= 0.0) const {
+	 L_INFO("Estimating the SAT instances of " << jobs.size() <<
+			  " pedigree files...");
+	 {
+		phase_timer_t timer("estimation");
+		batch_estimator_t estimator(*this, jobs, in_compress);
+		parallel_for(jobs.size(), estimator, n_threads);
+	 }
+	 std::vector< std::pair<double, size_t> > by_size;
+	 by_size.reserve(jobs.size());
+	 for (size_t i= 0; i < jobs.size(); ++i) {
+		by_size.push_back(std::make_pair(jobs[i].estimate.memory_mb, i));
+	 }
+	 std::stable_sort(by_size.rbegin(), by_size.rend());
+	 std::vector<size_t> order;
+	 std::vector<double> weights;
+	 order.reserve(jobs.size());
+	 weights.reserve(jobs.size());
+	 for (size_t i= 0; i < by_size.size(); ++i) {
+		order.push_back(by_size[i].second);
+		weights.push_back(by_size[i].first);
+	 }
+	 batch_solver_t solver(*this, jobs, order, in_compress, out_compress);
+	 if (memory_budget_mb > 0.0) {
+		L_INFO("Solving " << jobs.size() << " pedigree files on " <<
+				 effective_no_of_threads(n_threads) << " threads within " <<
+				 memory_budget_mb << "MB...");
+		parallel_for(jobs.size(), solver, weights, memory_budget_mb, n_threads);
+	 } else {
+		L_INFO("Solving " << jobs.size() << " pedigree files on " <<
+				 effective_no_of_threads(n_threads) << " threads...");
+		parallel_for(jobs.size(), solver, n_threads);
+	 }
+	 L_INFO("All the pedigree files have been processed.");
+  };
+
+// Get the pedigree files of a batch, that is every regular file of the
+// directory 'path' (sorted by name) or every file listed in the manifest
+// 'path' (one file per line, empty lines and lines starting with '#' are
+// ignored).
+  static void list_batch_inputs(const std::string& path,
+										  std::vector<std::string>& inputs) {
+	 inputs.clear();
+	 if (boost::filesystem::is_directory(path)) {
+		boost::filesystem::directory_iterator end;
+		for (boost::filesystem::directory_iterator it(path); it != end; ++it) {
+		  if (boost::filesystem::is_regular_file(it->status())) {
+			 inputs.push_back(it->path().string());
+		  }
+		}
+		std::sort(inputs.begin(), inputs.end());
+	 } else {
+		std::ifstream manifest(path.c_str());
+		if (!manifest) {
+		  throw std::logic_error(std::string("Impossible to open the batch manifest '")
+										 + path + "'.");
+		}
+		std::string line;
+		while (std::getline(manifest, line)) {
+		  boost::trim(line);
+		  if (!line.empty() && (line[0] != '#')) {
+			 inputs.push_back(line);
+		  }
+		}
+	 }
+  };
+
+// Write a status record (tab-separated) for each job of the batch
+  static void write_batch_status(std::ostream& os,
+											const std::vector<batch_job_t>& jobs) {
+	 os << "#pedigree\thaplotypes\tstatus\ttime\testimated_memory_mb\t"
+		"variables\tclauses\txor_clauses\tmessage" << std::endl;
+	 BOOST_FOREACH( const batch_job_t& job, jobs ) {
+		os << job.pedigree << "\t" << job.haplotypes << "\t" << job.status <<
+		  "\t" << std::fixed << std::setprecision(3) << job.time <<
+		  "\t" << std::setprecision(1) << job.estimate.memory_mb <<
+		  "\t" << job.variables << "\t" << job.clauses <<
+		  "\t" << job.xor_clauses << "\t" << job.message << std::endl;
+	 }
+  };
+
+#endif // INTERNAL_SAT_SOLVER
+
   bool compute_HC_from_model_and_save(pedigree_t& ped,
 												  pedcnf_t*& cnf,
 												  std::ostream& hap_os) const {
@@ -230,3 +1189,5 @@ public:
 #endif // not defined ONLY_INTERNAL_SAT_SOLVER
 
 };
+
+#endif // __ZRHC_APP_HPP__
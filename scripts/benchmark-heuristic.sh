@@ -0,0 +1,118 @@
+#!/bin/bash
+
+##########
+#
+#                               ZRHC-*
+#  Zero-Recombinant Haplotype Configuration with missing genotypes
+#
+#  Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+#
+#  Distributed under the terms of the GNU General Public License (GPL)
+#
+#
+#  This file is part of ZRHC-* (ZRHCstar).
+#
+#  ZRHC-* is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ZRHC-* is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+#
+##########
+
+##########
+#
+#  benchmark-heuristic.sh
+#
+#  A simple script that compares the default decision heuristic of the
+#  internal SAT solver with the '--inheritance-first' and
+#  '--break-symmetries' options on pedigrees generated by
+#  'pedigree-generator.py' and 'hc-generator.py' (with and without
+#  genotyping errors), both when the whole pedigree is solved at once and
+#  when it is solved incrementally block by block ('--block-size').
+#
+#  Usage: benchmark-heuristic.sh [ZRHCstar executable] [script directory]
+#
+#  The results are printed on the standard output as tab-separated values
+#  (instance, options, exit code, elapsed time in milliseconds, and
+#  conflicts and decisions of the internal SAT solver).
+#
+##########
+
+pedigree_sizes="1000 5000"
+genotype_lengths="50 100"
+missing_rates="0.0 0.10"
+genotyping_errors="0 1"
+n_conf=2
+
+block_size=10
+
+heuristics=( "" "--inheritance-first" "--break-symmetries" "--inheritance-first --break-symmetries"
+    "--block-size ${block_size}" "--block-size ${block_size} --inheritance-first" )
+
+formatd="%.5d"
+formatconf="%.2d"
+formatf="%5.3f"
+
+LANG=C
+
+ZRHC_exe=${1:-'./bin/ZRHCstar'}
+script_dir=${2:-`dirname ${PWD}/$0`}
+
+if test ! -x ${ZRHC_exe}; then
+    echo "Executable '${ZRHC_exe}' not found.  Aborting..."
+    exit 1
+fi
+for script in "pedigree-generator.py" "hc-generator.py"; do
+    if test ! -x ${script_dir}/${script}; then
+        echo "Script '${script}' not found in directory '${script_dir}'.  Aborting..."
+        exit 1
+    fi
+done
+
+work_dir=`mktemp -d benchmark-heuristic-XXXXXX`
+
+# Print the value of a counter saved by '--stats-json'
+counter() {
+    sed -n "s/.*\"$1\": *\([0-9]*\).*/\1/p" $2 | head -n 1
+}
+
+printf "instance\toptions\texit-code\ttime-ms\tconflicts\tdecisions\n"
+seed=2095
+for size in ${pedigree_sizes}; do
+    size_str=`printf "${formatd}" ${size}`
+    for conf in `seq 0 $((n_conf - 1))`; do
+        conf_str=`printf "${formatconf}" ${conf}`
+        prefix_id="size${size_str}-conf${conf_str}"
+        ${script_dir}/pedigree-generator.py -p ${size} -s ${seed} > ${work_dir}/pedigree-${prefix_id}.txt 2>> ${work_dir}/generation.log
+        for length in ${genotype_lengths}; do
+            length_str=`printf "${formatd}" ${length}`
+            for miss in ${missing_rates}; do
+                miss_str=`printf "${formatf}" ${miss}`
+                for errors in ${genotyping_errors}; do
+                    id="${prefix_id}-length${length_str}-miss${miss_str/./_}-err${errors}"
+                    ${script_dir}/hc-generator.py -l ${length} -m ${miss} -e ${errors} -s ${seed} < ${work_dir}/pedigree-${prefix_id}.txt > ${work_dir}/gen-ped-${id}.txt 2>> ${work_dir}/generation.log
+                    seed=$((seed + 122))
+                    for heuristic in "${heuristics[@]}"; do
+                        rm -f ${work_dir}/stats.json
+                        start=`date +%s%N`
+                        ${ZRHC_exe} -4 -p ${work_dir}/gen-ped-${id}.txt -h ${work_dir}/hap-ped-${id}.txt ${heuristic} --stats-json ${work_dir}/stats.json >> ${work_dir}/execution.log 2>&1
+                        exit_code=$?
+                        end=`date +%s%N`
+                        printf "%s\t%s\t%d\t%d\t%s\t%s\n" "${id}" "${heuristic:-default}" ${exit_code} $(( (end - start) / 1000000 )) \
+                            `counter solver_conflicts ${work_dir}/stats.json` `counter solver_decisions ${work_dir}/stats.json`
+                    done
+                done
+            done
+        done
+    done
+done
+
+rm -rf ${work_dir}
@@ -59,6 +59,12 @@ def parse_command_line():
                       type="int", default=122295,
                       help="the seed of the random generator",
                       metavar="INT")
+    parser.add_option("-e", "--genotyping-errors",
+                      action="store", dest="errors",
+                      type="int", default=0,
+                      help="the number of (called) single-locus genotypes that are "
+                      "randomly altered after the generation",
+                      metavar="INT")
     parser.add_option("-v", "--verbose",
                       action="store_true", dest="verbose",
                       default=False,
@@ -71,6 +77,7 @@ options = parse_command_line()
 length= options.length
 missing_genotype_prob= options.missing
 seed= options.seed
+n_errors= options.errors
 log_level= logging.DEBUG if options.verbose else logging.INFO
 allele1= "1"
 allele2= "2"
@@ -94,6 +101,7 @@ logging.info("Genotype encoding:  "
              homo1, homo2, heter, missing)
 logging.info("Genotype length: %d", length)
 logging.info("Missing genotype probability: %f", missing_genotype_prob)
+logging.info("Genotyping errors: %d", n_errors)
 logging.info("Seed: %d", seed)
 
 
@@ -162,6 +170,15 @@ for ind in pedigree:
     genotypes[ind]= [g if (random.random() >= missing_genotype_prob) else missing
                      for g in genotypes[ind] ]
 
+# Introduce genotyping errors (the generated haplotypes are left unchanged)
+called= [ (ind, l) for ind in sorted(pedigree) for l in range(length)
+          if genotypes[ind][l] != missing ]
+for (ind, l) in random.sample(called, min(n_errors, len(called))):
+    wrong= random.choice([ g for g in (homo1, homo2, heter) if g != genotypes[ind][l] ])
+    logging.info("Genotyping error on individual %4s at locus %4d: '%s' -> '%s'",
+                 ind, l, genotypes[ind][l], wrong)
+    genotypes[ind][l]= wrong
+
 # Print haplotype configuration as comment
 logging.info("Saving the generated haplotype configuration...")
 for ind in pedigree:
@@ -0,0 +1,189 @@
+#!/usr/bin/python3
+
+
+##########
+#
+#                               ZRHC-*
+#  Zero-Recombinant Haplotype Configuration with missing genotypes
+#
+#  Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+#
+#  Distributed under the terms of the GNU General Public License (GPL)
+#
+#
+#  This file is part of ZRHC-* (ZRHCstar).
+#
+#  ZRHC-* is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ZRHC-* is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+#
+##########
+
+
+##########
+#
+#  zrhc-client.py
+#
+#  A client of the solving service of ZRHC-* ('--solve-internal --serve').
+#  It sends the given pedigree files to a server listening on a Unix
+#  domain socket (or to a server started on its standard input/output),
+#  saves the haplotype configurations, and prints the status of each file.
+#
+##########
+
+import os
+import sys
+import socket
+import logging
+import threading
+import subprocess
+from optparse import OptionParser
+
+STATUSES= ( "ZRHC", "NO_ZRHC", "UNDEF", "ERROR" )
+
+def parse_command_line():
+    usage= "usage: %prog [options] PEDIGREE_FILE..."
+    parser= OptionParser(usage=usage)
+    parser.add_option("-s", "--socket",
+                      action="store", dest="socket",
+                      type="string", default=None,
+                      help="the Unix domain socket of the server "
+                      "(if not given, a server is started with '--executable')",
+                      metavar="PATH")
+    parser.add_option("-e", "--executable",
+                      action="store", dest="executable",
+                      type="string", default="ZRHCstar",
+                      help="the ZRHC-* executable used to start a server on "
+                      "its standard input/output",
+                      metavar="FILE")
+    parser.add_option("-t", "--threads",
+                      action="store", dest="threads",
+                      type="int", default=0,
+                      help="the number of threads of the started server",
+                      metavar="N")
+    parser.add_option("-o", "--output-dir",
+                      action="store", dest="output_dir",
+                      type="string", default=".",
+                      help="the directory where the haplotype configurations "
+                      "are saved (with prefix 'hap-')",
+                      metavar="DIR")
+    parser.add_option("-v", "--verbose",
+                      action="store_true", dest="verbose",
+                      default=False,
+                      help="print additional log messages")
+    (options, args) = parser.parse_args()
+
+    return(options, args)
+
+
+def read_response(stream):
+    # Lines that are not response headers (e.g. log messages of a server
+    # started without a logging configuration) are skipped
+    while True:
+        line= stream.readline()
+        if not line:
+            return None
+        fields= line.decode("utf-8", "replace").split()
+        if ( len(fields) == 3 and fields[1] in STATUSES and
+             fields[2].isdigit() ):
+            break
+        logging.debug("Skipping line '%s'", line.rstrip())
+    length= int(fields[2])
+    payload= stream.read(length)
+    if len(payload) < length:
+        return None
+    return (fields[0], fields[1], payload)
+
+
+(options, pedigrees) = parse_command_line()
+
+log_level= logging.DEBUG if options.verbose else logging.INFO
+
+logging.basicConfig(level=log_level,
+                    format='%(levelname)-6s [%(asctime)s]  %(message)s')
+
+if not pedigrees:
+    logging.fatal("No pedigree file given.")
+    sys.exit(1)
+
+if options.socket:
+    logging.info("Connecting to the server on socket '%s'", options.socket)
+    sock= socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(options.socket)
+    to_server= sock.makefile("wb")
+    from_server= sock.makefile("rb")
+    server= None
+else:
+    logging.info("Starting the server '%s'", options.executable)
+    server= subprocess.Popen([ options.executable, "-4", "--serve",
+                               "-t", str(options.threads) ],
+                             stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+    to_server= server.stdin
+    from_server= server.stdout
+
+# The requests are sent by a separate thread while the responses are read,
+# otherwise the server and the client could wait for each other once the
+# buffers of the pipe (or socket) are full.
+# The id of each request is the position of its file
+def send_requests():
+    try:
+        for i, pedigree in enumerate(pedigrees):
+            with open(pedigree, "rb") as f:
+                content= f.read()
+            to_server.write(("SOLVE %d %d\n" % (i, len(content))).encode("utf-8"))
+            to_server.write(content)
+            to_server.flush()
+        to_server.write(b"QUIT\n")
+        to_server.flush()
+        logging.info("Sent %d pedigree files", len(pedigrees))
+    except (IOError, OSError) as e:
+        logging.error("Impossible to send the requests: %s", e)
+
+sender= threading.Thread(target=send_requests)
+sender.daemon= True
+sender.start()
+
+statuses= {}
+while len(statuses) < len(pedigrees):
+    response= read_response(from_server)
+    if response is None:
+        logging.fatal("The server closed the connection after %d responses.",
+                      len(statuses))
+        break
+    (rid, status, payload)= response
+    if rid == "-":
+        logging.fatal("The server rejected a request: %s",
+                      payload.decode("utf-8", "replace"))
+        break
+    pedigree= pedigrees[int(rid)]
+    statuses[int(rid)]= status
+    if status == "ZRHC":
+        hap_name= os.path.join(options.output_dir,
+                               "hap-" + os.path.basename(pedigree))
+        with open(hap_name, "wb") as f:
+            f.write(payload)
+    elif payload:
+        logging.warning("Pedigree file '%s': %s", pedigree,
+                        payload.decode("utf-8", "replace"))
+
+sender.join(1.0 if len(statuses) < len(pedigrees) else None)
+try:
+    to_server.close()
+except (IOError, OSError):
+    pass
+if server is not None:
+    server.wait()
+
+for i, pedigree in enumerate(pedigrees):
+    print("%s\t%s" % (pedigree, statuses.get(i, "NOT_RUN")))
+
+sys.exit(0 if len(statuses) == len(pedigrees) else 1)
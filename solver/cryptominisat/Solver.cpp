@@ -104,6 +104,9 @@ Solver::Solver() :
         , needToInterrupt  (false)
         , needToDumpLearnts(false)
         , needToDumpOrig   (false)
+        , restartCallback  (NULL)
+        , restartCallbackData(NULL)
+        , maxConflicts     (std::numeric_limits<uint64_t>::max())
         , maxDumpLearntsSize(std::numeric_limits<uint32_t>::max())
         , libraryUsage     (true)
         , greedyUnbound    (false)
@@ -737,6 +740,8 @@ inline bool Solver::defaultPolarity()
             return mtrand.randInt(1);
         case polarity_auto:
             return true;
+        case polarity_user:
+            return true;
         default:
             assert(false);
     }
@@ -830,7 +835,7 @@ void Solver::calculateDefaultPolarities()
             << " neg: " << std::setw(7) << nVars()-  undecidedPolars - posPolars
             << std:: endl;
         }
-    } else {
+    } else if (polarity_mode != polarity_user) {
         std::fill(polarity.begin(), polarity.end(), defaultPolarity());
     }
 
@@ -1769,7 +1774,7 @@ const bool Solver::simplify()
 }
 
 /**
-@brief Used to dump claues and exit
+@brief Used to dump claues when the search is interrupted
 
 Only called when a clean interrupt has been asked for, and we are at a point
 where we can cleanly dump the datastructures (i.e. they are not in the middle
@@ -1785,7 +1790,6 @@ void Solver::interruptCleanly()
         dumpOrigClauses(origFilename);
         std::cout << "c Simplified original clauses dumped to file '" << origFilename << "'" << std::endl;
     }
-    exit(0);
 }
 
 
@@ -1825,7 +1829,11 @@ lbool Solver::search(int nof_conflicts, int nof_conflicts_fullrestart, const boo
     testAllClauseAttach();
     findAllAttach();
     for (;;) {
-        if (needToInterrupt) interruptCleanly();
+        if (needToInterrupt || conflicts >= maxConflicts) {
+            if (needToInterrupt) interruptCleanly();
+            cancelUntil(0);
+            return l_Undef;
+        }
         PropagatedFrom confl = propagate(update);
 
         if (!confl.isNULL()) {
@@ -2374,7 +2382,8 @@ lbool Solver::solve(const vec<Lit>& assumps)
     printRestartStat("B");
     uint64_t lastConflPrint = conflicts;
     // Search:
-    while (status == l_Undef && starts < maxRestarts) {
+    while (status == l_Undef && starts < maxRestarts
+           && !needToInterrupt && conflicts < maxConflicts) {
         #ifdef DEBUG_VARELIM
         assert(subsumer->checkElimedUnassigned());
         assert(xorSubsumer->checkElimedUnassigned());
@@ -2403,6 +2412,7 @@ lbool Solver::solve(const vec<Lit>& assumps)
         status = search(nof_conflicts, nof_conflicts_fullrestart);
         nof_conflicts = (double)nof_conflicts * restart_inc;
         if (status != l_Undef) break;
+        if (restartCallback != NULL) restartCallback(restartCallbackData);
         if (!checkFullRestart(nof_conflicts, nof_conflicts_fullrestart, lastFullRestart))
             return l_False;
         if (!chooseRestartType(lastFullRestart))
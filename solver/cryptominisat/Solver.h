@@ -26,6 +26,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <string.h>
 #include <stdio.h>
 #include <stack>
+#include <atomic>
 
 #ifdef _MSC_VER
 #include <msvc/stdint.h>
@@ -137,6 +138,7 @@ public:
     // Variable mode:
     //
     void    setDecisionVar (Var v, bool b);         ///<Declare if a variable should be eligible for selection in the decision heuristic.
+    void    setPolarity    (Var v, bool b);         ///<Declare which polarity the decision heuristic should use for a variable ('b' is the sign, i.e. TRUE means a FALSE value). Requires mode 'polarity_user'.
     void    setSeed (const uint32_t seed);          ///<Sets the seed to be the given number
     void    setMaxRestarts(const uint32_t num);     ///<sets the maximum number of restarts to given value
 
@@ -165,7 +167,7 @@ public:
     double    learntsize_factor;  ///<The intitial limit for learnt clauses is a factor of the original clauses.                (default 1 / 3)
     double    learntsize_inc;     ///<The limit for learnt clauses is multiplied with this factor each restart.                 (default 1.1)
     bool      expensive_ccmin;    ///<Should clause minimisation by Sorensson&Biere be used?                                    (default TRUE)
-    int       polarity_mode;      ///<Controls which polarity the decision heuristic chooses. Auto means Jeroslow-Wang          (default: polarity_auto)
+    int       polarity_mode;      ///<Controls which polarity the decision heuristic chooses. Auto means Jeroslow-Wang, user keeps the polarities set by setPolarity() and the saved phases          (default: polarity_auto)
     int       verbosity;          ///<Verbosity level. 0=silent, 1=some progress report, 2=lots of report, 3 = all report       (default 2)
     Var       restrictedPickBranch;///<Pick variables to branch on preferentally from the highest [0, restrictedPickBranch]. If set to 0, preferentiality is turned off (i.e. picked randomly between [0, all])
     bool      findNormalXors;     ///<Automatically find non-binary xor clauses and convert them to xor clauses
@@ -193,9 +195,12 @@ public:
     bool      regRemUselessBins;  ///<Should try to remove useless binary clauses regularly?
     bool      subsWNonExistBins;  ///<Try to do subsumption and self-subsuming resolution with non-existent binary clauses (i.e. binary clauses that don't exist but COULD exists)
     bool      regSubsWNonExistBins;
-    bool      needToInterrupt;    ///<Used internally mostly. If set to TRUE, we will interrupt cleanly ASAP. The important thing is "cleanly", since we need to wait until a point when all datastructures are in a sane state (i.e. not in the middle of some algorithm)
+    std::atomic<bool> needToInterrupt; ///<Used internally mostly. It can be set by another thread. If set to TRUE, we will interrupt cleanly ASAP. The important thing is "cleanly", since we need to wait until a point when all datastructures are in a sane state (i.e. not in the middle of some algorithm)
     bool      needToDumpLearnts;  ///<If set to TRUE, learnt clauses will be dumped to the file speified by "learntsFilename"
     bool      needToDumpOrig;     ///<If set to TRUE, a simplified version of the original clause-set will be dumped to the file speified by "origFilename". The solution to this file should perfectly satisfy the problem
+    void    (*restartCallback)(void* data); ///<If not NULL, it is called (with "restartCallbackData") after each restart, e.g. to report the progress of the search
+    void*     restartCallbackData; ///<The argument passed to "restartCallback"
+    uint64_t  maxConflicts;       ///<The search is interrupted (and l_Undef is returned) as soon as the number of conflicts reaches this value
     char*     learntsFilename;    ///<Dump sorted learnt clauses to this file. Only active if "needToDumpLearnts" is set to TRUE
     char*     origFilename;       ///<Dump simplified original problem CNF to this file. Only active if "needToDumpOrig" is set to TRUE
     uint32_t  maxDumpLearntsSize; ///<When dumping the learnt clauses, this is the maximum clause size that should be dumped
@@ -204,7 +209,7 @@ public:
     RestartType fixRestartType;   ///<If set, the solver will always choose the given restart strategy instead of automatically trying to guess a strategy. Note that even if set to dynamic_restart, there will be a few restarts made statically after each full restart.
     GaussianConfig gaussconfig;   ///<Configuration for the gaussian elimination can be set here
 
-    enum { polarity_true = 0, polarity_false = 1, polarity_rnd = 3, polarity_auto = 4};
+    enum { polarity_true = 0, polarity_false = 1, polarity_rnd = 3, polarity_auto = 4, polarity_user = 5};
 
     // Statistics: (read-only member variable)
     //
@@ -267,6 +272,7 @@ public:
     const vector<Lit> get_unitary_learnts() const; //return the set of unitary learnt clauses
     const uint32_t get_unitary_learnts_num() const; //return the number of unitary learnt clauses
     void dumpSortedLearnts(const char* file, const uint32_t maxSize); // Dumps all learnt clauses (including unitary ones) into the file
+    void getLearntClauses(vector<vector<Lit> >& out, const uint32_t maxSize) const; // Gets the clauses dumped by dumpSortedLearnts (not sorted)
     void needLibraryCNFFile(const char* fileName); //creates file in current directory with the filename indicated, and puts all calls from the library into the file.
     void dumpOrigClauses(const char* fileName, const bool alsoLearntBin = false) const;
 
@@ -299,6 +305,8 @@ public:
     */
     const double   getTotalTimeXorSubsumer() const;
 
+    const RestartType getRestartType() const;       ///<Get the restart strategy currently in use
+
 protected:
     #ifdef USE_GAUSS
     void print_gauss_sum_stats();
@@ -544,7 +552,6 @@ protected:
     bool defaultPolarity(); //if polarity_mode is not polarity_auto, this returns the default polarity of the variable
     void tallyVotes(const vec<Clause*>& cs, vector<double>& votes) const;
     void tallyVotes(const vec<XorClause*>& cs, vector<double>& votes) const;
-    void setPolarity(Var v, bool b); // Declare which polarity the decision heuristic should use for a variable. Requires mode 'polarity_user'.
     vector<bool> polarity;      // The preferred polarity of each variable.
     #ifdef USE_OLD_POLARITIES
     vector<bool> oldPolarity;   // The polarity before the last setting. Good for unsetting polairties that have been changed since the last conflict
@@ -658,6 +665,10 @@ inline uint32_t      Solver::nLiterals      ()      const
 {
     return clauses_literals + learnts_literals;
 }
+inline const RestartType Solver::getRestartType() const
+{
+    return restartType;
+}
 inline uint32_t      Solver::nLearnts      ()      const
 {
     return learnts.size();
@@ -96,6 +96,44 @@ void Solver::dumpSortedLearnts(const char* fileName, const uint32_t maxSize)
     fclose(outfile);
 }
 
+void Solver::getLearntClauses(vector<vector<Lit> >& out, const uint32_t maxSize) const
+{
+    out.clear();
+    for (uint32_t i = 0, end = (trail_lim.size() > 0) ? trail_lim[0] : trail.size() ; i < end; i++) {
+        out.push_back(vector<Lit>(1, trail[i]));
+    }
+    if (maxSize == 1) return;
+
+    for (uint32_t i = 0; i != binaryClauses.size(); i++) {
+        const Clause& c = *binaryClauses[i];
+        if (c.learnt()) {
+            out.push_back(vector<Lit>(c.getData(), c.getData() + c.size()));
+        }
+    }
+
+    const vector<Lit>& table = varReplacer->getReplaceTable();
+    for (Var var = 0; var != table.size(); var++) {
+        Lit lit = table[var];
+        if (lit.var() == var)
+            continue;
+
+        vector<Lit> cl(2);
+        cl[0] = ~lit;
+        cl[1] = Lit(var, false);
+        out.push_back(cl);
+        cl[0] = lit;
+        cl[1] = Lit(var, true);
+        out.push_back(cl);
+    }
+
+    for (uint32_t i = 0; i != learnts.size(); i++) {
+        const Clause& c = *learnts[i];
+        if (c.size() <= maxSize) {
+            out.push_back(vector<Lit>(c.getData(), c.getData() + c.size()));
+        }
+    }
+}
+
 void Solver::dumpOrigClauses(const char* fileName, const bool alsoLearntBin) const
 {
     FILE* outfile = fopen(fileName, "w");
@@ -25,6 +25,11 @@
  *
  **/
 #include "zrhc_app.hpp"
+#include "run_stats.hpp"
+#include "runtime_model.hpp"
+#include "result_cache.hpp"
+#include "external_solver.hpp"
+#include "solve_server.hpp"
 
 #include "configuration.h"
 
@@ -35,16 +40,24 @@
 
 #include <iostream>
 #include <fstream>
+#include <cmath>
 
 #include <boost/static_assert.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #ifndef EXIT_NO_ZRHC
 #define EXIT_NO_ZRHC (2)
 #endif
 
+#ifndef EXIT_SOLVER_UNDEF
+#define EXIT_SOLVER_UNDEF (3)
+#endif
+
 BOOST_STATIC_ASSERT(EXIT_FAILURE != EXIT_NO_ZRHC);
+BOOST_STATIC_ASSERT(EXIT_FAILURE != EXIT_SOLVER_UNDEF);
+BOOST_STATIC_ASSERT(EXIT_NO_ZRHC != EXIT_SOLVER_UNDEF);
 
 using namespace std;
 
@@ -60,6 +73,170 @@ public:
 
 private:
 
+// Report the size of the SAT instance of the pedigree, the memory needed
+// to solve it and (with a runtime model) the time needed to encode and
+// solve it, without encoding the pedigree
+  int dry_run(const po::variables_map& vm,
+				  const zrhcstar_t& zrhcstar,
+				  const zrhcstar_t::pedigree_t& ped) const {
+	 const instance_estimate_t e= zrhcstar.predict_sat(ped);
+	 run_stats_t& rs= run_stats_t::get_run_stats();
+	 rs.set_counter("predicted_variables", (long long)e.variables);
+	 rs.set_counter("predicted_clauses", (long long)e.clauses);
+	 rs.set_counter("predicted_xor_clauses", (long long)e.xor_clauses);
+	 rs.set_counter("predicted_memory_mb", (long long)ceil(e.memory_mb));
+	 INFO("The SAT instance would have " << (size_t)e.variables <<
+			" variables, " << (size_t)e.clauses << " clauses, and " <<
+			(size_t)e.xor_clauses << " xor-clauses.");
+	 INFO("Estimated memory to encode and solve it: " <<
+			(size_t)ceil(e.memory_mb) << "MB.");
+	 if (vm.count("runtime-model")) {
+		runtime_model_t model;
+		{
+		  file_utility::pistream model_is=
+			 file_utility::get_file_utility().
+			 get_ifstream(vm["runtime-model"].as<string>(), false);
+		  model.load(*model_is);
+		}
+		const double seconds= model.predict(e);
+		rs.set_counter("predicted_time_ms", (long long)(seconds * 1000.0));
+		INFO("Estimated time to encode and solve it: " << seconds <<
+			  "s (according to a model fitted on " << model.no_of_runs() <<
+			  " runs).");
+	 }
+	 INFO("Exiting without encoding the pedigree.");
+	 return EXIT_SUCCESS;
+  }
+
+// Fit the runtime model on the runs whose statistics have been saved
+// with '--stats-json'
+  int fit_runtime_model(const po::variables_map& vm) const {
+	 const vector<string>& files=
+		vm["fit-runtime-model"].as< vector<string> >();
+	 INFO("Fitting the runtime model on " << files.size() <<
+			" recorded runs...");
+	 vector<recorded_run_t> runs;
+	 BOOST_FOREACH( const string& file, files ) {
+		file_utility::pistream run_is=
+		  file_utility::get_file_utility().get_ifstream(file, false);
+		recorded_run_t run;
+		if (read_recorded_run(*run_is, run)) {
+		  runs.push_back(run);
+		} else {
+		  INFO("The run of file '" << file << "' has not solved a SAT "
+				 "instance and it is not used.");
+		}
+	 }
+	 runtime_model_t model;
+	 model.fit(runs);
+	 file_utility::postream model_os=
+		file_utility::get_file_utility().
+		get_ofstream(vm["runtime-model"].as<string>(), false);
+	 model.save(*model_os);
+	 INFO("Runtime model successfully saved to file '" <<
+			vm["runtime-model"].as<string>() << "'.");
+	 return EXIT_SUCCESS;
+  }
+
+#ifdef INTERNAL_SAT_SOLVER
+  int solver_interrupted() const {
+	 INFO("The internal SAT solver has been interrupted before deciding if "
+			"a Zero-Recombinant Haplotype Configuration exists. "
+			"Exiting without haplotype configuration.");
+	 return EXIT_SOLVER_UNDEF;
+  }
+
+// Solve the SAT instance of file '--sat' and save the result in file
+// '--result'
+  int execute_sat_solving(const po::variables_map& vm,
+								  const zrhcstar_t& zrhcstar) {
+	 INFO("Solving the SAT instance of file '" << vm["sat"].as<string>() <<
+			"' with the internal SAT solver...");
+	 SAT_solver_iface_t::handle_signals();
+	 std::ofstream res_os(vm["result"].as<string>().c_str());
+	 const string status= zrhcstar.solve_SAT_instance(vm["sat"].as<string>(),
+																	 res_os);
+	 res_os.close();
+	 if (!res_os) {
+		ERROR("Impossible to save the result in file '" <<
+				vm["result"].as<string>() << "'.");
+		return EXIT_FAILURE;
+	 }
+	 if (status == "SAT") {
+		INFO("The SAT instance is satisfiable. Result successfully saved.");
+		return EXIT_SUCCESS;
+	 } else if (status == "UNSAT") {
+		INFO("The SAT instance is not satisfiable. Result successfully saved.");
+		return EXIT_NO_ZRHC;
+	 }
+	 return solver_interrupted();
+  }
+
+// Serve the requests on the socket or on the standard input/output
+  int execute_server(const po::variables_map& vm,
+							const zrhcstar_t& zrhcstar) {
+	 solve_server_t server(zrhcstar, vm["threads"].as<unsigned int>(),
+								  vm["max-request-size"].as<size_t>() * 1024 * 1024,
+								  vm["max-connections"].as<size_t>());
+	 if (vm.count("socket")) {
+		server.serve_socket(vm["socket"].as<string>());
+	 } else {
+// The responses are written on the original standard output, while
+// anything else written on it (such as log messages) is redirected to
+// the standard error
+		cout.flush();
+		const int out_fd= dup(STDOUT_FILENO);
+		if ((out_fd < 0) || (dup2(STDERR_FILENO, STDOUT_FILENO) < 0))
+		  throw logic_error("Impossible to redirect the standard output.");
+		namespace io= boost::iostreams;
+		io::stream<io::file_descriptor_sink> out(out_fd, io::close_handle);
+		INFO("Serving requests on the standard input/output...");
+		const size_t n_requests= server.serve(cin, out);
+		INFO("Served " << n_requests << " requests.");
+	 }
+	 return EXIT_SUCCESS;
+  }
+
+// Solve every pedigree file of the batch and write their status records
+  int execute_batch(const po::variables_map& vm,
+						  const zrhcstar_t& zrhcstar,
+						  const bool in_compress,
+						  const bool out_compress) const {
+	 std::vector<string> inputs;
+	 zrhcstar_t::list_batch_inputs(vm["batch"].as<string>(), inputs);
+	 const boost::filesystem::path out_dir(vm["batch-output-dir"].as<string>());
+	 boost::filesystem::create_directories(out_dir);
+	 std::vector<zrhcstar_t::batch_job_t> jobs;
+	 jobs.reserve(inputs.size());
+	 BOOST_FOREACH( const string& input, inputs ) {
+		const string name= boost::filesystem::path(input).filename().string();
+		jobs.push_back(zrhcstar_t::batch_job_t(input,
+															(out_dir / ("hap-" + name)).string()));
+	 }
+	 zrhcstar.solve_batch(jobs, vm["threads"].as<unsigned int>(),
+								 in_compress, out_compress,
+								 vm["memory-budget"].as<double>());
+
+	 file_utility::postream status_os=
+		file_utility::get_file_utility().
+		get_ofstream(vm["batch-status"].as<string>(), false);
+	 zrhcstar_t::write_batch_status(*status_os, jobs);
+
+	 size_t n_errors= 0;
+	 BOOST_FOREACH( const zrhcstar_t::batch_job_t& job, jobs ) {
+		run_stats_t::get_run_stats().add_to_counter(string("batch_") + job.status, 1);
+		if (job.status == "ERROR")
+		  ++n_errors;
+	 }
+	 if (n_errors > 0) {
+		ERROR(n_errors << " pedigree files of the batch have NOT been processed.");
+		return EXIT_FAILURE;
+	 }
+	 INFO("All the pedigree files of the batch have been processed. "
+			"Their status is saved in file '" << vm["batch-status"].as<string>() << "'.");
+	 return EXIT_SUCCESS;
+  }
+#endif // INTERNAL_SAT_SOLVER
 
 protected:
 
@@ -80,6 +257,14 @@ protected:
 #ifdef INTERNAL_SAT_SOLVER
 		("solve-internal,4", po::bool_switch(),
 		 "Execute the integrated SAT solver.")
+		("solve-sat,5", po::bool_switch(),
+		 "Solve the SAT instance of file '--sat' (created by '--create', in "
+		 "the DIMACS format, possibly compressed and with xor-clauses, or in "
+		 "the binary format of '--binary-sat') with the integrated SAT solver "
+		 "and save the result in file '--result' (in the format read by "
+		 "'--read').  "
+		 "The budgets of the solver ('--max-conflicts', '--timeout', "
+		 "'--max-memory', and '--cancel-file') apply also to this mode.")
 #endif // INTERNAL_SAT_SOLVER
 		("pedigree,p",
 		 po::value< std::string >()->default_value("pedigree.ped"),
@@ -99,11 +284,139 @@ protected:
 		 "%%INPUT%% and %%OUTPUT%% are markers used to represent the input and the output file "
 		 "of the solver and they are automatically substituted by the program into the "
 		 "corresponding filenames.")
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+		("binary-sat", po::bool_switch()->default_value(false),
+		 "Save the SAT instance in a binary format (described in "
+		 "'include/binary_instance.hpp') that can be memory-mapped, instead of "
+		 "the DIMACS format.  The binary instance is never compressed.  "
+		 "Only for the '--create'/'-1' mode.")
+		("sat-pipe", po::bool_switch()->default_value(false),
+		 "Execute the SAT solver with pipes instead of temporary files: the SAT "
+		 "instance is written to the standard input of the solver and the "
+		 "result is read from its standard output, in the format of the SAT "
+		 "competitions ('s SATISFIABLE' and 'v' lines).  "
+		 "The markers %%INPUT%% and %%OUTPUT%% of '--sat-cmdline' are replaced "
+		 "by '/dev/stdin' and '/dev/stdout'.  "
+		 "Only for the '--create-read'/'-3' mode.")
+#endif // ONLY_INTERNAL_SAT_SOLVER
 		("generate-XORs,x", po::bool_switch()->default_value(false),
 		 "Use also xor-clauses for the description of the SAT instance. "
 		 "WARNING: The SAT solver **MUST** be able to understand rows such as "
 		 "'x1 2 -3 0' that corresponds to the formula "
 		 "'var1 XOR var2 XOR NOT var3'.")
+		("break-symmetries", po::bool_switch()->default_value(false),
+		 "Add constraints that fix the phase of each founder at its first "
+		 "heterozygous locus (it usually speeds up the solver on "
+		 "unsatisfiable instances).")
+		("inheritance-first", po::bool_switch()->default_value(false),
+		 "Number the inheritance (s) variables before the others, so that the "
+		 "SAT solver initially branches on them.")
+		("dedup-loci", po::bool_switch()->default_value(false),
+		 "Encode only one locus for each set of loci with the same genotypes "
+		 "and do not encode loci where every individual is genotyped and "
+		 "homozygous.  "
+		 "(If used, it must be specified also in the '--read'/'-2' mode.)")
+#ifdef INTERNAL_SAT_SOLVER
+		("window-size", po::value< size_t >()->default_value(0),
+		 "Split the loci into windows of the given size that are solved "
+		 "independently (the haplotype configuration is zero-recombinant "
+		 "only inside each window).  "
+		 "0 means that all the loci are solved at once.  "
+		 "Only for the '--solve-internal'/'-4' mode.")
+		("window-overlap", po::value< size_t >()->default_value(0),
+		 "The number of loci shared by two consecutive windows "
+		 "(used to stitch the phases of the founders).")
+		("block-size", po::value< size_t >()->default_value(0),
+		 "Encode and solve the loci incrementally in blocks of the given size "
+		 "(a single SAT solver is used, and the computation stops at the "
+		 "first block that makes the pedigree infeasible).  "
+		 "0 means that all the loci are encoded at once.  "
+		 "Only for the '--solve-internal'/'-4' mode.")
+		("check-loci", po::bool_switch()->default_value(false),
+		 "Before solving the whole pedigree, solve each locus independently "
+		 "of the others and stop if some locus is infeasible by itself.  "
+		 "Only for the '--solve-internal'/'-4' mode.")
+		("unsat-core", po::bool_switch()->default_value(false),
+		 "If the pedigree is infeasible, report a set of individuals and loci "
+		 "whose constraints make it infeasible (computed by the internal SAT "
+		 "solver with a single solve under assumptions).  "
+		 "Only for the '--solve-internal'/'-4' mode.")
+		("max-conflicts", po::value< uint64_t >()->default_value(0),
+		 "Interrupt each execution of the internal SAT solver after the given "
+		 "number of conflicts (0 means no limit).")
+		("timeout", po::value< double >()->default_value(0.0),
+		 "Interrupt each execution of the internal SAT solver after the given "
+		 "number of seconds (0 means no limit).  "
+		 "With '--batch', the limit applies to each pedigree file.")
+		("max-memory", po::value< size_t >()->default_value(0),
+		 "Interrupt the internal SAT solver when the program currently uses "
+		 "more than the given number of megabytes of memory (0 means no "
+		 "limit).  "
+		 "If the solver is interrupted, the program exits with code "
+		 BOOST_PP_STRINGIZE(EXIT_SOLVER_UNDEF) ".")
+		("cancel-file", po::value< std::string >(),
+		 "Interrupt the internal SAT solver as soon as the given file exists "
+		 "(the solver is also interrupted by SIGINT or SIGTERM).")
+		("solver-stats-interval", po::value< double >()->default_value(10.0),
+		 "The number of seconds between two reports of the search statistics "
+		 "of the internal SAT solver during long solves (0 disables the "
+		 "reports).  "
+		 "The statistics of the whole search are saved with '--stats-json'.")
+		("batch", po::value< std::string >(),
+		 "Solve every pedigree file listed in the given manifest (one file per "
+		 "line) or contained in the given directory, in a single process.  "
+		 "The haplotype configuration of each file is saved in "
+		 "'--batch-output-dir' (with prefix 'hap-') and a status record for "
+		 "each file is saved in '--batch-status'.  "
+		 "Only for the '--solve-internal'/'-4' mode.")
+		("batch-output-dir", po::value< std::string >()->default_value("."),
+		 "Directory where the haplotype configurations of the batch are saved.")
+		("batch-status", po::value< std::string >()->default_value("batch-status.txt"),
+		 "File storing the (tab-separated) status records of the batch.")
+		("memory-budget", po::value< double >()->default_value(0.0),
+		 "The number of megabytes of memory that the pedigree files of the "
+		 "batch solved at the same time can use, according to an estimate of "
+		 "their SAT instances (0 means no limit).  "
+		 "A pedigree file whose estimate exceeds the budget is solved alone.  "
+		 "It replaces '--max-memory', which is not allowed with '--batch'.")
+		("serve", po::bool_switch()->default_value(false),
+		 "Solve the pedigrees received as requests on the standard input "
+		 "(or on '--socket') until the end of the input, and write a response "
+		 "with the status and the haplotype configuration of each request on "
+		 "the standard output (or on the socket).  "
+		 "The requests are solved concurrently on '--threads' threads.  "
+		 "See 'include/solve_server.hpp' for the protocol.  "
+		 "Only for the '--solve-internal'/'-4' mode.")
+		("socket", po::value< std::string >(),
+		 "Serve the connections to the given Unix domain socket (until SIGINT "
+		 "or SIGTERM) instead of the standard input/output.")
+		("max-request-size", po::value< size_t >()->default_value(64),
+		 "The maximum size (in megabytes) of the pedigree of a request.  "
+		 "Larger requests get an 'ERROR' response.")
+		("max-connections", po::value< size_t >()->default_value(64),
+		 "The maximum number of connections to the socket that are served at "
+		 "the same time (the others wait to be accepted).")
+		("cache-dir", po::value< std::string >(),
+		 "Directory of the result cache.  "
+		 "The result of each family (its haplotype configuration or the "
+		 "verdict that none exists) is looked for in the cache before "
+		 "encoding it, and it is stored in the cache after solving it.  "
+		 "The entries are keyed by the genotypes and the structure of the "
+		 "family and by the encoding options, and the cached haplotype "
+		 "configurations are verified before being used.  "
+		 "Only for the '--solve-internal'/'-4' mode (also with '--batch' "
+		 "and '--serve').")
+		("incremental-state", po::value< std::string >(),
+		 "File storing the state of the internal SAT solver between runs.  "
+		 "If the file has been saved for a pedigree with the same individuals, "
+		 "parents, and loci, only the constraints affected by the changed "
+		 "genotypes are encoded again and the previous learnt clauses and "
+		 "solution are reused.  The new state is then saved in the file.  "
+		 "Only for the '--solve-internal'/'-4' mode.")
+		("threads,t", po::value< unsigned int >()->default_value(0),
+		 "The number of threads used to solve the windows or the single loci "
+		 "(0 means all the available hardware threads).")
+#endif // INTERNAL_SAT_SOLVER
 		("compress,z", po::bool_switch()->default_value(false),
 		 "Use compressed input and output files.")
 		("compress-input", po::bool_switch()->default_value(false),
@@ -113,12 +426,48 @@ protected:
 		("keep,k", po::bool_switch()->default_value(false),
 		 "Keep temporary files (such as 'cnf-instance-*' and 'res-cnf-instance-*' "
 		 "files for '--create-read'/'-3' mode) after the execution.")
+		("stats-json", po::value< std::string >(),
+		 "File where the statistics of the run (running time and CPU time of "
+		 "each phase, peak memory usage, and size of the SAT instance) are "
+		 "saved in JSON format.")
+		("dry-run", po::bool_switch()->default_value(false),
+		 "Read the pedigree and report the size of its SAT instance and the "
+		 "memory (and, with '--runtime-model', the time) needed to solve it, "
+		 "without encoding the pedigree.")
+		("runtime-model", po::value< std::string >(),
+		 "File storing the model of the running time used by '--dry-run'.")
+		("fit-runtime-model", po::value< std::vector<std::string> >()->multitoken(),
+		 "Fit the model of the running time on the runs whose statistics have "
+		 "been saved (with '--stats-json') in the given files, save it in "
+		 "'--runtime-model', and exit.")
 		;
 	 return desc;
   };
 
   virtual int execution(int argc, char** argv,
 								const po::variables_map& vm) {
+	 run_stats_t& rs= run_stats_t::get_run_stats();
+	 rs.set_info("program", _name);
+	 rs.set_info("source_version", APPLICATION_SOURCE_VERSION);
+	 rs.set_info("pedigree", vm["pedigree"].as<string>());
+
+	 const int main_ris= execute_mode(argc, argv, vm);
+
+	 if (vm.count("stats-json")) {
+		INFO("Saving run statistics to file '" <<
+			  vm["stats-json"].as<string>() << "'...");
+		rs.set_counter("exit_status", main_ris);
+		file_utility::postream stats_os=
+		  file_utility::get_file_utility().
+		  get_ofstream(vm["stats-json"].as<string>(), false);
+		rs.write_json(*stats_os);
+		INFO("Run statistics successfully saved.");
+	 }
+	 return main_ris;
+  }
+
+  int execute_mode(int argc, char** argv,
+						 const po::variables_map& vm) {
 
 // Generate the help message and exit
 	 if (vm["help"].as<bool>()) {
@@ -127,6 +476,11 @@ protected:
 		return EXIT_SUCCESS;
 	 }
 
+	 if (vm.count("fit-runtime-model")) {
+		option_dependency(vm, "fit-runtime-model", "runtime-model");
+		return fit_runtime_model(vm);
+	 }
+
 	 int main_ris= EXIT_SUCCESS;
 
 // Check parameter values
@@ -135,10 +489,11 @@ protected:
 	 mode_options(vm, "create", "read", "create-read");
 #endif
 #if defined(INTERNAL_SAT_SOLVER) && !defined(ONLY_INTERNAL_SAT_SOLVER)
-	 mode_options(vm, "create", "read", "create-read", "solve-internal");
+	 mode_options(vm, "create", "read", "create-read", "solve-internal",
+					  "solve-sat");
 #endif
 #if defined(ONLY_INTERNAL_SAT_SOLVER)
-	 mode_options(vm, "solve-internal");
+	 mode_options(vm, "solve-internal", "solve-sat");
 #endif
 #ifndef ONLY_INTERNAL_SAT_SOLVER
 	 conflicting_options(vm, "create", "read");
@@ -152,16 +507,84 @@ protected:
 	 option_dependency(vm, "create-read", "pedigree");
 	 option_dependency(vm, "create-read", "haplotypes");
 	 option_dependency(vm, "create-read", "sat-cmdline");
+	 option_dependency(vm, "sat-pipe", "create-read");
+	 option_dependency(vm, "binary-sat", "create");
+	 conflicting_options(vm, "binary-sat", "compress");
+	 conflicting_options(vm, "binary-sat", "compress-output");
+	 conflicting_options(vm, "dry-run", "read");
 #endif
 #ifdef INTERNAL_SAT_SOLVER
 #ifndef ONLY_INTERNAL_SAT_SOLVER
 	 conflicting_options(vm, "solve-internal", "create");
 	 conflicting_options(vm, "solve-internal", "read");
 	 conflicting_options(vm, "solve-internal", "create-read");
+	 conflicting_options(vm, "solve-sat", "create");
+	 conflicting_options(vm, "solve-sat", "read");
+	 conflicting_options(vm, "solve-sat", "create-read");
 #endif
-	 option_dependency(vm, "solve-internal", "pedigree");
-	 option_dependency(vm, "solve-internal", "haplotypes");
+	 conflicting_options(vm, "solve-sat", "solve-internal");
+	 option_dependency(vm, "solve-sat", "sat");
+	 option_dependency(vm, "solve-sat", "result");
+	 if (!vm.count("batch") && !vm["serve"].as<bool>()) {
+		option_dependency(vm, "solve-internal", "pedigree");
+		option_dependency(vm, "solve-internal", "haplotypes");
+	 }
+	 option_dependency(vm, "window-size", "solve-internal");
+	 option_dependency(vm, "window-overlap", "window-size");
+	 option_dependency(vm, "block-size", "solve-internal");
+	 option_dependency(vm, "check-loci", "solve-internal");
+	 option_dependency(vm, "unsat-core", "solve-internal");
+	 option_dependency(vm, "max-conflicts", "solve-internal", "solve-sat");
+	 option_dependency(vm, "timeout", "solve-internal", "solve-sat");
+	 option_dependency(vm, "max-memory", "solve-internal", "solve-sat");
+	 option_dependency(vm, "cancel-file", "solve-internal", "solve-sat");
+	 option_dependency(vm, "batch", "solve-internal");
+	 option_dependency(vm, "batch-output-dir", "batch");
+	 option_dependency(vm, "batch-status", "batch");
+	 option_dependency(vm, "memory-budget", "batch");
+	 option_dependency(vm, "serve", "solve-internal");
+	 option_dependency(vm, "socket", "serve");
+	 option_dependency(vm, "max-request-size", "serve");
+	 option_dependency(vm, "max-connections", "socket");
+	 option_dependency(vm, "cache-dir", "solve-internal");
+	 conflicting_options(vm, "cache-dir", "window-size");
+	 conflicting_options(vm, "cache-dir", "block-size");
+	 conflicting_options(vm, "cache-dir", "unsat-core");
+	 option_dependency(vm, "incremental-state", "solve-internal");
+	 conflicting_options(vm, "incremental-state", "window-size");
+	 conflicting_options(vm, "incremental-state", "block-size");
+	 conflicting_options(vm, "incremental-state", "unsat-core");
+	 conflicting_options(vm, "incremental-state", "check-loci");
+	 conflicting_options(vm, "incremental-state", "dedup-loci");
+	 conflicting_options(vm, "incremental-state", "batch");
+	 conflicting_options(vm, "incremental-state", "serve");
+	 conflicting_options(vm, "incremental-state", "cache-dir");
+	 conflicting_options(vm, "incremental-state", "dry-run");
+	 conflicting_options(vm, "serve", "batch");
+	 conflicting_options(vm, "serve", "window-size");
+	 conflicting_options(vm, "serve", "block-size");
+	 conflicting_options(vm, "serve", "check-loci");
+	 conflicting_options(vm, "serve", "unsat-core");
+	 conflicting_options(vm, "serve", "timeout");
+	 conflicting_options(vm, "serve", "max-memory");
+	 conflicting_options(vm, "serve", "dry-run");
+	 conflicting_options(vm, "batch", "window-size");
+	 conflicting_options(vm, "batch", "block-size");
+	 conflicting_options(vm, "batch", "check-loci");
+	 conflicting_options(vm, "batch", "unsat-core");
+	 conflicting_options(vm, "batch", "max-memory");
+	 conflicting_options(vm, "unsat-core", "window-size");
+	 conflicting_options(vm, "unsat-core", "block-size");
+	 conflicting_options(vm, "unsat-core", "dedup-loci");
+	 conflicting_options(vm, "block-size", "window-size");
+	 conflicting_options(vm, "dedup-loci", "window-size");
+	 conflicting_options(vm, "dedup-loci", "block-size");
+	 conflicting_options(vm, "dry-run", "batch");
+	 conflicting_options(vm, "dry-run", "window-size");
+	 conflicting_options(vm, "dry-run", "block-size");
+	 conflicting_options(vm, "dry-run", "unsat-core");
 #endif
+	 option_dependency(vm, "runtime-model", "dry-run");
 	 DEBUG("Check completed.");
 
 	 const bool in_compress=
@@ -171,13 +594,99 @@ protected:
 		vm["compress"].as<bool>() ||
 		vm["compress-output"].as<bool>();
 
-	 zrhcstar_t zrhcstar(vm["generate-XORs"].as<bool>());
+#ifdef INTERNAL_SAT_SOLVER
+	 SAT_solver_iface_t::set_progress_interval(vm["solver-stats-interval"].as<double>());
+	 SAT_solver_iface_t::set_budgets(vm["max-conflicts"].as<uint64_t>(),
+												vm["timeout"].as<double>(),
+												vm["max-memory"].as<size_t>());
+	 if (vm.count("cancel-file")) {
+		SAT_solver_iface_t::set_cancel_file(vm["cancel-file"].as<string>());
+	 }
+	 if (vm["solve-internal"].as<bool>()) {
+// Stop the solver cleanly (and save the results obtained so far)
+		SAT_solver_iface_t::handle_signals();
+	 }
+#endif // INTERNAL_SAT_SOLVER
+
+	 zrhcstar_t zrhcstar(vm["generate-XORs"].as<bool>(),
+								vm["break-symmetries"].as<bool>(),
+								vm["inheritance-first"].as<bool>(),
+								vm["dedup-loci"].as<bool>());
 
 	 if (vm["generate-XORs"].as<bool>()) {
 		INFO("Use of XOR-clauses allowed.");
 	 } else {
 		INFO("Use of XOR-clauses NOT allowed.");
 	 }
+	 if (vm["break-symmetries"].as<bool>()) {
+		INFO("Symmetry-breaking constraints on founder phases enabled.");
+	 }
+	 if (vm["inheritance-first"].as<bool>()) {
+		INFO("Inheritance variables are numbered first.");
+	 }
+	 if (vm["dedup-loci"].as<bool>()) {
+		INFO("Equivalent and trivial loci are not encoded.");
+	 }
+
+#ifdef INTERNAL_SAT_SOLVER
+	 boost::scoped_ptr<result_cache_t> cache;
+	 if (vm.count("cache-dir")) {
+		cache.reset(new result_cache_t(vm["cache-dir"].as<string>(),
+												 zrhcstar.options_signature()));
+		zrhcstar.set_result_cache(cache.get());
+	 }
+#endif // INTERNAL_SAT_SOLVER
+
+#ifdef INTERNAL_SAT_SOLVER
+	 if (vm.count("batch")) {
+		INFO("Computation of the haplotype configurations of the pedigree "
+			  "files of batch '" << vm["batch"].as<string>() << "'...");
+		return execute_batch(vm, zrhcstar, in_compress, out_compress);
+	 }
+	 if (vm["serve"].as<bool>()) {
+		return execute_server(vm, zrhcstar);
+	 }
+	 if (vm["solve-sat"].as<bool>()) {
+		return execute_sat_solving(vm, zrhcstar);
+	 }
+#endif // INTERNAL_SAT_SOLVER
+
+// Read the pedigree and check its Mendelian consistency before encoding it
+// (the '--read' mode reads the pedigree together with the SAT results)
+	 zrhcstar_t::pedigree_t ped;
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+	 if (!vm["read"].as<bool>())
+#endif
+	 {
+		file_utility::pistream ped_is=
+		  file_utility::get_file_utility().
+		  get_ifstream(vm["pedigree"].as<string>(), in_compress);
+		zrhcstar.read_pedigree(*ped_is, ped);
+		if (!zrhcstar.is_mendelian_consistent(ped)) {
+		  INFO("No Zero-Recombinant Haplotype Configuration can exist since "
+				 "the pedigree has Mendelian errors. "
+				 "Exiting without encoding the pedigree.");
+		  return EXIT_NO_ZRHC;
+		}
+		if (vm["dry-run"].as<bool>()) {
+		  return dry_run(vm, zrhcstar, ped);
+		}
+	 }
+#ifdef INTERNAL_SAT_SOLVER
+	 if (vm["check-loci"].as<bool>()) {
+		std::vector<size_t> infeasible_loci;
+		std::vector<size_t> undecided_loci;
+		const bool feasible_loci=
+		  zrhcstar.find_infeasible_loci(ped, infeasible_loci, undecided_loci,
+												  vm["threads"].as<unsigned int>());
+		if (!feasible_loci) {
+		  INFO("No Zero-Recombinant Haplotype Configuration can exist since "
+				 "some loci are infeasible. "
+				 "Exiting without solving the whole pedigree.");
+		  return EXIT_NO_ZRHC;
+		}
+	 }
+#endif // INTERNAL_SAT_SOLVER
 
 // Dispatch the work depending on the program parameters
 #ifndef ONLY_INTERNAL_SAT_SOLVER
@@ -186,22 +695,35 @@ protected:
 		INFO("Creation of the SAT instance from the pedigree of file '"
 			  << vm["pedigree"].as<string>() << "'...");
 
-		file_utility::pistream ped_is=
-		  file_utility::get_file_utility().
-		  get_ifstream(vm["pedigree"].as<string>(), in_compress);
-		file_utility::postream sat_os=
-		  file_utility::get_file_utility().
-		  get_ofstream(vm["sat"].as<string>(), out_compress);
-		const std::string headers[] = {
-		  "SAT instance",
-		  std::string("pedigree: ") + vm["pedigree"].as<string>(),
-		  std::string("sat: ") + vm["sat"].as<string>(),
-		  std::string("source version: ") + APPLICATION_SOURCE_VERSION
-		};
-		zrhcstar.create_SAT_instance_from_pedigree(*ped_is,
-																 *sat_os,
-																 vector<string>(headers,
-																					 headers+4));
+		if (vm["binary-sat"].as<bool>()) {
+		  std::ofstream sat_os(vm["sat"].as<string>().c_str(),
+									  std::ios::out | std::ios::binary);
+		  pedcnf_t* cnf;
+		  zrhcstar.create_binary_SAT_instance(ped, sat_os, cnf);
+		  delete cnf;
+		  sat_os.close();
+		  if (!sat_os) {
+			 ERROR("Impossible to save the SAT instance in file '" <<
+					 vm["sat"].as<string>() << "'.");
+			 return EXIT_FAILURE;
+		  }
+		} else {
+		  file_utility::postream sat_os=
+			 file_utility::get_file_utility().
+			 get_ofstream(vm["sat"].as<string>(), out_compress);
+		  const std::string headers[] = {
+			 "SAT instance",
+			 std::string("pedigree: ") + vm["pedigree"].as<string>(),
+			 std::string("sat: ") + vm["sat"].as<string>(),
+			 std::string("source version: ") + APPLICATION_SOURCE_VERSION
+		  };
+		  pedcnf_t* cnf;
+		  zrhcstar.create_SAT_instance(ped, *sat_os,
+												 vector<string>(headers,
+																	 headers+4),
+												 cnf);
+		  delete cnf;
+		}
 
 		INFO("SAT instance successfully created and saved.");
 
@@ -236,20 +758,65 @@ protected:
 		  main_ris= EXIT_NO_ZRHC;
 		}
 
+	 } else if (vm["create-read"].as<bool>() &&
+					vm["sat-pipe"].as<bool>()) {
+		INFO("Computation of the haplotype configuration from the "
+			  "pedigree of file '"
+			  << vm["pedigree"].as<string>() << "' by invocation of the SAT solver "
+			  "through pipes...");
+		pedcnf_t* cnf;
+		zrhcstar.prepare_sat(ped, cnf);
+		const std::string headers[] = {
+		  "SAT instance",
+		  std::string("pedigree: ") + vm["pedigree"].as<string>(),
+		  std::string("source version: ") + APPLICATION_SOURCE_VERSION
+		};
+		INFO("Given command line: '"<< vm["sat-cmdline"].as<string>() << "'");
+		external_solver_t solver(vm["sat-cmdline"].as<string>());
+		bool decided;
+		phase_timer_t solving_timer("solving");
+		const bool ret_value= solver.solve(*cnf, vector<string>(headers, headers+3),
+													  decided);
+		solving_timer.stop();
+		if (!decided) {
+		  delete cnf;
+		  INFO("The SAT solver has not decided if a Zero-Recombinant Haplotype "
+				 "Configuration exists. Exiting without haplotype configuration.");
+		  return EXIT_SOLVER_UNDEF;
+		}
+		bool is_zrhc= false;
+		if (ret_value) {
+		  file_utility::postream hap_os=
+			 file_utility::get_file_utility().
+			 get_ofstream(vm["haplotypes"].as<string>(), out_compress);
+		  is_zrhc= zrhcstar.compute_HC_from_model_and_save(ped, cnf, *hap_os);
+		}
+		delete cnf;
+
+		if (is_zrhc) {
+		  INFO("Zero-Recombinant Haplotype Configuration successfully "
+				 "computed and saved.");
+		  main_ris= EXIT_SUCCESS;
+		} else if (ret_value) {
+		  ERROR("The assignment computed by the SAT solver does not give a "
+				  "valid haplotype configuration.");
+		  main_ris= EXIT_FAILURE;
+		} else {
+		  INFO("No Zero-Recombinant Haplotype Configuration can exist. "
+				 "Exiting without haplotype configuration.");
+		  main_ris= EXIT_NO_ZRHC;
+		}
+
 	 } else if (vm["create-read"].as<bool>()) {
 		INFO("Computation of the haplotype configuration from the "
 			  "pedigree of file '"
 			  << vm["pedigree"].as<string>() << "' by direct invocation of the SAT solver...");
 		string sat_name;
-		zrhcstar_t::pedigree_t ped;
 		pedcnf_t* cnf;
-// Block for reading the pedigree and writing the SAT instance
+// Block for writing the SAT instance
 // The block is needed to close the SAT instance stream before executing
 // the solver
 		{
-		  file_utility::pistream ped_is=
-			 file_utility::get_file_utility().
-			 get_ifstream(vm["pedigree"].as<string>(), in_compress);
 		  file_utility::postream sat_os=
 			 file_utility::get_file_utility().
 			 get_tmp_ostream("cnf-instance-XXXXXX", sat_name, out_compress);
@@ -259,10 +826,10 @@ protected:
 			 std::string("sat: ") + sat_name,
 			 std::string("source version: ") + APPLICATION_SOURCE_VERSION
 		  };
-		  zrhcstar.create_SAT_instance_from_pedigree(*ped_is, *sat_os,
-																	vector<string>(headers,
-																						headers+4),
-																	ped, cnf);
+		  zrhcstar.create_SAT_instance(ped, *sat_os,
+												 vector<string>(headers,
+																	 headers+4),
+												 cnf);
 		}
 
 // Execute the SAT solver
@@ -275,7 +842,9 @@ protected:
 		INFO("Real command line: '"<< cmdline <<"'");
 
 		boost::filesystem::remove(res_name);
+		phase_timer_t solving_timer("solving");
 		const int ret_value= system(cmdline.c_str());
+		solving_timer.stop();
 // We cannot trust the return value
 		DEBUG("The SAT solver returned: '" << ret_value << "'.");
 
@@ -322,28 +891,158 @@ protected:
 	 } else
 #endif
 #ifdef INTERNAL_SAT_SOLVER
-		if (vm["solve-internal"].as<bool>()) {
+		if (vm["solve-internal"].as<bool>() &&
+			 (vm["window-size"].as<size_t>() > 0)) {
+		INFO("Computation of the haplotype configuration from the "
+			  "pedigree of file '"
+			  << vm["pedigree"].as<string>() << "' by using the internal SAT solver "
+			  "on windows of " << vm["window-size"].as<size_t>() << " loci...");
+		const string status=
+		  zrhcstar.compute_HC_by_windows(ped,
+													vm["window-size"].as<size_t>(),
+													vm["window-overlap"].as<size_t>(),
+													vm["threads"].as<unsigned int>());
+		if (status == "ZRHC") {
+		  file_utility::postream hap_os=
+			 file_utility::get_file_utility().
+			 get_ofstream(vm["haplotypes"].as<string>(), out_compress);
+		  zrhcstar.save_ZRHC(ped, *hap_os);
+		  INFO("Haplotype configuration (zero-recombinant on each window) "
+				 "successfully computed and saved.");
+		  main_ris= EXIT_SUCCESS;
+		} else if (status == "UNDEF") {
+		  main_ris= solver_interrupted();
+		} else if (status == "NO_ZRHC") {
+		  INFO("No Haplotype Configuration that is zero-recombinant on each "
+				 "window can exist. Exiting without haplotype configuration.");
+		  main_ris= EXIT_NO_ZRHC;
+		} else {
+		  ERROR("The computed haplotype configuration is not valid.");
+		  main_ris= EXIT_FAILURE;
+		}
+
+	 } else if (vm["solve-internal"].as<bool>() &&
+					(vm["block-size"].as<size_t>() > 0)) {
+		INFO("Computation of the haplotype configuration from the "
+			  "pedigree of file '"
+			  << vm["pedigree"].as<string>() << "' by using the internal SAT solver "
+			  "incrementally on blocks of " << vm["block-size"].as<size_t>() << " loci...");
+		size_t no_of_feasible_loci;
+		const string status=
+		  zrhcstar.compute_HC_by_blocks(ped,
+												  vm["block-size"].as<size_t>(),
+												  no_of_feasible_loci);
+		if (status == "ZRHC") {
+		  file_utility::postream hap_os=
+			 file_utility::get_file_utility().
+			 get_ofstream(vm["haplotypes"].as<string>(), out_compress);
+		  zrhcstar.save_ZRHC(ped, *hap_os);
+		  INFO("Zero-Recombinant Haplotype Configuration successfully "
+				 "computed and saved.");
+		  main_ris= EXIT_SUCCESS;
+		} else if (status == "UNDEF") {
+		  main_ris= solver_interrupted();
+		} else if (status == "NO_ZRHC") {
+		  INFO("No Zero-Recombinant Haplotype Configuration can exist "
+				 "(only the first " << no_of_feasible_loci << " loci are feasible). "
+				 "Exiting without haplotype configuration.");
+		  main_ris= EXIT_NO_ZRHC;
+		} else {
+		  ERROR("The computed haplotype configuration is not valid.");
+		  main_ris= EXIT_FAILURE;
+		}
+
+	 } else if (vm["solve-internal"].as<bool>() &&
+					vm["unsat-core"].as<bool>()) {
+		INFO("Computation of the haplotype configuration from the "
+			  "pedigree of file '"
+			  << vm["pedigree"].as<string>() << "' by using the internal SAT solver "
+			  "(with the computation of an unsatisfiable core)...");
+		std::vector< std::pair<size_t, size_t> > core;
+		const string status= zrhcstar.compute_HC_with_unsat_core(ped, core);
+		if (status == "ZRHC") {
+		  file_utility::postream hap_os=
+			 file_utility::get_file_utility().
+			 get_ofstream(vm["haplotypes"].as<string>(), out_compress);
+		  zrhcstar.save_ZRHC(ped, *hap_os);
+		  INFO("Zero-Recombinant Haplotype Configuration successfully "
+				 "computed and saved.");
+		  main_ris= EXIT_SUCCESS;
+		} else if (status == "UNDEF") {
+		  main_ris= solver_interrupted();
+		} else if (status == "NO_ZRHC") {
+		  INFO("No Zero-Recombinant Haplotype Configuration can exist "
+				 "(because of the constraints of " << core.size() <<
+				 " (individual, locus) pairs). "
+				 "Exiting without haplotype configuration.");
+		  main_ris= EXIT_NO_ZRHC;
+		} else {
+		  ERROR("The computed haplotype configuration is not valid.");
+		  main_ris= EXIT_FAILURE;
+		}
+
+	 } else if (vm["solve-internal"].as<bool>() &&
+					vm.count("incremental-state")) {
+		INFO("Computation of the haplotype configuration from the "
+			  "pedigree of file '"
+			  << vm["pedigree"].as<string>() << "' by using the internal SAT solver "
+			  "incrementally (with state file '" <<
+			  vm["incremental-state"].as<string>() << "')...");
+		const string status=
+		  zrhcstar.compute_HC_incrementally(ped, vm["incremental-state"].as<string>());
+		if (status == "ZRHC") {
+		  file_utility::postream hap_os=
+			 file_utility::get_file_utility().
+			 get_ofstream(vm["haplotypes"].as<string>(), out_compress);
+		  zrhcstar.save_ZRHC(ped, *hap_os);
+		  INFO("Zero-Recombinant Haplotype Configuration successfully "
+				 "computed and saved.");
+		  main_ris= EXIT_SUCCESS;
+		} else if (status == "UNDEF") {
+		  main_ris= solver_interrupted();
+		} else if (status == "NO_ZRHC") {
+		  INFO("No Zero-Recombinant Haplotype Configuration can exist. "
+				 "Exiting without haplotype configuration.");
+		  main_ris= EXIT_NO_ZRHC;
+		} else {
+		  ERROR("The computed haplotype configuration is not valid.");
+		  main_ris= EXIT_FAILURE;
+		}
+
+	 } else if (vm["solve-internal"].as<bool>()) {
 		INFO("Computation of the haplotype configuration from the "
 			  "pedigree of file '"
 			  << vm["pedigree"].as<string>() << "' by using the internal SAT solver...");
-		zrhcstar_t::pedigree_t ped;
-		pedcnf_t* cnf;
-// Block for reading the pedigree and writing the SAT instance
-// The block is needed to close the SAT instance stream before executing
-// the solver
-		{
-		  file_utility::pistream ped_is=
+		string cache_key;
+		const string cached= zrhcstar.lookup_result(ped, cache_key);
+		if (cached == "ZRHC") {
+		  file_utility::postream hap_os=
 			 file_utility::get_file_utility().
-			 get_ifstream(vm["pedigree"].as<string>(), in_compress);
-		  zrhcstar.prepare_pedigree_and_sat(*ped_is,
-														ped, cnf);
+			 get_ofstream(vm["haplotypes"].as<string>(), out_compress);
+		  zrhcstar.save_ZRHC(ped, *hap_os);
+		  INFO("Zero-Recombinant Haplotype Configuration successfully "
+				 "read from the result cache and saved.");
+		  return EXIT_SUCCESS;
+		} else if (cached == "NO_ZRHC") {
+		  INFO("No Zero-Recombinant Haplotype Configuration can exist "
+				 "(according to the result cache). "
+				 "Exiting without haplotype configuration.");
+		  return EXIT_NO_ZRHC;
 		}
+		pedcnf_t* cnf;
+		zrhcstar.prepare_sat(ped, cnf);
 
 // Execute the SAT solver
 		INFO("Execution of the internal SAT solver...");
+		phase_timer_t solving_timer("solving");
 		const bool ret_value= cnf->solve();
+		solving_timer.stop();
 // We have to trust the return value
 		DEBUG("The SAT solver returned: '" << ret_value << "'.");
+		if (cnf->is_interrupted()) {
+		  delete cnf;
+		  return solver_interrupted();
+		}
 
 		file_utility::postream hap_os=
 		  file_utility::get_file_utility().
@@ -351,6 +1050,9 @@ protected:
 		bool is_zrhc= zrhcstar.compute_HC_from_model_and_save(ped, cnf,
 																				*hap_os);
 		delete cnf;
+		if (is_zrhc || !ret_value) {
+		  zrhcstar.store_result(cache_key, ped, is_zrhc);
+		}
 
 		if (is_zrhc) {
 		  INFO("Zero-Recombinant Haplotype Configuration successfully "
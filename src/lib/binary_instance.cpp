@@ -0,0 +1,257 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * binary_instance.cpp
+ *
+ * A binary format of the SAT instances that can be memory-mapped.
+ *
+ **/
+
+#include "binary_instance.hpp"
+#include "assertion.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/foreach.hpp>
+#include <boost/static_assert.hpp>
+
+BOOST_STATIC_ASSERT(sizeof(binary_instance_header_t) == 64);
+BOOST_STATIC_ASSERT(sizeof(boost::int32_t) == sizeof(int));
+
+const char binary_instance_t::MAGIC[8]= { 'Z', 'R', 'H', 'C', 'B', 'I', 'N', '\0' };
+const boost::uint32_t binary_instance_t::FORMAT_VERSION= 1;
+const boost::uint32_t binary_instance_t::BYTE_ORDER_MARK= 0x01020304;
+
+
+// Size of a section of 'size' bytes, padded to a multiple of 8 bytes
+static size_t
+padded(const size_t size) {
+  return (size + 7) & ~((size_t)7);
+}
+
+static void
+write_padding(std::ostream& out, const size_t size) {
+  static const char zeros[8]= { 0, 0, 0, 0, 0, 0, 0, 0 };
+  out.write(zeros, padded(size) - size);
+}
+
+template <typename T>
+static void
+write_value(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Write the offsets and the literals of a set of clauses
+static void
+write_clauses(std::ostream& out, const binary_instance_t::clauses_t& clauses) {
+  boost::uint64_t offset= 0;
+  write_value(out, offset);
+  BOOST_FOREACH( const binary_instance_t::clause_t& clause, clauses ) {
+	 offset += clause.size();
+	 write_value(out, offset);
+  }
+  std::vector<boost::int32_t> lits;
+  BOOST_FOREACH( const binary_instance_t::clause_t& clause, clauses ) {
+	 lits.assign(clause.begin(), clause.end());
+	 if (!lits.empty())
+		out.write(reinterpret_cast<const char*>(&lits[0]),
+					 lits.size()*sizeof(boost::int32_t));
+  }
+  write_padding(out, offset*sizeof(boost::int32_t));
+}
+
+static boost::uint32_t
+kind_index(const ped_var_kind& kind) {
+  boost::uint32_t i= 0;
+  while ((i < ped_var_kind::N_VALUES) && !(ped_var_kind::enum_values[i] == kind))
+	 ++i;
+  MY_ASSERT( i < ped_var_kind::N_VALUES );
+  return i;
+}
+
+static boost::uint64_t
+no_of_lits(const binary_instance_t::clauses_t& clauses) {
+  boost::uint64_t n= 0;
+  BOOST_FOREACH( const binary_instance_t::clause_t& clause, clauses ) {
+	 n += clause.size();
+  }
+  return n;
+}
+
+void
+binary_instance_t::write(std::ostream& out,
+								 const pedcnf_t::varvec_t& vars,
+								 const clauses_t& clauses,
+								 const clauses_t& xor_clauses) {
+  binary_instance_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version= FORMAT_VERSION;
+  header.byte_order= BYTE_ORDER_MARK;
+  header.no_of_vars= vars.size();
+  header.no_of_clauses= clauses.size();
+  header.no_of_clause_lits= no_of_lits(clauses);
+  header.no_of_xor_clauses= xor_clauses.size();
+  header.no_of_xor_lits= no_of_lits(xor_clauses);
+  write_value(out, header);
+  BOOST_FOREACH( const pedcnf_t::pedvar_t& var, vars ) {
+	 MY_ASSERT( var.get<1>() <= 0xFFFFFFFFu );
+	 MY_ASSERT( var.get<2>() <= 0xFFFFFFFFu );
+	 const boost::uint32_t record[3]= {
+		kind_index(var.get<0>()),
+		(boost::uint32_t)var.get<1>(),
+		(boost::uint32_t)var.get<2>()
+	 };
+	 out.write(reinterpret_cast<const char*>(record), sizeof(record));
+  }
+  write_padding(out, vars.size()*3*sizeof(boost::uint32_t));
+  write_clauses(out, clauses);
+  write_clauses(out, xor_clauses);
+}
+
+
+bool
+binary_instance_t::is_binary_instance(const std::string& file_name) {
+  std::ifstream in(file_name.c_str(), std::ios::binary);
+  char magic[sizeof(MAGIC)];
+  return in.read(magic, sizeof(magic)) &&
+	 (memcmp(magic, MAGIC, sizeof(MAGIC)) == 0);
+}
+
+
+// Check that the offsets are non-decreasing and end at 'no_of_lits'
+static bool
+valid_offsets(const boost::uint64_t* offsets, const size_t n,
+				  const boost::uint64_t no_of_lits) {
+  if (offsets[0] != 0)
+	 return false;
+  for (size_t i= 0; i < n; ++i) {
+	 if (offsets[i+1] < offsets[i])
+		return false;
+  }
+  return offsets[n] == no_of_lits;
+}
+
+binary_instance_t::binary_instance_t(const std::string& file_name)
+	 :_file(file_name)
+{
+  L_DEBUG("Mapping the binary SAT instance '" << file_name << "'...");
+  const std::string error= "File '" + file_name + "' is not a valid binary SAT instance: ";
+  if (_file.size() < sizeof(binary_instance_header_t)) {
+	 throw std::logic_error(error + "it is too short.");
+  }
+  _header= reinterpret_cast<const binary_instance_header_t*>(_file.data());
+  if (memcmp(_header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+	 throw std::logic_error(error + "wrong magic number.");
+  }
+  if (_header->version != FORMAT_VERSION) {
+	 throw std::logic_error(error + "unsupported version " +
+									tostr(_header->version) + ".");
+  }
+  if (_header->byte_order != BYTE_ORDER_MARK) {
+	 throw std::logic_error(error + "it has been written by a machine with a "
+									"different byte order.");
+  }
+// Check the size before computing the addresses of the sections
+  const boost::uint64_t max_elements= _file.size() / 4;
+  if ((_header->no_of_vars > max_elements) ||
+		(_header->no_of_clauses > max_elements) ||
+		(_header->no_of_clause_lits > max_elements) ||
+		(_header->no_of_xor_clauses > max_elements) ||
+		(_header->no_of_xor_lits > max_elements)) {
+	 throw std::logic_error(error + "wrong size.");
+  }
+  const char* p= _file.data() + sizeof(binary_instance_header_t);
+  _vars= reinterpret_cast<const boost::uint32_t*>(p);
+  p += padded(_header->no_of_vars*3*sizeof(boost::uint32_t));
+  _clause_offsets= reinterpret_cast<const boost::uint64_t*>(p);
+  p += (_header->no_of_clauses+1)*sizeof(boost::uint64_t);
+  _clause_lits= reinterpret_cast<const boost::int32_t*>(p);
+  p += padded(_header->no_of_clause_lits*sizeof(boost::int32_t));
+  _xor_offsets= reinterpret_cast<const boost::uint64_t*>(p);
+  p += (_header->no_of_xor_clauses+1)*sizeof(boost::uint64_t);
+  _xor_lits= reinterpret_cast<const boost::int32_t*>(p);
+  p += padded(_header->no_of_xor_lits*sizeof(boost::int32_t));
+  if ((size_t)(p - _file.data()) != _file.size()) {
+	 throw std::logic_error(error + "wrong size.");
+  }
+  if (!valid_offsets(_clause_offsets, _header->no_of_clauses,
+							_header->no_of_clause_lits) ||
+		!valid_offsets(_xor_offsets, _header->no_of_xor_clauses,
+							_header->no_of_xor_lits)) {
+	 throw std::logic_error(error + "wrong clause offsets.");
+  }
+  L_DEBUG("Binary SAT instance mapped: " << no_of_vars() << " variables, " <<
+			 no_of_clauses() << " clauses, and " << no_of_xor_clauses() <<
+			 " xor-clauses.");
+}
+
+pedcnf_t::pedvar_t
+binary_instance_t::var(const size_t i) const {
+  MY_ASSERT( i < no_of_vars() );
+  const boost::uint32_t* record= _vars + 3*i;
+  MY_ASSERT( record[0] < ped_var_kind::N_VALUES );
+  return boost::make_tuple(ped_var_kind::enum_values[record[0]],
+								  (size_t)record[1], (size_t)record[2]);
+}
+
+#ifdef INTERNAL_SAT_SOLVER
+
+// Check that the literals are variables of the instance
+static void
+check_literals(const boost::int32_t* begin, const boost::int32_t* end,
+					const boost::int64_t no_of_vars) {
+  for (; begin != end; ++begin) {
+	 const boost::int64_t lit= *begin;
+	 if ((lit == 0) || (lit > no_of_vars) || (-lit > no_of_vars)) {
+		throw std::logic_error("The binary SAT instance contains the "
+									  "not-existent literal " + tostr(lit) + ".");
+	 }
+  }
+}
+
+void
+binary_instance_t::load(SAT_solver_iface_t& solver) const {
+  L_DEBUG("Loading the binary SAT instance into the solver...");
+  const boost::int64_t n_vars= no_of_vars();
+  check_literals(_clause_lits, _clause_lits + _header->no_of_clause_lits, n_vars);
+  check_literals(_xor_lits, _xor_lits + _header->no_of_xor_lits, n_vars);
+  solver.reserve_vars(no_of_vars());
+  for (size_t i= 0; i < no_of_clauses(); ++i) {
+	 solver.add_clause(clause_begin(i), clause_end(i) - clause_begin(i));
+  }
+  for (size_t i= 0; i < no_of_xor_clauses(); ++i) {
+	 solver.add_xor_clause(xor_clause_begin(i),
+								  xor_clause_end(i) - xor_clause_begin(i));
+  }
+  L_DEBUG("Binary SAT instance loaded.");
+}
+
+#endif // INTERNAL_SAT_SOLVER
@@ -0,0 +1,145 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * clause_buffer.cpp
+ *
+ * Structures to store clauses in a flat array of literals and to check
+ * quickly if an assignment satisfies them.
+ *
+ **/
+
+#include "clause_buffer.hpp"
+#include "parallel.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#include <boost/foreach.hpp>
+
+
+void
+clause_buffer_t::add_clause(const std::set<int>& clause) {
+  BOOST_FOREACH( const int lit, clause ) {
+	 MY_ASSERT_DBG( lit != 0 );
+	 _lits.push_back(lit);
+  }
+  _lits.push_back(0);
+  ++_no_of_clauses;
+};
+
+inline bool
+clause_buffer_t::is_satisfied(const int* clause,
+										const value_table_t& vals) const {
+  if (_xor_clauses) {
+	 unsigned char parity= 0;
+	 for (; *clause != 0; ++clause) {
+		parity ^= (*clause > 0) ? vals[*clause] : (1 ^ vals[-*clause]);
+	 }
+	 return parity != 0;
+  } else {
+	 for (; *clause != 0; ++clause) {
+		if ((*clause > 0) ? vals[*clause] : !vals[-*clause])
+		  return true;
+	 }
+	 return false;
+  }
+};
+
+
+// Task that checks the clauses in the i-th chunk of the buffer.
+// Each chunk begins after a 0 (or at the beginning of the buffer).
+// The position of the first falsified clause that has been found is
+// shared by the workers, which stop as soon as it is set.
+class clause_buffer_t::check_task_t {
+private:
+  static const size_t NONE;
+
+  const clause_buffer_t& _buffer;
+  const value_table_t& _vals;
+  const std::vector<size_t>& _chunks;
+  std::atomic<size_t> _position;
+
+public:
+  check_task_t(const clause_buffer_t& buffer,
+					const value_table_t& vals,
+					const std::vector<size_t>& chunks)
+		:_buffer(buffer), _vals(vals), _chunks(chunks), _position(NONE)
+  {};
+
+  bool falsified() const {
+	 return _position.load() != NONE;
+  };
+
+// The position of a falsified clause (if any)
+  size_t position() const {
+	 return _position.load();
+  };
+
+  void operator()(const size_t i) {
+	 const int* it= &_buffer._lits[0] + _chunks[i];
+	 const int* end= &_buffer._lits[0] + _chunks[i+1];
+	 while ((it != end) && (_position.load(std::memory_order_relaxed) == NONE)) {
+		if (!_buffer.is_satisfied(it, _vals)) {
+		  size_t none= NONE;
+		  _position.compare_exchange_strong(none, it - &_buffer._lits[0]);
+		}
+		while (*it != 0) ++it;
+		++it;
+	 }
+  };
+};
+
+const size_t clause_buffer_t::check_task_t::NONE=
+  std::numeric_limits<size_t>::max();
+
+bool
+clause_buffer_t::is_satisfied_by(const value_table_t& vals,
+											const unsigned int n_threads) const {
+  if (_lits.empty())
+	 return true;
+// Split the buffer into chunks of (roughly) the same size
+  const size_t n_chunks= 4*effective_no_of_threads(n_threads);
+  std::vector<size_t> chunks(1, 0);
+  for (size_t c= 1; c < n_chunks; ++c) {
+	 size_t pos= std::max(chunks.back(), (_lits.size() * c) / n_chunks);
+	 while ((pos < _lits.size()) && (pos > 0) && (_lits[pos-1] != 0)) ++pos;
+	 if (pos < _lits.size() && pos > chunks.back())
+		chunks.push_back(pos);
+  }
+  chunks.push_back(_lits.size());
+  check_task_t task(*this, vals, chunks);
+  parallel_for(chunks.size()-1, task, n_threads);
+  if (task.falsified()) {
+	 L_DEBUG("The clause at position " << task.position() <<
+				" is not satisfied.");
+	 return false;
+  }
+  return true;
+};
@@ -0,0 +1,249 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * dimacs_reader.cpp
+ *
+ * A fast reader of SAT instances in the DIMACS format.
+ *
+ **/
+
+#include "dimacs_reader.hpp"
+
+#ifdef INTERNAL_SAT_SOLVER
+
+#include "utility.hpp"
+
+#include <vector>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+
+static bool
+is_space(const char c) {
+  return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+// Build the message of a parsing error at position 'p'
+static std::string
+parse_error(const char* begin, const char* p, const std::string& msg) {
+  const size_t line= std::count(begin, p, '\n') + 1;
+  return "Malformed DIMACS instance at line " + tostr(line) + ": " + msg;
+}
+
+static bool
+is_digit(const char* p, const char* end) {
+  return (p != end) && (*p >= '0') && (*p <= '9');
+}
+
+// Parse an unsigned integer not greater than 'max' starting at 'p'.
+// If there is no such integer, 'p' is not moved.
+static bool
+parse_uint(const char*& p, const char* end, const size_t max, size_t& value) {
+  if (!is_digit(p, end))
+	 return false;
+  const char* q= p;
+  value= 0;
+  while (is_digit(q, end)) {
+	 const size_t digit= (size_t)(*q - '0');
+	 if (value > (max - digit) / 10)
+		return false;
+	 value= value*10 + digit;
+	 ++q;
+  }
+  p= q;
+  return true;
+}
+
+static void
+skip_line(const char*& p, const char* end) {
+  while ((p != end) && (*p != '\n'))
+	 ++p;
+}
+
+static void
+skip_blanks(const char*& p, const char* end) {
+  while ((p != end) && is_space(*p))
+	 ++p;
+}
+
+// Skip blanks without leaving the current line
+static void
+skip_line_blanks(const char*& p, const char* end) {
+  while ((p != end) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+	 ++p;
+}
+
+void
+dimacs_reader_t::load(const char* begin, const char* end,
+							 SAT_solver_iface_t& solver) {
+  _no_of_vars= 0;
+  _no_of_clauses= 0;
+  _no_of_xor_clauses= 0;
+  size_t declared_clauses= 0;
+  bool header= false;
+// The variables are created in the solver as they are used, since the
+// problem line could declare many more variables than the instance has
+  size_t reserved_vars= 0;
+  const size_t max_vars= std::numeric_limits<int>::max();
+  const size_t max_number= std::numeric_limits<size_t>::max();
+  std::vector<int> lits;
+  const char* p= begin;
+  while (true) {
+	 skip_blanks(p, end);
+	 if (p == end)
+		break;
+	 if (*p == 'c') {
+		skip_line(p, end);
+		continue;
+	 }
+// The trailer of the SATLIB instances ('%' and '0' lines) ends the instance
+	 if (*p == '%') {
+		break;
+	 }
+	 if (*p == 'p') {
+		if (header) {
+		  throw std::logic_error(parse_error(begin, p, "duplicated problem line."));
+		}
+		++p;
+		skip_line_blanks(p, end);
+		if ((end - p < 3) || (std::string(p, p+3) != "cnf")) {
+		  throw std::logic_error(parse_error(begin, p, "the format is not 'cnf'."));
+		}
+		p += 3;
+		skip_line_blanks(p, end);
+		if (!parse_uint(p, end, max_vars, _no_of_vars)) {
+		  throw std::logic_error(parse_error(begin, p,
+														 is_digit(p, end) ?
+														 "too many variables (at most " + tostr(max_vars) + ")." :
+														 "missing number of variables."));
+		}
+		skip_line_blanks(p, end);
+		if (!parse_uint(p, end, max_number, declared_clauses)) {
+		  throw std::logic_error(parse_error(begin, p,
+														 is_digit(p, end) ?
+														 "too many clauses." :
+														 "missing number of clauses."));
+		}
+		skip_line_blanks(p, end);
+		if ((p != end) && (*p != '\n')) {
+		  throw std::logic_error(parse_error(begin, p, "unexpected characters in the problem line."));
+		}
+		reserved_vars= std::min(_no_of_vars, (size_t)(end - p) / 2);
+		solver.reserve_vars(reserved_vars);
+		header= true;
+		continue;
+	 }
+	 if (!header) {
+		throw std::logic_error(parse_error(begin, p, "missing problem line."));
+	 }
+// A clause (possibly on more lines) terminated by 0
+	 const bool is_xor= (*p == 'x');
+	 if (is_xor)
+		++p;
+	 lits.clear();
+	 while (true) {
+		skip_blanks(p, end);
+		const bool negative= (p != end) && (*p == '-');
+		if (negative)
+		  ++p;
+		size_t var;
+		if (!parse_uint(p, end, max_number, var) || ((p != end) && !is_space(*p))) {
+		  throw std::logic_error(parse_error(begin, p,
+														 (p == end) ?
+														 "clause not terminated by 0." :
+														 is_digit(p, end) ?
+														 "variable not declared by the problem line." :
+														 "literal expected."));
+		}
+		if (var == 0)
+		  break;
+		if (var > _no_of_vars) {
+		  throw std::logic_error(parse_error(begin, p, "variable " + tostr(var) +
+														 " not declared by the problem line."));
+		}
+		if (var > reserved_vars) {
+		  reserved_vars= std::min(_no_of_vars, std::max(var, 2*reserved_vars));
+		  solver.reserve_vars(reserved_vars);
+		}
+		lits.push_back(negative ? -(int)var : (int)var);
+	 }
+	 if (is_xor) {
+		solver.add_xor_clause(lits.empty() ? NULL : &lits[0], lits.size());
+		++_no_of_xor_clauses;
+	 } else {
+		solver.add_clause(lits.empty() ? NULL : &lits[0], lits.size());
+		++_no_of_clauses;
+	 }
+  }
+  if (!header) {
+	 throw std::logic_error("Malformed DIMACS instance: missing problem line.");
+  }
+  if (_no_of_clauses + _no_of_xor_clauses != declared_clauses) {
+	 L_WARN("The problem line declares " << declared_clauses << " clauses, but " <<
+			  (_no_of_clauses + _no_of_xor_clauses) << " clauses have been read.");
+  }
+  L_DEBUG("DIMACS instance loaded: " << _no_of_vars << " variables, " <<
+			 _no_of_clauses << " clauses, and " << _no_of_xor_clauses <<
+			 " xor-clauses.");
+}
+
+void
+dimacs_reader_t::load(const std::string& file_name,
+							 SAT_solver_iface_t& solver) {
+  char magic[2]= { 0, 0 };
+  {
+	 std::ifstream in(file_name.c_str(), std::ios::binary);
+	 if (!in) {
+		throw std::logic_error("Impossible to open file '" + file_name + "'.");
+	 }
+	 in.read(magic, sizeof(magic));
+  }
+  if ((magic[0] == '\x1f') && (magic[1] == '\x8b')) {
+	 L_DEBUG("Decompressing the DIMACS instance '" << file_name << "'...");
+	 file_utility::pistream in=
+		file_utility::get_file_utility().get_ifstream(file_name, true);
+	 const std::string content((std::istreambuf_iterator<char>(*in)),
+									  std::istreambuf_iterator<char>());
+	 load(content.data(), content.data() + content.size(), solver);
+  } else if (boost::filesystem::file_size(file_name) == 0) {
+	 load(NULL, NULL, solver);
+  } else {
+	 L_DEBUG("Mapping the DIMACS instance '" << file_name << "'...");
+	 boost::iostreams::mapped_file_source file(file_name);
+	 load(file.data(), file.data() + file.size(), solver);
+  }
+}
+
+#endif // INTERNAL_SAT_SOLVER
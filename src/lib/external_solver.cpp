@@ -0,0 +1,210 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * external_solver.cpp
+ *
+ * Execution of an external SAT solver through pipes.
+ *
+ **/
+
+#include "external_solver.hpp"
+
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+
+#include "assertion.hpp"
+
+#include <limits>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/thread.hpp>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+// Competition exit codes of a solver that has decided the instance
+#define SAT_EXIT_STATUS (10)
+#define UNSAT_EXIT_STATUS (20)
+
+// Read the output of the solver (on a different thread, so that the solver
+// never blocks on a full pipe while it reads the instance)
+class external_solver_output_reader_t {
+private:
+  pedcnf_t& _cnf;
+  const int _fd;
+  bool& _is_sat;
+  bool& _decided;
+  std::string& _error;
+
+public:
+  external_solver_output_reader_t(pedcnf_t& cnf, const int fd,
+											 bool& is_sat, bool& decided,
+											 std::string& error)
+		:_cnf(cnf), _fd(fd), _is_sat(is_sat), _decided(decided), _error(error)
+  {};
+
+  void operator()() {
+	 namespace io= boost::iostreams;
+	 try {
+		io::stream<io::file_descriptor_source> in(_fd, io::never_close_handle);
+		_is_sat= _cnf.assignment_from_competition_format(in, _decided);
+// Consume the remaining output (if any)
+		in.ignore(std::numeric_limits<std::streamsize>::max());
+	 } catch (std::exception& e) {
+		_error= e.what();
+	 } catch (assertion_failed_exception& e) {
+		_error= e.what();
+	 }
+	 if (!_error.empty()) {
+// Keep the solver running until it exits
+		char buffer[4096];
+		while (read(_fd, buffer, sizeof(buffer)) > 0) {
+		}
+	 }
+  };
+};
+
+
+external_solver_t::external_solver_t(const std::string& cmdline)
+	 :_cmdline(cmdline), _exit_status(-1)
+{}
+
+bool
+external_solver_t::solve(pedcnf_t& cnf,
+								 const std::vector<std::string>& headers,
+								 bool& decided) {
+  std::string cmdline= _cmdline;
+  boost::replace_all(cmdline, "%%INPUT%%", "/dev/stdin");
+  boost::replace_all(cmdline, "%%OUTPUT%%", "/dev/stdout");
+  L_INFO("Executing the SAT solver through pipes ('" << cmdline << "')...");
+
+  int in_pipe[2], out_pipe[2];
+  if (pipe(in_pipe) != 0) {
+	 throw std::logic_error(std::string("Impossible to create a pipe: ") +
+									  strerror(errno));
+  }
+  if (pipe(out_pipe) != 0) {
+	 const int err= errno;
+	 close(in_pipe[0]);
+	 close(in_pipe[1]);
+	 throw std::logic_error(std::string("Impossible to create a pipe: ") +
+									  strerror(err));
+  }
+// The parent ends must not be inherited by the solver
+  fcntl(in_pipe[1], F_SETFD, FD_CLOEXEC);
+  fcntl(out_pipe[0], F_SETFD, FD_CLOEXEC);
+
+  const pid_t pid= fork();
+  if (pid < 0) {
+	 const int err= errno;
+	 close(in_pipe[0]);
+	 close(in_pipe[1]);
+	 close(out_pipe[0]);
+	 close(out_pipe[1]);
+	 throw std::logic_error(std::string("Impossible to execute the SAT solver: ") +
+									  strerror(err));
+  }
+  if (pid == 0) {
+// Child process: only async-signal-safe calls until exec
+	 dup2(in_pipe[0], STDIN_FILENO);
+	 dup2(out_pipe[1], STDOUT_FILENO);
+	 close(in_pipe[0]);
+	 close(out_pipe[1]);
+	 execl("/bin/sh", "sh", "-c", cmdline.c_str(), (char*)NULL);
+	 _exit(127);
+  }
+  close(in_pipe[0]);
+  close(out_pipe[1]);
+
+  bool is_sat= false;
+  decided= false;
+  std::string read_error;
+  boost::thread reader(external_solver_output_reader_t(cnf, out_pipe[0],
+																		  is_sat, decided,
+																		  read_error));
+
+// A solver that exits before reading the whole instance must not kill us
+  struct sigaction ignore_action, old_action;
+  memset(&ignore_action, 0, sizeof(ignore_action));
+  ignore_action.sa_handler= SIG_IGN;
+  sigaction(SIGPIPE, &ignore_action, &old_action);
+  {
+	 namespace io= boost::iostreams;
+	 try {
+		io::stream<io::file_descriptor_sink> out(in_pipe[1], io::never_close_handle);
+		cnf.clauses_to_dimacs_format(out, headers);
+		out.flush();
+	 } catch (std::exception& e) {
+		L_WARN("The SAT solver has not read the whole instance (" <<
+				 e.what() << ").");
+	 }
+	 close(in_pipe[1]);
+  }
+  sigaction(SIGPIPE, &old_action, NULL);
+  L_DEBUG("SAT instance written. Waiting for the SAT solver...");
+
+  reader.join();
+  close(out_pipe[0]);
+  int status;
+  while ((waitpid(pid, &status, 0) < 0) && (errno == EINTR)) {
+  }
+  _exit_status= WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  L_DEBUG("The SAT solver returned: '" << _exit_status << "'.");
+
+  if (!read_error.empty()) {
+	 L_ERROR("Impossible to read the result of the SAT solver: " << read_error);
+	 decided= false;
+	 return false;
+  }
+  if (decided &&
+		(_exit_status != SAT_EXIT_STATUS) && (_exit_status != UNSAT_EXIT_STATUS)) {
+	 L_DEBUG("The SAT solver has exited with a non-standard status.");
+  }
+  if (decided && is_sat && (_exit_status == UNSAT_EXIT_STATUS)) {
+	 L_WARN("The SAT solver has printed a satisfying assignment but its "
+			  "exit status means that the instance is unsatisfiable.");
+  }
+  if (!decided) {
+	 if (_exit_status == 127) {
+		L_ERROR("Impossible to execute the SAT solver ('" << cmdline << "').");
+	 } else {
+		L_WARN("The SAT solver has not decided the instance (exit status: " <<
+				 _exit_status << ").");
+	 }
+  }
+  return decided && is_sat;
+}
+
+#endif // ONLY_INTERNAL_SAT_SOLVER
@@ -0,0 +1,137 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * instance_estimate.cpp
+ *
+ * Functions to estimate the size of the SAT instance of a pedigree (and
+ * the memory needed to solve it) before encoding it.
+ *
+ **/
+
+#include "instance_estimate.hpp"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+
+std::ostream&
+operator<<(std::ostream& out, const pedigree_file_stats_t& stats) {
+  out << stats.individuals << " individuals (" << stats.founders <<
+	 " founders), " << stats.loci << " loci, " <<
+	 stats.missing_genotypes << " missing and " <<
+	 stats.heterozygous_genotypes << " heterozygous genotypes";
+  return out;
+}
+
+
+void
+scan_pedigree_file(std::istream& in, pedigree_file_stats_t& stats) {
+  stats= pedigree_file_stats_t();
+  std::string line;
+  std::vector<std::string> fields;
+  while (std::getline(in, line)) {
+// Split the line on blanks
+	 fields.clear();
+	 std::string::const_iterator it= line.begin();
+	 while (it != line.end()) {
+		while ((it != line.end()) && isspace(*it)) ++it;
+		std::string::const_iterator begin= it;
+		while ((it != line.end()) && !isspace(*it)) ++it;
+		if (begin != it)
+		  fields.push_back(std::string(begin, it));
+	 }
+	 if (fields.size() < 6)
+		continue;
+	 ++stats.individuals;
+	 if ((fields[2] == "0") && (fields[3] == "0"))
+		++stats.founders;
+	 const size_t loci= (fields.size() - 6) / 2;
+	 stats.loci= std::max(stats.loci, loci);
+	 for (size_t l= 0; l < loci; ++l) {
+		const std::string& a1= fields[6 + 2*l];
+		const std::string& a2= fields[7 + 2*l];
+		++stats.genotypes;
+		if ((a1 == "0") || (a2 == "0")) {
+		  ++stats.missing_genotypes;
+		} else if (a1 != a2) {
+		  ++stats.heterozygous_genotypes;
+		}
+	 }
+  }
+}
+
+
+std::ostream&
+operator<<(std::ostream& out, const instance_estimate_t& estimate) {
+  out << (size_t)estimate.variables << " variables, " <<
+	 (size_t)estimate.clauses << " clauses, " <<
+	 (size_t)estimate.xor_clauses << " xor-clauses, " <<
+	 (size_t)estimate.memory_mb << "MB";
+  return out;
+}
+
+
+double
+estimate_memory_mb(const instance_estimate_t& instance,
+						 const size_t genotypes,
+						 const bool xor_clauses) {
+  double memory_kb;
+  if (!xor_clauses) {
+	 memory_kb= 0.82*instance.variables + 0.16*instance.clauses +
+		0.01*genotypes;
+  } else {
+	 memory_kb= 0.41*instance.variables +
+		0.30*(instance.clauses + instance.xor_clauses);
+  }
+// 10% of margin, since the model underestimates some instances
+  return std::max(memory_kb, 0.0) * 1.1 / 1024.0;
+}
+
+
+instance_estimate_t
+estimate_instance(const pedigree_file_stats_t& stats,
+						const bool xor_clauses) {
+  const double het= stats.heterozygous_genotypes;
+  const double miss= stats.missing_genotypes;
+  const double nfl= (double)(stats.individuals - stats.founders) * stats.loci;
+  const double ind= stats.individuals;
+  instance_estimate_t e;
+  e.variables= 0.32*het + 2.97*miss + 0.13*nfl + 0.51*ind;
+  if (!xor_clauses) {
+	 e.clauses= -5.08*het + 5.98*miss + 4.06*nfl + 2.76*ind;
+	 e.xor_clauses= 0.0;
+  } else {
+	 e.clauses= -1.03*het + 3.08*miss + 0.74*nfl + 0.57*ind;
+	 e.xor_clauses= -1.18*het + 0.35*miss + 1.02*nfl + 0.61*ind;
+  }
+  e.clauses= std::max(e.clauses, 0.0);
+  e.xor_clauses= std::max(e.xor_clauses, 0.0);
+  e.memory_mb= estimate_memory_mb(e, stats.genotypes, xor_clauses);
+  return e;
+}
@@ -33,7 +33,10 @@
  **/
 
 #include "pedcnf.hpp"
+#include "sat_result_reader.hpp"
+#include "binary_instance.hpp"
 #include <iomanip>
+#include <stdexcept>
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string/trim.hpp>
 
@@ -41,9 +44,10 @@ const ped_var_kind ped_var_kind::H(0);
 const ped_var_kind ped_var_kind::W(1);
 const ped_var_kind ped_var_kind::S(2);
 const ped_var_kind ped_var_kind::DUMMY(3);
-const int ped_var_kind::int_values[]={0, 1, 2, 3};
-const std::string ped_var_kind::str_values[]={"h", "w", "s", "dummy"};
-const ped_var_kind ped_var_kind::enum_values[]={H, W, S, DUMMY};
+const ped_var_kind ped_var_kind::SELECTOR(4);
+const int ped_var_kind::int_values[]={0, 1, 2, 3, 4};
+const std::string ped_var_kind::str_values[]={"h", "w", "s", "dummy", "sel"};
+const ped_var_kind ped_var_kind::enum_values[]={H, W, S, DUMMY, SELECTOR};
 
 std::ostream&
 operator<<(std::ostream& out, const pedcnf_t::pedvar_t& var) {
@@ -106,6 +110,39 @@ pedcnf_t::get_dummy(const int v1, const int v2) {
   return get_var(_dummy, ped_var_kind::DUMMY, v1, v2);
 };
 
+int
+pedcnf_t::get_selector(const size_t i, const size_t l) {
+  return get_var(_sel, ped_var_kind::SELECTOR, i, l);
+};
+
+int
+pedcnf_t::add_var(const pedvar_t& var) {
+  const ped_var_kind& kind= var.get<0>();
+  varmap_t& map=
+	 (kind == ped_var_kind::H) ? _h :
+	 (kind == ped_var_kind::W) ? _w :
+	 (kind == ped_var_kind::S) ? _s :
+	 (kind == ped_var_kind::SELECTOR) ? _sel : _dummy;
+  const index_var_t index(var.get<1>(), var.get<2>());
+  MY_ASSERT( (kind == ped_var_kind::SELECTOR) || (map.count(index) == 0) );
+  _vars.push_back(var);
+  _vals.push_back(false);
+  map[index]= _vars.size();
+  return _vars.size();
+};
+
+int
+pedcnf_t::renew_selector(const size_t i, const size_t l) {
+  varmap_t::iterator it= _sel.find(boost::make_tuple(i, l));
+  if (it != _sel.end()) {
+	 clause_t clause;
+	 clause.insert(-it->second);
+	 add_clause_impl(clause);
+	 _sel.erase(it);
+  }
+  return get_selector(i, l);
+};
+
 int
 pedcnf_t::get_h(const size_t i, const size_t l) const {
   return get_var(_h, i, l);
@@ -129,29 +166,22 @@ pedcnf_t::get_dummy(const int v1, const int v2) const {
 
 #ifndef ONLY_INTERNAL_SAT_SOLVER
 
+void
+pedcnf_t::get_value_table(clause_buffer_t::value_table_t& vals) const {
+  vals.resize(_vals.size()+1);
+  vals[0]= 0;
+  for (size_t v= 0; v < _vals.size(); ++v) {
+	 vals[v+1]= _vals[v] ? 1 : 0;
+  }
+};
+
 bool
-pedcnf_t::is_satisfying_assignment() const {
+pedcnf_t::is_satisfying_assignment(const unsigned int n_threads) const {
   L_DEBUG("Checking if value assignment satisfies the clauses...");
   MY_ASSERT_DBG( _vars.size() == _vals.size() );
-  bool ris= true;
-  BOOST_FOREACH(const clause_t& clause, _clauses) {
-	 if (ris) {
-		bool intris= false;
-		BOOST_FOREACH(const int& var, clause) {
-		  MY_ASSERT( var != 0 );
-		  MY_ASSERT( (size_t)abs(var) <= _vars.size() );
-		  if (var>0) {
-			 intris= intris || _vals[var-1];
-		  } else {
-			 intris= intris || !_vals[-var-1];
-		  }
-		}
-		if (!intris) {
-		  L_DEBUG("Clause " << tostr(clause) << " is not satisfied.");
-		}
-		ris= ris && intris;
-	 }
-  }
+  clause_buffer_t::value_table_t vals;
+  get_value_table(vals);
+  const bool ris= _clause_buffer.is_satisfied_by(vals, n_threads);
   if (ris) {
 	 L_DEBUG("The assignment satisfies all the clauses.");
   } else {
@@ -195,40 +225,47 @@ pedcnf_t::clauses_to_dimacs_format(std::ostream& out,
   return out;
 };
 
+std::ostream&
+pedcnf_t::clauses_to_binary_format(std::ostream& out) const {
+  binary_instance_t::write(out, _vars, _clauses, binary_instance_t::clauses_t());
+  return out;
+};
+
 #endif // ONLY_INTERNAL_SAT_SOLVER
 
 
+bool
+pedcnf_t::read_assignment(std::istream& in, bool& decided) {
+  sat_result_reader_t reader(in);
+  const bool is_sat= reader.read(_vals, decided);
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+  if (is_sat) {
+	 MY_ASSERT_DBG( is_satisfying_assignment() );
+  }
+#endif // ONLY_INTERNAL_SAT_SOLVER
+  return is_sat;
+};
+
 // Read the assignment from a file like the following one:
 // SAT/UNSAT
 // 1 -2 3 4 0
 bool
 pedcnf_t::assignment_from_minisat_format(std::istream& in) {
-  std::string line;
-  std::getline(in, line);
-  boost::trim(line);
-  MY_ASSERT_DBG( (line == "SAT") || (line == "UNSAT") );
-  if (line == "UNSAT") {
-	 L_DEBUG("UNSATISFIABLE clauses.");
-	 return false;
-  } else if (line == "SAT") {
-	 L_DEBUG("Satisfiable clauses. Reading assignment...");
-	 std::getline(in, line);
-	 boost::trim(line);
-	 std::istringstream is(line);
-	 int value;
-	 while ((is >> value) && (value != 0)) {
-		MY_ASSERT( (size_t)abs(value) <= _vals.size() );
-		_vals[(size_t)abs(value)-1]= (value>0);
-	 }
-	 MY_ASSERT( ! (is >> value) ); // zero must be the last element
-#ifndef ONLY_INTERNAL_SAT_SOLVER
-	 MY_ASSERT_DBG( is_satisfying_assignment() );
-#endif // ONLY_INTERNAL_SAT_SOLVER
-	 return true;
-  } else {
-	 MY_FAIL;
+  bool decided;
+  const bool is_sat= read_assignment(in, decided);
+  if (!decided) {
+	 throw std::logic_error("The result of the SAT solver does not state "
+									"whether the instance is satisfiable or not "
+									"(the solver has been interrupted).");
   }
-  return false;
+  return is_sat;
+};
+
+// Read the assignment from the output of a solver in the format of the
+// SAT competitions ('s' status line and 'v' value lines)
+bool
+pedcnf_t::assignment_from_competition_format(std::istream& in, bool& decided) {
+  return read_assignment(in, decided);
 };
 
 
@@ -245,11 +282,114 @@ operator<<(std::ostream& out, const pedcnf_t::clause_t& clause) {
 
 void
 pedcnf_t::add_clause(const clause_t& clause) {
+  if (_selector != 0) {
+	 clause_t guarded_clause(clause);
+	 guarded_clause.insert(-_selector);
+	 add_clause_impl(guarded_clause);
+  } else {
+	 add_clause_impl(clause);
+  }
+};
+
+void
+pedcnf_t::add_clause_impl(const clause_t& clause) {
 #ifndef ONLY_INTERNAL_SAT_SOLVER
-  _clauses.insert(clause);
+  if (_clauses.insert(clause).second) {
+	 _clause_buffer.add_clause(clause);
+  }
 #endif
+  if (_keep_clauses) {
+	 _kept_clauses.push_back(std::vector<int>(clause.begin(), clause.end()));
+  }
 #ifdef INTERNAL_SAT_SOLVER
   _solver.add_clause(clause);
 #endif
   ++_no_of_clauses;
 };
+
+#ifdef INTERNAL_SAT_SOLVER
+
+bool
+pedcnf_t::solve_with_selectors(std::vector<pedvar_t>& core) {
+  core.clear();
+  std::vector<int> assumptions;
+  assumptions.reserve(_sel.size());
+  BOOST_FOREACH( const varmap_t::value_type& sel, _sel ) {
+	 assumptions.push_back(sel.second);
+  }
+  L_DEBUG("Solving the SAT instance under " << assumptions.size() <<
+			 " selectors...");
+  bool ret= _solver.solve(assumptions);
+  if (ret) {
+	 _solver.model(_vals);
+	 return true;
+  }
+  if (_solver.is_interrupted()) {
+	 L_DEBUG("Solver interrupted: no unsatisfiable core has been computed.");
+	 return false;
+  }
+  std::vector<int> conflict;
+  _solver.conflict(conflict);
+  while (!conflict.empty() && (conflict.size() < assumptions.size())) {
+	 L_DEBUG("Unsatisfiable core of " << conflict.size() << " selectors.");
+	 assumptions.clear();
+	 BOOST_FOREACH( const int lit, conflict ) {
+		assumptions.push_back(-lit);
+	 }
+	 ret= _solver.solve(assumptions);
+	 if (_solver.is_interrupted()) {
+// The last conflict is still an unsatisfiable core
+		break;
+	 }
+	 MY_ASSERT( !ret );
+	 _solver.conflict(conflict);
+  }
+  BOOST_FOREACH( const int lit, conflict ) {
+	 MY_ASSERT( (0 < -lit) && ((size_t)-lit <= _vars.size()) );
+	 MY_ASSERT( _vars[-lit-1].get<0>() == ped_var_kind::SELECTOR );
+	 core.push_back(_vars[-lit-1]);
+  }
+  L_DEBUG("Final unsatisfiable core of " << core.size() << " selectors.");
+  return false;
+};
+
+// The learnt clauses over variables that are not in the instance (such as
+// the auxiliary variables of the solver) are discarded.
+void
+pedcnf_t::learnt_clauses(std::vector< std::vector<int> >& clauses,
+								 const size_t max_size) const {
+  clauses.clear();
+  std::vector< std::vector<int> > learnts;
+  _solver.learnt_clauses(learnts, max_size);
+  BOOST_FOREACH( const std::vector<int>& learnt, learnts ) {
+	 bool keep= true;
+	 for (size_t j= 0; keep && (j < learnt.size()); ++j) {
+		keep= ((size_t)std::abs(learnt[j]) <= _vars.size());
+	 }
+	 if (keep) {
+		clauses.push_back(learnt);
+	 }
+  }
+  L_DEBUG("Kept " << clauses.size() << " of " << learnts.size() <<
+			 " learnt clauses.");
+};
+
+size_t
+pedcnf_t::add_learnt_clauses(const std::vector< std::vector<int> >& clauses) {
+  size_t no_of_added= 0;
+  BOOST_FOREACH( const std::vector<int>& clause, clauses ) {
+	 bool keep= !clause.empty();
+	 for (size_t j= 0; keep && (j < clause.size()); ++j) {
+		keep= (clause[j] != 0) && ((size_t)std::abs(clause[j]) <= _vars.size());
+	 }
+	 if (keep) {
+		_solver.add_learnt_clause(clause);
+		++no_of_added;
+	 }
+  }
+  L_DEBUG("Added " << no_of_added << " of " << clauses.size() <<
+			 " learnt clauses.");
+  return no_of_added;
+};
+
+#endif // INTERNAL_SAT_SOLVER
@@ -35,37 +35,24 @@
  **/
 
 #include "pedcnf_ext.hpp"
+#include "binary_instance.hpp"
 #include <iomanip>
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string/trim.hpp>
 
 #ifndef ONLY_INTERNAL_SAT_SOLVER
 bool
-pedcnf_ext_t::is_satisfying_assignment() const {
+pedcnf_ext_t::is_satisfying_assignment(const unsigned int n_threads) const {
   L_DEBUG("Checking if value assignment satisfies the or- and xor-clauses...");
-  const bool base_ris= this->pedcnf_t::is_satisfying_assignment();
+  const bool base_ris= this->pedcnf_t::is_satisfying_assignment(n_threads);
   if (!base_ris) {
 	 L_DEBUG("The value assignment does not satisfy the or-clauses.");
 	 return false;
   }
   MY_ASSERT_DBG( vars().size() == vals().size() );
-  bool ris= true;
-  BOOST_FOREACH(const xor_clause_t& clause, _xor_clauses) {
-	 if (ris) {
-		bool intris= false;
-		BOOST_FOREACH(const int& var, clause) {
-		  MY_ASSERT( var != 0 );
-		  MY_ASSERT( (size_t)abs(var) <= vars().size() );
-		  bool val_var= vals()[abs(var)-1];
-		  if (var<0) val_var= !val_var;
-		  intris= (intris && !val_var) || (!intris && val_var);
-		}
-		if (!intris) {
-		  L_DEBUG("Clause " << tostr(clause) << " is not satisfied.");
-		}
-		ris= ris && intris;
-	 }
-  }
+  clause_buffer_t::value_table_t vals;
+  get_value_table(vals);
+  const bool ris= _xor_clause_buffer.is_satisfied_by(vals, n_threads);
   if (ris) {
 	 L_DEBUG("The assignment satisfies all the or- and xor-clauses.");
   } else {
@@ -105,12 +92,22 @@ pedcnf_ext_t::clauses_to_dimacs_format(std::ostream& out,
   return out;
 };
 
+std::ostream&
+pedcnf_ext_t::clauses_to_binary_format(std::ostream& out) const {
+  binary_instance_t::write(out, vars(), clauses(), _xor_clauses);
+  return out;
+};
+
 #endif // ONLY_INTERNAL_SAT_SOLVER
 
 void
 pedcnf_ext_t::add_xor_clause(const xor_clause_t& clause) {
+// xor-clauses cannot be guarded by a selector
+  MY_ASSERT( selector() == 0 );
 #ifndef ONLY_INTERNAL_SAT_SOLVER
-  _xor_clauses.insert(clause);
+  if (_xor_clauses.insert(clause).second) {
+	 _xor_clause_buffer.add_clause(clause);
+  }
 #endif
 #ifdef INTERNAL_SAT_SOLVER
   _solver.add_xor_clause(clause);
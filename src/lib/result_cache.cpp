@@ -0,0 +1,135 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * result_cache.cpp
+ *
+ * An on-disk cache of the results of the families already solved.
+ *
+ **/
+
+#include "result_cache.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include <boost/version.hpp>
+#include <boost/uuid/detail/sha1.hpp>
+
+
+const unsigned int result_cache_t::FORMAT_VERSION= 1;
+
+result_cache_t::result_cache_t(const std::string& dir,
+										 const std::string& options)
+	 :_dir(dir), _options(options)
+{
+  boost::filesystem::create_directories(_dir);
+  if (!boost::filesystem::is_directory(_dir)) {
+	 throw std::logic_error(std::string("Impossible to use '") + dir +
+								  "' as the directory of the result cache.");
+  }
+  L_INFO("Using result cache '" << dir << "' (options: " << _options << ").");
+}
+
+std::string
+result_cache_t::hash(const std::string& text) {
+  boost::uuids::detail::sha1 sha;
+  sha.process_bytes(text.data(), text.size());
+  boost::uuids::detail::sha1::digest_type digest;
+  sha.get_digest(digest);
+  std::ostringstream os;
+  os << std::hex << std::setfill('0');
+#if BOOST_VERSION >= 108600
+  for (size_t i= 0; i < 20; ++i)
+	 os << std::setw(2) << (unsigned int)digest[i];
+#else
+  for (size_t i= 0; i < 5; ++i)
+	 os << std::setw(8) << (digest[i] & 0xFFFFFFFFu);
+#endif
+  return os.str();
+}
+
+bool
+result_cache_t::read_entry(const std::string& key,
+									bool& is_zrhc,
+									std::vector<std::string>& lines) const {
+  std::ifstream is((_dir / key).string().c_str());
+  if (!is)
+	 return false;
+  std::string verdict;
+  if (!std::getline(is, verdict))
+	 return false;
+  if (verdict == "ZRHC") {
+	 is_zrhc= true;
+  } else if (verdict == "NO_ZRHC") {
+	 is_zrhc= false;
+  } else {
+	 L_WARN("Entry " << key << " of the result cache is malformed.");
+	 return false;
+  }
+  lines.clear();
+  std::string line;
+  while (std::getline(is, line)) {
+	 lines.push_back(line);
+  }
+  return true;
+}
+
+// The entry is written in a temporary file and then renamed, so that
+// concurrent readers (and writers of the same entry) never see a partial
+// entry
+void
+result_cache_t::write_entry(const std::string& key,
+									 const std::string& content) const {
+  const boost::filesystem::path tmp=
+	 _dir / boost::filesystem::unique_path(key + ".tmp-%%%%-%%%%-%%%%");
+  {
+	 std::ofstream os(tmp.string().c_str());
+	 os << content;
+	 os.close();
+	 if (!os) {
+		L_WARN("Impossible to write entry " << key << " of the result cache.");
+		boost::system::error_code ec;
+		boost::filesystem::remove(tmp, ec);
+		return;
+	 }
+  }
+  boost::system::error_code ec;
+  boost::filesystem::rename(tmp, _dir / key, ec);
+  if (ec) {
+	 L_WARN("Impossible to write entry " << key << " of the result cache: " <<
+			  ec.message());
+	 boost::filesystem::remove(tmp, ec);
+  }
+}
+
+void
+result_cache_t::remove_entry(const std::string& key) const {
+  boost::system::error_code ec;
+  boost::filesystem::remove(_dir / key, ec);
+}
@@ -0,0 +1,258 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * run_stats.cpp
+ *
+ * Collection of the running times, the memory usage and the size of the
+ * SAT instances of a run of the program.
+ *
+ **/
+
+#include "run_stats.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/foreach.hpp>
+
+
+// Escape a string to be written as a JSON string
+static std::string
+json_string(const std::string& s) {
+  std::ostringstream out;
+  out << '"';
+  BOOST_FOREACH( const char c, s ) {
+	 switch (c) {
+	 case '"':  out << "\\\""; break;
+	 case '\\': out << "\\\\"; break;
+	 case '\n': out << "\\n"; break;
+	 case '\r': out << "\\r"; break;
+	 case '\t': out << "\\t"; break;
+	 default:
+		if (static_cast<unsigned char>(c) < 0x20) {
+		  out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+				<< static_cast<int>(c) << std::dec << std::setfill(' ');
+		} else {
+		  out << c;
+		}
+	 }
+  }
+  out << '"';
+  return out.str();
+}
+
+
+run_stats_t::run_stats_t()
+	 :_wall_start(wall_time()), _cpu_start(cpu_time())
+{}
+
+
+double
+run_stats_t::wall_time() {
+  static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+  const boost::posix_time::time_duration d=
+	 boost::posix_time::microsec_clock::universal_time() - epoch;
+  return d.total_microseconds() / 1e6;
+}
+
+
+double
+run_stats_t::cpu_time() {
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0)
+	 return 0.0;
+  return
+	 ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+	 ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+
+double
+run_stats_t::thread_cpu_time() {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+	 return 0.0;
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+long
+run_stats_t::peak_rss_kb() {
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0)
+	 return 0;
+// On Linux, 'ru_maxrss' is expressed in kilobytes
+  return ru.ru_maxrss;
+}
+
+
+long
+run_stats_t::current_rss_kb() {
+// The second field of '/proc/self/statm' is the number of resident pages
+  std::ifstream statm("/proc/self/statm");
+  long size= 0;
+  long resident= 0;
+  if (!(statm >> size >> resident))
+	 return peak_rss_kb();
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+
+void
+run_stats_t::add_phase_time(const std::string& name,
+									 const double wall_time,
+									 const double cpu_time) {
+  boost::mutex::scoped_lock lock(_mutex);
+  phases_t::iterator it= _phases.begin();
+  while ((it != _phases.end()) && (it->name != name))
+	 ++it;
+  if (it == _phases.end()) {
+	 _phases.push_back(phase_t(name));
+	 it= _phases.end() - 1;
+  }
+  it->calls += 1;
+  it->wall_time += wall_time;
+  it->cpu_time += cpu_time;
+  L_DEBUG("Phase '" << name << "' completed in " <<
+			 std::fixed << std::setprecision(3) << wall_time << "s (CPU time: " <<
+			 cpu_time << "s).");
+}
+
+
+void
+run_stats_t::set_counter(const std::string& name, const long long value) {
+  boost::mutex::scoped_lock lock(_mutex);
+  BOOST_FOREACH( counters_t::value_type& c, _counters ) {
+	 if (c.first == name) {
+		c.second= value;
+		return;
+	 }
+  }
+  _counters.push_back(std::make_pair(name, value));
+}
+
+
+void
+run_stats_t::add_to_counter(const std::string& name, const long long value) {
+  boost::mutex::scoped_lock lock(_mutex);
+  BOOST_FOREACH( counters_t::value_type& c, _counters ) {
+	 if (c.first == name) {
+		c.second += value;
+		return;
+	 }
+  }
+  _counters.push_back(std::make_pair(name, value));
+}
+
+
+void
+run_stats_t::set_info(const std::string& name, const std::string& value) {
+  boost::mutex::scoped_lock lock(_mutex);
+  BOOST_FOREACH( infos_t::value_type& i, _infos ) {
+	 if (i.first == name) {
+		i.second= value;
+		return;
+	 }
+  }
+  _infos.push_back(std::make_pair(name, value));
+}
+
+
+run_stats_t::phases_t
+run_stats_t::phases() const {
+  boost::mutex::scoped_lock lock(_mutex);
+  return _phases;
+}
+
+
+run_stats_t::counters_t
+run_stats_t::counters() const {
+  boost::mutex::scoped_lock lock(_mutex);
+  return _counters;
+}
+
+
+long long
+run_stats_t::counter(const std::string& name) const {
+  boost::mutex::scoped_lock lock(_mutex);
+  BOOST_FOREACH( const counters_t::value_type& c, _counters ) {
+	 if (c.first == name)
+		return c.second;
+  }
+  return 0;
+}
+
+
+void
+run_stats_t::clear() {
+  boost::mutex::scoped_lock lock(_mutex);
+  _phases.clear();
+  _counters.clear();
+  _infos.clear();
+}
+
+
+std::ostream&
+run_stats_t::write_json(std::ostream& out) const {
+  boost::mutex::scoped_lock lock(_mutex);
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(6);
+  os << "{" << std::endl;
+  BOOST_FOREACH( const infos_t::value_type& i, _infos ) {
+	 os << "  " << json_string(i.first) << ": " << json_string(i.second) <<
+		"," << std::endl;
+  }
+  os << "  \"wall_time\": " << (wall_time() - _wall_start) << "," << std::endl;
+  os << "  \"cpu_time\": " << (cpu_time() - _cpu_start) << "," << std::endl;
+  os << "  \"peak_rss_kb\": " << peak_rss_kb() << "," << std::endl;
+  os << "  \"phases\": [";
+  for (phases_t::const_iterator it= _phases.begin(); it != _phases.end(); ++it) {
+	 os << ((it == _phases.begin()) ? "" : ",") << std::endl;
+	 os << "    { \"name\": " << json_string(it->name) <<
+		", \"calls\": " << it->calls <<
+		", \"wall_time\": " << it->wall_time <<
+		", \"cpu_time\": " << it->cpu_time << " }";
+  }
+  os << (_phases.empty() ? "" : "\n  ") << "]," << std::endl;
+  os << "  \"counters\": {";
+  for (counters_t::const_iterator it= _counters.begin(); it != _counters.end(); ++it) {
+	 os << ((it == _counters.begin()) ? "" : ",") << std::endl;
+	 os << "    " << json_string(it->first) << ": " << it->second;
+  }
+  os << (_counters.empty() ? "" : "\n  ") << "}" << std::endl;
+  os << "}" << std::endl;
+  out << os.str();
+  return out;
+}
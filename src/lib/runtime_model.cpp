@@ -0,0 +1,236 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * runtime_model.cpp
+ *
+ * A model of the time needed to encode and solve a SAT instance, fitted
+ * on the statistics of previous runs.
+ *
+ **/
+
+#include "runtime_model.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+#include <boost/algorithm/string/trim.hpp>
+
+
+const size_t runtime_model_t::NO_OF_COEFFICIENTS;
+
+static const char* const feature_names[runtime_model_t::NO_OF_COEFFICIENTS]=
+  { "intercept", "variables", "clauses", "xor_clauses" };
+
+// The number that follows '"key":' in 'text[from, to)' (or 'def' if the
+// key is not present)
+static double
+json_number(const std::string& text, const std::string& key,
+				const size_t from, const size_t to, const double def) {
+  const std::string quoted_key= "\"" + key + "\":";
+  const size_t pos= text.find(quoted_key, from);
+  if ((pos == std::string::npos) || (pos >= to))
+	 return def;
+  return atof(text.c_str() + pos + quoted_key.size());
+}
+
+bool
+read_recorded_run(std::istream& in, recorded_run_t& run) {
+  const std::string text((std::istreambuf_iterator<char>(in)),
+								 std::istreambuf_iterator<char>());
+  const size_t counters= text.find("\"counters\":");
+  if (counters == std::string::npos)
+	 return false;
+// Only the runs that have decided the instance (exit status 0 or
+// EXIT_NO_ZRHC) give a meaningful running time
+  const double exit_status= json_number(text, "exit_status", counters,
+													 text.size(), -1.0);
+  if ((exit_status != 0.0) && (exit_status != 2.0))
+	 return false;
+  run.variables= json_number(text, "variables", counters, text.size(), 0.0);
+  run.clauses= json_number(text, "clauses", counters, text.size(), 0.0);
+  run.xor_clauses= json_number(text, "xor_clauses", counters, text.size(), 0.0);
+  if (json_number(text, "solver_interruptions", counters, text.size(), 0.0) > 0.0)
+	 return false;
+// The phases are objects such as { "name": "solving", ..., "wall_time": 1.2, ... }
+  double encoding= 0.0, solving= 0.0, encoding_and_solving= 0.0;
+  const size_t phases_end= counters;
+  size_t pos= text.find("\"phases\":");
+  while ((pos= text.find("{ \"name\": \"", pos)) < phases_end) {
+	 const size_t name_begin= pos + 11;
+	 const size_t name_end= text.find('"', name_begin);
+	 const size_t phase_end= text.find('}', name_begin);
+	 const std::string name= text.substr(name_begin, name_end - name_begin);
+	 const double wall_time= json_number(text, "wall_time", name_end,
+													 phase_end, 0.0);
+	 if (name == "encoding") {
+		encoding= wall_time;
+	 } else if (name == "solving") {
+		solving= wall_time;
+	 } else if (name == "encoding_and_solving") {
+		encoding_and_solving= wall_time;
+	 }
+	 pos= phase_end;
+  }
+  run.seconds= (encoding_and_solving > 0.0) ?
+	 encoding_and_solving : (encoding + solving);
+  return (run.variables > 0.0) && (run.seconds > 0.0);
+}
+
+
+static void
+get_features(const double variables, const double clauses,
+				 const double xor_clauses, std::vector<double>& x) {
+  x.resize(runtime_model_t::NO_OF_COEFFICIENTS);
+  x[0]= 1.0;
+  x[1]= variables;
+  x[2]= clauses;
+  x[3]= xor_clauses;
+}
+
+void
+runtime_model_t::fit(const std::vector<recorded_run_t>& runs) {
+  const size_t n= NO_OF_COEFFICIENTS;
+  _c.assign(n, 0.0);
+  _runs= runs.size();
+  if (runs.empty()) {
+	 L_WARN("No recorded run: the runtime model predicts 0 seconds.");
+	 return;
+  }
+// The features are scaled to [-1, 1] to keep the normal equations
+// well-conditioned
+  std::vector<double> scale(n, 0.0);
+  std::vector<double> x;
+  BOOST_FOREACH( const recorded_run_t& run, runs ) {
+	 get_features(run.variables, run.clauses, run.xor_clauses, x);
+	 for (size_t k= 0; k < n; ++k)
+		scale[k]= std::max(scale[k], std::fabs(x[k]));
+  }
+  std::vector<bool> active(n);
+  for (size_t k= 0; k < n; ++k)
+	 active[k]= (scale[k] > 0.0);
+  bool solved= false;
+  while (!solved) {
+	 std::vector<size_t> cols;
+	 for (size_t k= 0; k < n; ++k)
+		if (active[k]) cols.push_back(k);
+	 const size_t m= cols.size();
+// Normal equations (A | b) restricted to the active features
+	 std::vector< std::vector<double> > a(m, std::vector<double>(m+1, 0.0));
+	 BOOST_FOREACH( const recorded_run_t& run, runs ) {
+		get_features(run.variables, run.clauses, run.xor_clauses, x);
+		for (size_t i= 0; i < m; ++i) {
+		  const double xi= x[cols[i]] / scale[cols[i]];
+		  for (size_t j= 0; j < m; ++j)
+			 a[i][j]+= xi * x[cols[j]] / scale[cols[j]];
+		  a[i][m]+= xi * run.seconds;
+		}
+	 }
+// Gaussian elimination with partial pivoting.  A feature that is a linear
+// combination of the previous ones (on the given runs) is dropped.
+	 solved= true;
+	 for (size_t i= 0; solved && (i < m); ++i) {
+		size_t piv= i;
+		for (size_t r= i+1; r < m; ++r)
+		  if (std::fabs(a[r][i]) > std::fabs(a[piv][i])) piv= r;
+		if (std::fabs(a[piv][i]) < 1e-9 * runs.size()) {
+		  L_DEBUG("Feature '" << feature_names[cols[i]] <<
+					 "' cannot be determined by the recorded runs.");
+		  active[cols[i]]= false;
+		  solved= false;
+		} else {
+		  std::swap(a[i], a[piv]);
+		  for (size_t r= 0; r < m; ++r) {
+			 if (r == i) continue;
+			 const double f= a[r][i] / a[i][i];
+			 for (size_t j= i; j <= m; ++j)
+				a[r][j]-= f * a[i][j];
+		  }
+		}
+	 }
+	 if (solved) {
+		for (size_t i= 0; i < m; ++i)
+		  _c[cols[i]]= a[i][m] / a[i][i] / scale[cols[i]];
+	 }
+  }
+  L_INFO("Runtime model fitted on " << _runs << " runs.");
+}
+
+double
+runtime_model_t::predict(const instance_estimate_t& instance) const {
+  std::vector<double> x;
+  get_features(instance.variables, instance.clauses, instance.xor_clauses, x);
+  double seconds= 0.0;
+  for (size_t k= 0; k < NO_OF_COEFFICIENTS; ++k)
+	 seconds+= _c[k] * x[k];
+  return std::max(seconds, 0.0);
+}
+
+void
+runtime_model_t::save(std::ostream& out) const {
+  out << "# seconds = intercept + variables * c_1 + clauses * c_2 + "
+	 "xor_clauses * c_3" << std::endl;
+  out << "runs " << _runs << std::endl;
+  out.precision(12);
+  for (size_t k= 0; k < NO_OF_COEFFICIENTS; ++k)
+	 out << feature_names[k] << " " << _c[k] << std::endl;
+}
+
+void
+runtime_model_t::load(std::istream& in) {
+  _c.assign(NO_OF_COEFFICIENTS, 0.0);
+  _runs= 0;
+  std::string line;
+  while (std::getline(in, line)) {
+	 boost::trim(line);
+	 if (line.empty() || (line[0] == '#'))
+		continue;
+	 std::istringstream is(line);
+	 std::string name;
+	 double value;
+	 if (!(is >> name >> value))
+		throw std::logic_error(std::string("Malformed line '") + line +
+									  "' in the runtime model.");
+	 if (name == "runs") {
+		_runs= (size_t)value;
+		continue;
+	 }
+	 const char* const* it= std::find(feature_names,
+												 feature_names + NO_OF_COEFFICIENTS,
+												 name);
+	 if (it == feature_names + NO_OF_COEFFICIENTS)
+		throw std::logic_error(std::string("Unknown coefficient '") + name +
+									  "' in the runtime model.");
+	 _c[it - feature_names]= value;
+  }
+}
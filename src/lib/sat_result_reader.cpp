@@ -0,0 +1,179 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * sat_result_reader.cpp
+ *
+ * A streaming reader of the results of SAT solvers.
+ *
+ **/
+
+#include "sat_result_reader.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+sat_result_reader_t::sat_result_reader_t(std::istream& in,
+													  const size_t buffer_size)
+	 :_in(in), _buffer(buffer_size > 0 ? buffer_size : 1), _pos(0), _end(0),
+	  _eof(false), _no_of_assigned(0)
+{}
+
+void
+sat_result_reader_t::skip_line() {
+  int c;
+  while (((c= peek()) != -1) && (c != '\n'))
+	 advance();
+  if (c == '\n')
+	 advance();
+}
+
+void
+sat_result_reader_t::read_word(std::string& word) {
+  word.clear();
+  int c;
+  while (((c= peek()) != -1) && (c != '\n') && !is_blank(c)) {
+	 word.push_back((char)c);
+	 advance();
+  }
+}
+
+void
+sat_result_reader_t::malformed(const std::string& why) {
+  throw std::logic_error("Malformed result of the SAT solver: " + why + ".");
+}
+
+bool
+sat_result_reader_t::read_literals(std::vector<bool>& vals,
+											  std::vector<bool>& assigned) {
+  const size_t n_vars= vals.size();
+  while (true) {
+	 skip_blanks();
+	 int c= peek();
+	 if ((c == -1) || (c == '\n'))
+		return false;
+	 bool negative= false;
+	 if (c == '-') {
+		negative= true;
+		advance();
+		c= peek();
+	 }
+	 if ((c < '0') || (c > '9'))
+		malformed("a literal was expected");
+	 size_t var= 0;
+	 while ((c >= '0') && (c <= '9')) {
+		var= var*10 + (size_t)(c - '0');
+		if (var > n_vars)
+		  malformed("the instance has only " + tostr(n_vars) + " variables");
+		advance();
+		c= peek();
+	 }
+	 if ((c != -1) && (c != '\n') && !is_blank(c))
+		malformed("a literal was expected");
+	 if (var == 0) {
+		skip_line();
+		return true;
+	 }
+	 --var;
+	 if (assigned[var]) {
+		if (vals[var] == negative)
+		  malformed("variable " + tostr(var+1) + " has conflicting values");
+	 } else {
+		assigned[var]= true;
+		vals[var]= !negative;
+		++_no_of_assigned;
+	 }
+  }
+}
+
+bool
+sat_result_reader_t::read(std::vector<bool>& vals, bool& decided) {
+  std::vector<bool> assigned(vals.size(), false);
+  std::fill(vals.begin(), vals.end(), false);
+  _no_of_assigned= 0;
+  decided= false;
+  bool is_sat= false;
+  bool minisat_format= false;
+  bool assignment_ended= false;
+  std::string word;
+  while (true) {
+	 skip_blanks();
+	 const int c= peek();
+	 if (c == -1)
+		break;
+	 if (c == '\n') {
+		advance();
+		continue;
+	 }
+	 if (minisat_format && is_sat && !assignment_ended &&
+		  (((c >= '0') && (c <= '9')) || (c == '-'))) {
+// The assignment line of the MiniSat format
+		assignment_ended= read_literals(vals, assigned);
+		continue;
+	 }
+	 read_word(word);
+	 if ((word == "s") || (word == "SAT") || (word == "UNSAT") || (word == "INDET")) {
+// Status line
+		minisat_format= (word != "s");
+		if (!minisat_format) {
+		  skip_blanks();
+		  read_word(word);
+		}
+		if ((word == "SATISFIABLE") || (word == "SAT")) {
+		  L_DEBUG("Satisfiable clauses. Reading assignment...");
+		  decided= true;
+		  is_sat= true;
+		} else if ((word == "UNSATISFIABLE") || (word == "UNSAT")) {
+		  L_DEBUG("UNSATISFIABLE clauses.");
+		  decided= true;
+		  is_sat= false;
+		} else {
+		  L_WARN("The SAT solver has not decided the instance ('" << word << "').");
+		}
+		skip_line();
+	 } else if ((word == "v") && !assignment_ended) {
+		assignment_ended= read_literals(vals, assigned);
+	 } else {
+// Comments and any other line
+		skip_line();
+	 }
+  }
+  if (decided && is_sat) {
+	 if (!assignment_ended)
+		malformed("the assignment does not end with 0");
+	 if (_no_of_assigned < vals.size()) {
+		L_WARN("The SAT solver has not assigned " <<
+				 (vals.size() - _no_of_assigned) << " variables out of " <<
+				 vals.size() << ".");
+	 } else {
+		L_DEBUG("All the " << vals.size() << " variables have been assigned.");
+	 }
+  }
+  return decided && is_sat;
+}
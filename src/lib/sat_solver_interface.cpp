@@ -36,18 +36,428 @@
 
 #ifdef INTERNAL_SAT_SOLVER
 
+#include "run_stats.hpp"
+
 #include "Vec.h"
 #include "SolverTypes.h"
 
+#include <limits>
+#include <map>
+#include <cstdlib>
+
+#include <signal.h>
+
 #include <boost/foreach.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/filesystem.hpp>
+
+
+SAT_solver_stats_t::SAT_solver_stats_t()
+	 :conflicts(0), decisions(0), propagations(0), restarts(0),
+	  clause_db_reductions(0),
+	  gauss_calls(0), gauss_conflicts(0), gauss_propagations(0),
+	  gauss_unit_truths(0),
+	  eliminated_vars(0), xor_eliminated_vars(0), replaced_vars(0),
+	  subsumer_time(0.0), xor_subsumer_time(0.0)
+{}
+
+void
+SAT_solver_stats_t::add_to_run_stats() const {
+  run_stats_t& rs= run_stats_t::get_run_stats();
+  rs.add_to_counter("solver_conflicts", conflicts);
+  rs.add_to_counter("solver_decisions", decisions);
+  rs.add_to_counter("solver_propagations", propagations);
+  rs.add_to_counter("solver_restarts", restarts);
+  rs.add_to_counter("solver_clause_db_reductions", clause_db_reductions);
+  rs.add_to_counter("solver_gauss_calls", gauss_calls);
+  rs.add_to_counter("solver_gauss_conflicts", gauss_conflicts);
+  rs.add_to_counter("solver_gauss_propagations", gauss_propagations);
+  rs.add_to_counter("solver_gauss_unit_truths", gauss_unit_truths);
+  rs.add_to_counter("solver_eliminated_vars", eliminated_vars);
+  rs.add_to_counter("solver_xor_eliminated_vars", xor_eliminated_vars);
+  rs.add_to_counter("solver_replaced_vars", replaced_vars);
+// Times are reported in milliseconds
+  rs.add_to_counter("solver_subsumer_time_ms",
+						  static_cast<long long>(subsumer_time * 1000));
+  rs.add_to_counter("solver_xor_subsumer_time_ms",
+						  static_cast<long long>(xor_subsumer_time * 1000));
+}
+
+SAT_solver_stats_t
+operator-(const SAT_solver_stats_t& s1, const SAT_solver_stats_t& s2) {
+  SAT_solver_stats_t d;
+  d.conflicts= s1.conflicts - s2.conflicts;
+  d.decisions= s1.decisions - s2.decisions;
+  d.propagations= s1.propagations - s2.propagations;
+  d.restarts= s1.restarts - s2.restarts;
+  d.clause_db_reductions= s1.clause_db_reductions - s2.clause_db_reductions;
+  d.gauss_calls= s1.gauss_calls - s2.gauss_calls;
+  d.gauss_conflicts= s1.gauss_conflicts - s2.gauss_conflicts;
+  d.gauss_propagations= s1.gauss_propagations - s2.gauss_propagations;
+  d.gauss_unit_truths= s1.gauss_unit_truths - s2.gauss_unit_truths;
+  d.eliminated_vars= s1.eliminated_vars - s2.eliminated_vars;
+  d.xor_eliminated_vars= s1.xor_eliminated_vars - s2.xor_eliminated_vars;
+  d.replaced_vars= s1.replaced_vars - s2.replaced_vars;
+  d.subsumer_time= s1.subsumer_time - s2.subsumer_time;
+  d.xor_subsumer_time= s1.xor_subsumer_time - s2.xor_subsumer_time;
+  return d;
+}
+
+std::ostream&
+operator<<(std::ostream& out, const SAT_solver_stats_t& stats) {
+  out << "conflicts: " << stats.conflicts <<
+	 ", decisions: " << stats.decisions <<
+	 ", propagations: " << stats.propagations <<
+	 ", restarts: " << stats.restarts <<
+	 ", clause-db reductions: " << stats.clause_db_reductions <<
+	 ", gauss calls/conflicts/propagations: " << stats.gauss_calls <<
+	 "/" << stats.gauss_conflicts << "/" << stats.gauss_propagations <<
+	 ", eliminated vars: " << stats.eliminated_vars <<
+	 " (xor: " << stats.xor_eliminated_vars << ")" <<
+	 ", replaced vars: " << stats.replaced_vars <<
+	 ", subsumer time: " << stats.subsumer_time << "s" <<
+	 " (xor: " << stats.xor_subsumer_time << "s)";
+  return out;
+}
+
+
+std::ostream&
+operator<<(std::ostream& out, const SAT_solver_progress_t& progress) {
+  out << "elapsed time: " << progress.elapsed_time << "s" <<
+	 ", conflicts: " << progress.conflicts <<
+	 " (" << static_cast<uint64_t>(progress.conflicts_per_second) << "/s)" <<
+	 ", restarts: " << progress.restarts <<
+	 " (" << progress.restart_type << ")" <<
+	 ", clauses: " << progress.clauses <<
+	 ", learnt clauses: " << progress.learnts;
+  return out;
+}
+
+
+// Set by 'request_interrupt' (possibly from a signal handler)
+static volatile sig_atomic_t interrupt_requested= 0;
+
+double SAT_solver_iface_t::_progress_interval= 10.0;
+SAT_solver_iface_t::progress_callback_t SAT_solver_iface_t::_progress_callback;
+std::string SAT_solver_iface_t::_cancel_file;
+bool SAT_solver_iface_t::_handle_signals= false;
+uint64_t SAT_solver_iface_t::_max_conflicts= 0;
+double SAT_solver_iface_t::_timeout= 0.0;
+long SAT_solver_iface_t::_max_memory_kb= 0;
+
+
+// Thread shared by the running solves that asks a solver to stop (cleanly)
+// when its deadline has passed, when the process uses more than the given
+// memory, when an interruption has been requested, or when the cancel file
+// exists.
+// It is started by the first watched solve and it waits (without polling)
+// while no solve is watched.
+class solver_watchdog_t:
+  public log_able_t<solver_watchdog_t>,
+  boost::noncopyable
+{
+private:
+
+  class watched_t {
+  public:
+	 double deadline;
+	 long max_memory_kb;
+	 std::string cancel_file;
+	 bool interrupted;
+
+	 watched_t(const double deadline_,
+				  const long max_memory_kb_,
+				  const std::string& cancel_file_)
+		  :deadline(deadline_), max_memory_kb(max_memory_kb_),
+			cancel_file(cancel_file_), interrupted(false)
+	 {};
+  };
+
+  typedef std::map<Solver*, watched_t> solvers_t;
+
+  boost::mutex _mutex;
+  boost::condition_variable _cond;
+  solvers_t _solvers;
+  bool _stop;
+  boost::thread* _thread;
+
+  solver_watchdog_t()
+		:_stop(false), _thread(NULL)
+  {};
+
+  bool budget_exhausted(const watched_t& w,
+								const double now,
+								const long rss_kb) const {
+	 if (interrupt_requested) {
+		L_WARN("Interruption requested. Interrupting the SAT solver...");
+		return true;
+	 }
+	 if (!w.cancel_file.empty() && boost::filesystem::exists(w.cancel_file)) {
+		L_WARN("Cancel file '" << w.cancel_file << "' found. "
+				 "Interrupting the SAT solver...");
+		return true;
+	 }
+	 if ((w.deadline > 0.0) && (now >= w.deadline)) {
+		L_WARN("Time limit reached. Interrupting the SAT solver...");
+		return true;
+	 }
+	 if ((w.max_memory_kb > 0) && (rss_kb >= w.max_memory_kb)) {
+		L_WARN("Memory limit reached (" << rss_kb <<
+				 "kB). Interrupting the SAT solver...");
+		return true;
+	 }
+	 return false;
+  };
+
+// Check the budgets of the watched solvers (the mutex must be held)
+  void check_budgets() {
+	 const double now= run_stats_t::wall_time();
+	 const long rss_kb= run_stats_t::current_rss_kb();
+	 for (solvers_t::iterator it= _solvers.begin(); it != _solvers.end(); ++it) {
+		if (!it->second.interrupted && budget_exhausted(it->second, now, rss_kb)) {
+		  it->second.interrupted= true;
+		  it->first->needToInterrupt= true;
+		}
+	 }
+  };
+
+public:
+
+  ~solver_watchdog_t() {
+	 if (_thread != NULL) {
+		{
+		  boost::mutex::scoped_lock lock(_mutex);
+		  _stop= true;
+		}
+		_cond.notify_all();
+		_thread->join();
+		delete _thread;
+	 }
+  };
+
+  static solver_watchdog_t&
+  get_watchdog() {
+	 static solver_watchdog_t watchdog;
+	 return watchdog;
+  };
+
+  void watch(Solver& solver,
+				 const double deadline,
+				 const long max_memory_kb,
+				 const std::string& cancel_file) {
+	 boost::mutex::scoped_lock lock(_mutex);
+	 _solvers.insert(std::make_pair(&solver,
+											  watched_t(deadline, max_memory_kb, cancel_file)));
+	 if (_thread == NULL) {
+		_thread= new boost::thread(boost::ref(*this));
+	 }
+	 _cond.notify_all();
+  };
+
+  void unwatch(Solver& solver) {
+	 boost::mutex::scoped_lock lock(_mutex);
+	 _solvers.erase(&solver);
+  };
+
+  void operator()() {
+	 boost::mutex::scoped_lock lock(_mutex);
+	 while (!_stop) {
+		if (_solvers.empty()) {
+		  _cond.wait(lock);
+		} else {
+		  check_budgets();
+		  _cond.timed_wait(lock, boost::posix_time::milliseconds(50));
+		}
+	 }
+  };
+
+};
+
+
+// Watch a solver (if it has some budget that has to be checked while it
+// runs) while it is alive
+class solver_watch_t:
+  boost::noncopyable
+{
+private:
+  Solver& _solver;
+  const bool _watched;
+
+public:
+  solver_watch_t(Solver& solver,
+					  const double deadline,
+					  const long max_memory_kb,
+					  const std::string& cancel_file,
+					  const bool handle_signals)
+		:_solver(solver),
+		 _watched((deadline > 0.0) || (max_memory_kb > 0) ||
+					 !cancel_file.empty() || handle_signals || interrupt_requested)
+  {
+	 if (_watched) {
+		solver_watchdog_t::get_watchdog().watch(_solver, deadline,
+															 max_memory_kb, cancel_file);
+	 }
+  };
+
+  ~solver_watch_t() {
+	 if (_watched) {
+		solver_watchdog_t::get_watchdog().unwatch(_solver);
+	 }
+  };
+};
+
+
+void
+SAT_solver_iface_t::set_budgets(const uint64_t max_conflicts,
+										  const double timeout,
+										  const size_t max_memory_mb) {
+  _max_conflicts= max_conflicts;
+  _timeout= timeout;
+  _max_memory_kb= max_memory_mb * 1024;
+}
+
+void
+SAT_solver_iface_t::request_interrupt() {
+  interrupt_requested= 1;
+}
+
+bool
+SAT_solver_iface_t::is_interrupt_requested() {
+  return interrupt_requested != 0;
+}
+
+void
+SAT_solver_iface_t::clear_interrupt_request() {
+  interrupt_requested= 0;
+}
+
+static void
+interrupt_signal_handler(int sig) {
+  SAT_solver_iface_t::request_interrupt();
+// A second signal terminates the program
+  signal(sig, SIG_DFL);
+}
+
+void
+SAT_solver_iface_t::handle_signals() {
+  _handle_signals= true;
+  signal(SIGINT, interrupt_signal_handler);
+  signal(SIGTERM, interrupt_signal_handler);
+}
+
+static void
+report_solver_progress(void* data) {
+  static_cast<SAT_solver_iface_t*>(data)->report_progress();
+}
+
+SAT_solver_iface_t::SAT_solver_iface_t()
+	 :_solver(new Solver()), _solved(false), _sat(false), _incremental(false),
+	  _interrupted(false), _solve_start(run_stats_t::wall_time()),
+	  _last_progress(_solve_start)
+{
+  _solver->restartCallback= report_solver_progress;
+  _solver->restartCallbackData= this;
+}
+
+SAT_solver_stats_t
+SAT_solver_iface_t::statistics() const {
+  SAT_solver_stats_t stats;
+  stats.conflicts= _solver->conflicts;
+  stats.decisions= _solver->decisions;
+  stats.propagations= _solver->propagations;
+  stats.restarts= _solver->starts;
+  stats.clause_db_reductions= _solver->nbReduceDB;
+#ifdef USE_GAUSS
+  stats.gauss_calls= _solver->get_sum_gauss_called();
+  stats.gauss_conflicts= _solver->get_sum_gauss_confl();
+  stats.gauss_propagations= _solver->get_sum_gauss_prop();
+  stats.gauss_unit_truths= _solver->get_sum_gauss_unit_truths();
+#endif
+  stats.eliminated_vars= _solver->getNumElimSubsume();
+  stats.xor_eliminated_vars= _solver->getNumElimXorSubsume();
+  stats.replaced_vars= _solver->getNumXorTreesCrownSize();
+  stats.subsumer_time= _solver->getTotalTimeSubsumer();
+  stats.xor_subsumer_time= _solver->getTotalTimeXorSubsumer();
+  return stats;
+}
+
+SAT_solver_progress_t
+SAT_solver_iface_t::progress() const {
+  SAT_solver_progress_t progress;
+  progress.elapsed_time= run_stats_t::wall_time() - _solve_start;
+  progress.conflicts= _solver->conflicts;
+  progress.conflicts_per_second= (progress.elapsed_time > 0.0) ?
+	 ((_solver->conflicts - _reported.conflicts) / progress.elapsed_time) : 0.0;
+  progress.restarts= _solver->starts;
+  progress.clauses= _solver->nClauses();
+  progress.learnts= _solver->nLearnts();
+  progress.restart_type=
+	 (_solver->getRestartType() == static_restart) ? "static" : "dynamic";
+  return progress;
+}
+
+void
+SAT_solver_iface_t::report_progress() {
+  if (interrupt_requested) {
+	 _solver->needToInterrupt= true;
+  }
+  if (_progress_interval <= 0.0)
+	 return;
+  const double now= run_stats_t::wall_time();
+  if (now - _last_progress >= _progress_interval) {
+	 _last_progress= now;
+	 if (_progress_callback) {
+		_progress_callback(progress());
+	 } else {
+		L_INFO("Solving... " << progress() << " -- " << statistics());
+	 }
+  }
+}
+
+lbool
+SAT_solver_iface_t::run_solver(const vec<Lit>& assumps) {
+  _solve_start= run_stats_t::wall_time();
+  _last_progress= _solve_start;
+  _solver->needToInterrupt= false;
+  _solver->maxConflicts= (_max_conflicts > 0) ?
+	 (_solver->conflicts + _max_conflicts) :
+	 std::numeric_limits<uint64_t>::max();
+  lbool ret;
+  {
+	 const double deadline= (_timeout > 0.0) ? (_solve_start + _timeout) : 0.0;
+	 solver_watch_t watch(*_solver, deadline, _max_memory_kb,
+								 _cancel_file, _handle_signals);
+	 ret= _solver->solve(assumps);
+  }
+  report_statistics();
+  _interrupted= (ret == l_Undef);
+  if (_interrupted) {
+	 run_stats_t::get_run_stats().add_to_counter("solver_interruptions", 1);
+	 L_WARN("The internal SAT solver has been interrupted after " <<
+			  _solver->conflicts << " conflicts.");
+  }
+  return ret;
+}
+
+void
+SAT_solver_iface_t::report_statistics() {
+  const SAT_solver_stats_t stats= statistics();
+  L_DEBUG("Statistics of the internal SAT solver: " << (stats - _reported));
+  (stats - _reported).add_to_run_stats();
+  _reported= stats;
+}
 
 void
 SAT_solver_iface_t::add_clause(const std::set<int>& clause) {
   L_TRACE("Adding a clause to the solver...");
   if (_solved) {
-	 L_ERROR("Impossible to add a clause to an already solved instance! Abort.");
-	 MY_FAIL;
-	 return;
+	 if (!_incremental) {
+		L_ERROR("Impossible to add a clause to an already solved instance! Abort.");
+		MY_FAIL;
+		return;
+	 }
+	 _solved= false;
   }
   vec<Lit> sc;
   BOOST_FOREACH( int lit, clause ) {
@@ -58,13 +468,59 @@ SAT_solver_iface_t::add_clause(const std::set<int>& clause) {
   _solver->addClause(sc);
 };
 
+void
+SAT_solver_iface_t::set_polarities(const std::vector<bool>& vals) {
+  _solver->polarity_mode= Solver::polarity_user;
+  for (size_t var= 0; var < vals.size(); ++var) {
+	 while (var >= _solver->nVars()) _solver->newVar();
+// The polarity is the sign of the preferred literal
+	 _solver->setPolarity(var, !vals[var]);
+  }
+};
+
+void
+SAT_solver_iface_t::learnt_clauses(std::vector< std::vector<int> >& clauses,
+											  const size_t max_size) const {
+  clauses.clear();
+  std::vector< std::vector<Lit> > learnts;
+  _solver->getLearntClauses(learnts, max_size);
+  clauses.reserve(learnts.size());
+  BOOST_FOREACH( const std::vector<Lit>& learnt, learnts ) {
+	 std::vector<int> clause;
+	 clause.reserve(learnt.size());
+	 BOOST_FOREACH( const Lit& lit, learnt ) {
+		const int var= lit.var() + 1;
+		clause.push_back(lit.sign() ? -var : var);
+	 }
+	 clauses.push_back(clause);
+  }
+  L_DEBUG("Got " << clauses.size() << " learnt clauses.");
+};
+
+void
+SAT_solver_iface_t::add_learnt_clause(const std::vector<int>& clause) {
+  MY_ASSERT( !_solved );
+  if (!_solver->okay())
+	 return;
+  vec<Lit> sc;
+  BOOST_FOREACH( int lit, clause ) {
+	 unsigned int var= std::abs(lit)-1;
+	 while (var >= _solver->nVars()) _solver->newVar();
+	 sc.push( Lit( var, lit<0 ) );
+  }
+  _solver->addLearntClause(sc, sc.size(), 0.0, 0);
+};
+
 void
 SAT_solver_iface_t::add_xor_clause(const std::set<int>& clause) {
   L_TRACE("Adding a xor-clause to the solver...");
   if (_solved) {
-	 L_ERROR("Impossible to add a xor-clause to an already solved instance! Abort.");
-	 MY_FAIL;
-	 return;
+	 if (!_incremental) {
+		L_ERROR("Impossible to add a xor-clause to an already solved instance! Abort.");
+		MY_FAIL;
+		return;
+	 }
+	 _solved= false;
   }
   vec<Lit> sc;
   bool sign= false;
@@ -77,14 +533,43 @@ SAT_solver_iface_t::add_xor_clause(const std::set<int>& clause) {
   _solver->addXorClause(sc, sign);
 };
 
+void
+SAT_solver_iface_t::reserve_vars(const size_t n_vars) {
+  while (_solver->nVars() < n_vars) _solver->newVar();
+};
+
+void
+SAT_solver_iface_t::add_clause(const int* lits, const size_t n) {
+  MY_ASSERT( !_solved );
+  vec<Lit> sc((uint32_t)n);
+  for (size_t i= 0; i < n; ++i) {
+	 MY_ASSERT_DBG( (uint32_t)std::abs(lits[i]) <= _solver->nVars() );
+	 sc[i]= Lit( std::abs(lits[i])-1, lits[i]<0 );
+  }
+  _solver->addClause(sc);
+};
+
+void
+SAT_solver_iface_t::add_xor_clause(const int* lits, const size_t n) {
+  MY_ASSERT( !_solved );
+  vec<Lit> sc((uint32_t)n);
+  bool sign= false;
+  for (size_t i= 0; i < n; ++i) {
+	 MY_ASSERT_DBG( (uint32_t)std::abs(lits[i]) <= _solver->nVars() );
+	 sc[i]= Lit( std::abs(lits[i])-1, false );
+	 sign ^= (lits[i]<0);
+  }
+  _solver->addXorClause(sc, sign);
+};
+
 bool
 SAT_solver_iface_t::solve() {
-  if (_solved) {
+  if (_solved && !_interrupted) {
 	 L_DEBUG("Instance already solved. Skipping...");
   } else {
 	 L_DEBUG("Solving the SAT instance using the internal SAT solver '"
 				<< BOOST_PP_STRINGIZE(SAT_SOLVER) << "'...");
-	 const lbool ret= _solver->solve();
+	 const lbool ret= run_solver(vec<Lit>());
 	 L_DEBUG("...finished!");
 	 L_DEBUG("The internal SAT solver gave: " <<
 				( (ret == l_True) ?
@@ -104,6 +589,38 @@ SAT_solver_iface_t::solve() {
   return _sat;
 };
 
+bool
+SAT_solver_iface_t::solve(const std::vector<int>& assumptions) {
+  L_DEBUG("Solving the SAT instance under " << assumptions.size() <<
+			 " assumptions using the internal SAT solver '"
+			 << BOOST_PP_STRINGIZE(SAT_SOLVER) << "'...");
+  _solver->doVarElim= false;
+  _solver->doBlockedClause= false;
+  _solver->doPartHandler= false;
+  _solver->doReplace= false;
+  vec<Lit> assumps;
+  BOOST_FOREACH( int lit, assumptions ) {
+	 unsigned int var= std::abs(lit)-1;
+	 while (var >= _solver->nVars()) _solver->newVar();
+	 assumps.push( Lit( var, lit<0 ) );
+  }
+  const lbool ret= run_solver(assumps);
+  L_DEBUG("...finished!");
+  _sat= (ret == l_True);
+  _solved= true;
+  return _sat;
+};
+
+void
+SAT_solver_iface_t::conflict(std::vector<int>& lits) const {
+  MY_ASSERT( _solved && !_sat && !_interrupted );
+  lits.clear();
+  for (uint32_t i= 0; i < _solver->conflict.size(); ++i) {
+	 const Lit& lit= _solver->conflict[i];
+	 lits.push_back(lit.sign() ? -(int)(lit.var()+1) : (int)(lit.var()+1));
+  }
+};
+
 
 bool
 SAT_solver_iface_t::model(const unsigned int var) const {
@@ -120,4 +637,17 @@ SAT_solver_iface_t::model(const unsigned int var) const {
   return _solver->model[var] == l_True;
 };
 
+void
+SAT_solver_iface_t::model(std::vector<bool>& vals) const {
+  if (!_solved || !_sat) {
+	 L_ERROR("The instance has not yet solved or it is not satisfiable!");
+	 MY_FAIL;
+  }
+  MY_ASSERT( _solver->model.size() <= vals.size() );
+  const lbool* model= _solver->model.getData();
+  for (uint32_t var= 0; var < _solver->model.size(); ++var) {
+	 vals[var]= (model[var] == l_True);
+  }
+};
+
 #endif
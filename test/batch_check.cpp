@@ -0,0 +1,110 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "test_pedigrees.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+using namespace std;
+
+#ifdef INTERNAL_SAT_SOLVER
+
+static void
+write_file(const boost::filesystem::path& name, const string& content) {
+  ofstream os(name.string().c_str());
+  os << content;
+}
+
+typedef temp_path_test_t batch_test;
+
+TEST_F(batch_test, solve_batch) {
+  const boost::filesystem::path& dir= tmp_path;
+  boost::filesystem::create_directories(dir / "in");
+  write_file(dir / "in" / "b-feasible.txt", FEASIBLE_PEDIGREE_STR);
+  write_file(dir / "in" / "a-inconsistent.txt", INCONSISTENT_PEDIGREE_STR);
+
+  vector<string> inputs;
+  zrhcstar_t::list_batch_inputs((dir / "in").string(), inputs);
+  ASSERT_EQ( 2u, inputs.size() );
+  ASSERT_EQ( (dir / "in" / "a-inconsistent.txt").string(), inputs[0] );
+
+// The manifest lists also a missing file
+  write_file(dir / "manifest.txt",
+				 "# pedigrees\n" + inputs[1] + "\n\n" + inputs[0] + "\n" +
+				 (dir / "in" / "missing.txt").string() + "\n");
+  zrhcstar_t::list_batch_inputs((dir / "manifest.txt").string(), inputs);
+  ASSERT_EQ( 3u, inputs.size() );
+
+  vector<zrhcstar_t::batch_job_t> jobs;
+  for (size_t i= 0; i < inputs.size(); ++i) {
+	 jobs.push_back(zrhcstar_t::batch_job_t(inputs[i],
+														 (dir / ("hap-" + tostr(i))).string()));
+  }
+  zrhcstar_t zrhcstar;
+  zrhcstar.solve_batch(jobs, 2, false, false);
+  ASSERT_EQ( "ZRHC", jobs[0].status );
+  ASSERT_TRUE( boost::filesystem::exists(jobs[0].haplotypes) );
+  ASSERT_EQ( "NO_ZRHC", jobs[1].status );
+  ASSERT_FALSE( boost::filesystem::exists(jobs[1].haplotypes) );
+  ASSERT_EQ( "ERROR", jobs[2].status );
+// The size of the instance is the one of each job
+  const size_t variables= jobs[0].variables;
+  ASSERT_LT( 0u, variables );
+  ASSERT_LT( 0u, jobs[0].clauses );
+  ASSERT_EQ( 0u, jobs[1].variables );
+  ASSERT_EQ( 0u, jobs[2].variables );
+
+  ostringstream status;
+  zrhcstar_t::write_batch_status(status, jobs);
+  istringstream is(status.str());
+  string line;
+  size_t n_lines= 0;
+  while (getline(is, line)) ++n_lines;
+  ASSERT_EQ( 4u, n_lines );
+  ASSERT_LT( 0.0, jobs[0].estimate.memory_mb );
+  ASSERT_EQ( 0.0, jobs[2].estimate.memory_mb );
+
+// A budget smaller than every job does not prevent solving them
+  for (size_t i= 0; i < jobs.size(); ++i) {
+	 boost::filesystem::remove(jobs[i].haplotypes);
+	 jobs[i].status= "NOT_RUN";
+  }
+  zrhcstar.solve_batch(jobs, 2, false, false, 1e-6);
+  ASSERT_EQ( "ZRHC", jobs[0].status );
+  ASSERT_TRUE( boost::filesystem::exists(jobs[0].haplotypes) );
+  ASSERT_EQ( "NO_ZRHC", jobs[1].status );
+  ASSERT_EQ( "ERROR", jobs[2].status );
+  ASSERT_EQ( variables, jobs[0].variables );
+}
+
+#endif // INTERNAL_SAT_SOLVER
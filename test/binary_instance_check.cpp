@@ -0,0 +1,200 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "binary_instance.hpp"
+#include "test_pedigrees.hpp"
+
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+
+using namespace std;
+
+class binary_instance_test: public temp_path_test_t {
+protected:
+  pedcnf_t* create(const zrhcstar_t& zrhcstar, mped_t& ped) {
+	 read_pedigree(FEASIBLE_PEDIGREE_STR, ped, zrhcstar);
+	 ofstream os(file().c_str(), ios::out | ios::binary);
+	 pedcnf_t* cnf;
+	 zrhcstar.create_binary_SAT_instance(ped, os, cnf);
+	 return cnf;
+  }
+
+  string file() const {
+	 return tmp_path.string();
+  }
+};
+
+static void
+check_clauses(const set< set<int> >& clauses,
+				  const vector< const boost::int32_t* >& begins,
+				  const vector< const boost::int32_t* >& ends) {
+  set< set<int> > read_clauses;
+  for (size_t i= 0; i < begins.size(); ++i) {
+	 read_clauses.insert(set<int>(begins[i], ends[i]));
+  }
+  ASSERT_EQ(clauses.size(), read_clauses.size());
+  ASSERT_TRUE(clauses == read_clauses);
+}
+
+TEST_F(binary_instance_test, write_and_map) {
+  for (int extended= 0; extended < 2; ++extended) {
+	 zrhcstar_t zrhcstar(extended == 1);
+	 mped_t ped;
+	 pedcnf_t* cnf= create(zrhcstar, ped);
+	 ASSERT_TRUE(binary_instance_t::is_binary_instance(file()));
+	 const binary_instance_t instance(file());
+	 ASSERT_EQ(cnf->vars().size(), instance.no_of_vars());
+	 ASSERT_EQ(cnf->clauses().size(), instance.no_of_clauses());
+	 ASSERT_EQ(cnf->no_of_xor_clauses(), instance.no_of_xor_clauses());
+	 for (size_t i= 0; i < instance.no_of_vars(); ++i) {
+		ASSERT_EQ(tostr(cnf->vars()[i]), tostr(instance.var(i)));
+	 }
+	 vector< const boost::int32_t* > begins, ends;
+	 for (size_t i= 0; i < instance.no_of_clauses(); ++i) {
+		begins.push_back(instance.clause_begin(i));
+		ends.push_back(instance.clause_end(i));
+	 }
+	 check_clauses(cnf->clauses(), begins, ends);
+	 if (extended == 1) {
+		ASSERT_LT(0u, instance.no_of_xor_clauses());
+		begins.clear();
+		ends.clear();
+		for (size_t i= 0; i < instance.no_of_xor_clauses(); ++i) {
+		  begins.push_back(instance.xor_clause_begin(i));
+		  ends.push_back(instance.xor_clause_end(i));
+		}
+		check_clauses(dynamic_cast<pedcnf_ext_t*>(cnf)->xor_clauses(),
+						  begins, ends);
+	 }
+	 delete cnf;
+  }
+}
+
+TEST_F(binary_instance_test, invalid_files) {
+  {
+	 ofstream os(file().c_str());
+	 os << "p cnf 1 1\n1 0\n";
+  }
+  ASSERT_FALSE(binary_instance_t::is_binary_instance(file()));
+  ASSERT_THROW({ binary_instance_t instance(file()); }, std::logic_error);
+// Truncated instance
+  {
+	 zrhcstar_t zrhcstar;
+	 mped_t ped;
+	 delete create(zrhcstar, ped);
+  }
+  boost::filesystem::resize_file(file(), boost::filesystem::file_size(file()) - 8);
+  ASSERT_TRUE(binary_instance_t::is_binary_instance(file()));
+  ASSERT_THROW({ binary_instance_t instance(file()); }, std::logic_error);
+}
+
+#ifdef INTERNAL_SAT_SOLVER
+
+TEST_F(binary_instance_test, solve) {
+  for (int extended= 0; extended < 2; ++extended) {
+	 zrhcstar_t zrhcstar(extended == 1);
+	 mped_t ped;
+	 pedcnf_t* cnf= create(zrhcstar, ped);
+	 ostringstream res_os;
+	 ASSERT_EQ("SAT", zrhcstar.solve_SAT_instance(file(), res_os));
+	 istringstream res_is(res_os.str());
+	 ASSERT_TRUE(cnf->assignment_from_minisat_format(res_is));
+	 ASSERT_TRUE(cnf->is_satisfying_assignment());
+	 ASSERT_TRUE(zrhcstar.compute_HC_from_model(ped, cnf));
+	 delete cnf;
+  }
+}
+
+// The result of an interrupted solver cannot be read back
+TEST_F(binary_instance_test, read_undecided) {
+  zrhcstar_t zrhcstar;
+  mped_t ped;
+  pedcnf_t* cnf= create(zrhcstar, ped);
+  istringstream res_is("INDET\n");
+  ASSERT_THROW(zrhcstar.compute_HC_from_SAT_results(res_is, ped, cnf),
+					std::logic_error);
+  delete cnf;
+}
+
+// The instance stating that holes+1 pigeons fit in 'holes' holes
+static void
+pigeonhole(const int holes,
+			  pedcnf_t::varvec_t& vars, binary_instance_t::clauses_t& clauses) {
+  for (int p= 0; p <= holes; ++p) {
+	 for (int h= 0; h < holes; ++h) {
+		vars.push_back(boost::make_tuple(ped_var_kind::DUMMY, p, h));
+	 }
+  }
+  for (int p= 0; p <= holes; ++p) {
+	 set<int> clause;
+	 for (int h= 0; h < holes; ++h)
+		clause.insert(p*holes + h + 1);
+	 clauses.insert(clause);
+  }
+  for (int h= 0; h < holes; ++h) {
+	 for (int p1= 0; p1 <= holes; ++p1) {
+		for (int p2= p1+1; p2 <= holes; ++p2) {
+		  set<int> clause;
+		  clause.insert(-(p1*holes + h + 1));
+		  clause.insert(-(p2*holes + h + 1));
+		  clauses.insert(clause);
+		}
+	 }
+  }
+}
+
+// The same instance is solved again with a different budget
+TEST_F(binary_instance_test, solve_with_budget) {
+  pedcnf_t::varvec_t vars;
+  binary_instance_t::clauses_t clauses;
+  pigeonhole(7, vars, clauses);
+  {
+	 ofstream os(file().c_str(), ios::out | ios::binary);
+	 binary_instance_t::write(os, vars, clauses, binary_instance_t::clauses_t());
+  }
+  zrhcstar_t zrhcstar;
+  SAT_solver_iface_t::set_budgets(10, 0.0, 0);
+  ostringstream res_os;
+  ASSERT_EQ("UNDEF", zrhcstar.solve_SAT_instance(file(), res_os));
+  ASSERT_EQ("INDET\n", res_os.str());
+  SAT_solver_iface_t::set_budgets(0, 0.0, 0);
+  res_os.str("");
+  ASSERT_EQ("UNSAT", zrhcstar.solve_SAT_instance(file(), res_os));
+  ASSERT_EQ("UNSAT\n", res_os.str());
+}
+
+#endif // INTERNAL_SAT_SOLVER
+
+#endif // ONLY_INTERNAL_SAT_SOLVER
@@ -0,0 +1,106 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "clause_buffer.hpp"
+
+#include <set>
+#include <vector>
+
+using namespace std;
+
+static set<int>
+make_clause(const int l1, const int l2= 0, const int l3= 0) {
+  set<int> clause;
+  if (l1 != 0) clause.insert(l1);
+  if (l2 != 0) clause.insert(l2);
+  if (l3 != 0) clause.insert(l3);
+  return clause;
+}
+
+TEST(clause_buffer, clauses) {
+  clause_buffer_t buffer;
+  buffer.add_clause(make_clause(1, -2));
+  buffer.add_clause(make_clause(2, 3));
+  buffer.add_clause(make_clause(-1, -3));
+  ASSERT_EQ( 3u, buffer.no_of_clauses() );
+
+// Variable v is in position v
+  clause_buffer_t::value_table_t vals(4, 0);
+  vals[1]= 1; vals[2]= 1; vals[3]= 0;
+  ASSERT_TRUE( buffer.is_satisfied_by(vals) );
+  vals[3]= 1;
+  ASSERT_FALSE( buffer.is_satisfied_by(vals) );
+
+  buffer.add_clause(set<int>());
+  vals[3]= 0;
+  ASSERT_FALSE( buffer.is_satisfied_by(vals) );
+}
+
+TEST(clause_buffer, xor_clauses) {
+  clause_buffer_t buffer(true);
+  buffer.add_clause(make_clause(1, 2, 3));
+  buffer.add_clause(make_clause(-1, 2));
+  clause_buffer_t::value_table_t vals(4, 0);
+  vals[1]= 1; vals[2]= 1; vals[3]= 0;
+  ASSERT_FALSE( buffer.is_satisfied_by(vals) );
+  vals[1]= 0; vals[2]= 0; vals[3]= 1;
+  ASSERT_TRUE( buffer.is_satisfied_by(vals) );
+  vals[1]= 1; vals[2]= 0; vals[3]= 0;
+  ASSERT_FALSE( buffer.is_satisfied_by(vals) );
+}
+
+TEST(clause_buffer, threads) {
+  const int n= 1000;
+  clause_buffer_t buffer;
+  for (int v= 1; v < n; ++v) {
+	 buffer.add_clause(make_clause(-v, v+1));
+  }
+  clause_buffer_t::value_table_t vals(n+1, 1);
+  vals[0]= 0;
+  for (unsigned int n_threads= 1; n_threads <= 4; ++n_threads) {
+	 vals[n]= 1;
+	 ASSERT_TRUE( buffer.is_satisfied_by(vals, n_threads) );
+	 vals[n]= 0;
+	 ASSERT_FALSE( buffer.is_satisfied_by(vals, n_threads) );
+  }
+}
+
+TEST(clause_buffer, set_of_clauses) {
+  set< set<int> > clauses;
+  clauses.insert(make_clause(1, -2));
+  clauses.insert(make_clause(2, 3));
+  clauses.insert(make_clause(1, -2));
+  clause_buffer_t buffer;
+  buffer.add_clauses(clauses);
+  ASSERT_EQ( 2u, buffer.no_of_clauses() );
+  clause_buffer_t::value_table_t vals(4, 0);
+  vals[1]= 1; vals[3]= 1;
+  ASSERT_TRUE( buffer.is_satisfied_by(vals, 2) );
+  vals[3]= 0;
+  ASSERT_FALSE( buffer.is_satisfied_by(vals, 2) );
+}
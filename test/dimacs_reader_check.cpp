@@ -0,0 +1,182 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "dimacs_reader.hpp"
+#include "test_pedigrees.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#ifdef INTERNAL_SAT_SOLVER
+
+using namespace std;
+
+static void
+load(const string& instance, SAT_solver_iface_t& solver, dimacs_reader_t& reader) {
+  reader.load(instance.data(), instance.data() + instance.size(), solver);
+}
+
+TEST(dimacs_reader, clauses) {
+  SAT_solver_iface_t solver;
+  dimacs_reader_t reader;
+  load("c comment\n"
+		 "c v 1 h_0_0\n"
+		 "p cnf 3 4\n"
+		 "1 2 0\n"
+		 "-1\t-2 0 -2\n"
+		 "3 0\r\n"
+		 "x1 -3 0\n", solver, reader);
+  ASSERT_EQ(3u, reader.no_of_vars());
+  ASSERT_EQ(3u, reader.no_of_clauses());
+  ASSERT_EQ(1u, reader.no_of_xor_clauses());
+  ASSERT_TRUE(solver.solve());
+  vector<bool> vals(3);
+  solver.model(vals);
+// Clause '-2 3' and xor-clause 'x1 -3' (i.e. var1 = var3)
+  ASSERT_TRUE(vals[0]);
+  ASSERT_FALSE(vals[1]);
+  ASSERT_TRUE(vals[2]);
+}
+
+TEST(dimacs_reader, unsatisfiable) {
+  SAT_solver_iface_t solver;
+  dimacs_reader_t reader;
+  load("p cnf 2 3\n1 0\n-1 2 0\nx 1 2 0\n", solver, reader);
+  ASSERT_FALSE(solver.solve());
+}
+
+// The trailer of the SATLIB instances
+TEST(dimacs_reader, satlib_trailer) {
+  SAT_solver_iface_t solver;
+  dimacs_reader_t reader;
+  load("c SATLIB\np cnf 3 2\n 1 -2 0\n 2 3 0\n%\n0\n\n", solver, reader);
+  ASSERT_EQ(2u, reader.no_of_clauses());
+  ASSERT_TRUE(solver.solve());
+}
+
+// The variables are created only when they are used
+TEST(dimacs_reader, large_declaration) {
+  SAT_solver_iface_t solver;
+  dimacs_reader_t reader;
+  load("p cnf 2000000000 2\n1 -2 0\n2 0\n", solver, reader);
+  ASSERT_EQ(2000000000u, reader.no_of_vars());
+  ASSERT_GE(100u, solver.no_of_vars());
+  ASSERT_TRUE(solver.solve());
+}
+
+TEST(dimacs_reader, malformed) {
+  const char* instances[]= {
+	 "1 2 0\n",
+	 "p dnf 2 1\n1 2 0\n",
+	 "p cnf 2\n1 2 0\n",
+	 "p cnf 2 1\n1 3 0\n",
+	 "p cnf 2 1\n1 2\n",
+	 "p cnf 2 1\n1 a2 0\n",
+	 "p cnf 2 1\np cnf 2 1\n",
+	 "p cnf 4000000000 1\n1 0\n",
+	 "p cnf 99999999999999999999999 1\n1 0\n",
+	 "p cnf 2 99999999999999999999999\n1 0\n",
+	 "p cnf 2 1\n99999999999999999999999 0\n",
+	 ""
+  };
+  for (size_t i= 0; i < sizeof(instances)/sizeof(instances[0]); ++i) {
+	 SAT_solver_iface_t solver;
+	 dimacs_reader_t reader;
+	 ASSERT_THROW({ load(instances[i], solver, reader); }, std::logic_error) <<
+		"Instance: " << instances[i];
+  }
+}
+
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+
+typedef temp_path_test_t dimacs_reader_test;
+
+// Solve the instances saved by '--create' (DIMACS, with xor-clauses, and
+// compressed) and read the results as '--read' does
+TEST_F(dimacs_reader_test, solve_SAT_instance) {
+  const string file= tmp_path.string();
+  for (int extended= 0; extended < 2; ++extended) {
+	 for (int compressed= 0; compressed < 2; ++compressed) {
+		zrhcstar_t zrhcstar(extended == 1);
+		mped_t ped;
+		read_pedigree(FEASIBLE_PEDIGREE_STR, ped, zrhcstar);
+		pedcnf_t* cnf;
+		{
+		  file_utility::postream sat_os=
+			 file_utility::get_file_utility().get_ofstream(file, compressed == 1);
+		  zrhcstar.create_SAT_instance(ped, *sat_os, vector<string>(1, "test"), cnf);
+		}
+		ostringstream res_os;
+		ASSERT_EQ("SAT", zrhcstar.solve_SAT_instance(file, res_os));
+		istringstream res_is(res_os.str());
+		ASSERT_TRUE(cnf->assignment_from_minisat_format(res_is));
+		ASSERT_TRUE(cnf->is_satisfying_assignment());
+		ASSERT_TRUE(zrhcstar.compute_HC_from_model(ped, cnf));
+		delete cnf;
+	 }
+  }
+}
+
+// The same instance is solved again with a different budget
+TEST_F(dimacs_reader_test, solve_with_budget) {
+  const string file= tmp_path.string();
+  {
+	 const int holes= 7;
+	 ofstream os(file.c_str());
+	 os << "p cnf " << (holes+1)*holes << " " <<
+		(holes+1) + holes*(holes+1)*holes/2 << "\n";
+	 for (int p= 0; p <= holes; ++p) {
+		for (int h= 0; h < holes; ++h)
+		  os << (p*holes + h + 1) << " ";
+		os << "0\n";
+	 }
+	 for (int h= 0; h < holes; ++h) {
+		for (int p1= 0; p1 <= holes; ++p1) {
+		  for (int p2= p1+1; p2 <= holes; ++p2) {
+			 os << -(p1*holes + h + 1) << " " << -(p2*holes + h + 1) << " 0\n";
+		  }
+		}
+	 }
+  }
+  zrhcstar_t zrhcstar;
+  SAT_solver_iface_t::set_budgets(10, 0.0, 0);
+  ostringstream res_os;
+  ASSERT_EQ("UNDEF", zrhcstar.solve_SAT_instance(file, res_os));
+  ASSERT_EQ("INDET\n", res_os.str());
+  SAT_solver_iface_t::set_budgets(0, 0.0, 0);
+  res_os.str("");
+  ASSERT_EQ("UNSAT", zrhcstar.solve_SAT_instance(file, res_os));
+  ASSERT_EQ("UNSAT\n", res_os.str());
+}
+
+#endif // ONLY_INTERNAL_SAT_SOLVER
+
+#endif // INTERNAL_SAT_SOLVER
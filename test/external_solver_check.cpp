@@ -0,0 +1,141 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "external_solver.hpp"
+#include "test_pedigrees.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef ONLY_INTERNAL_SAT_SOLVER
+
+using namespace std;
+
+TEST(external_solver, competition_format) {
+  mped_t ped;
+  pedcnf_t* cnf= prepare_cnf(FEASIBLE_PEDIGREE_STR, ped);
+  bool decided;
+  {
+	 istringstream is("c comment\ns UNSATISFIABLE\n");
+	 ASSERT_FALSE(cnf->assignment_from_competition_format(is, decided));
+	 ASSERT_TRUE(decided);
+  }
+  {
+	 istringstream is("c comment\ns UNKNOWN\n");
+	 ASSERT_FALSE(cnf->assignment_from_competition_format(is, decided));
+	 ASSERT_FALSE(decided);
+  }
+  {
+	 istringstream is("");
+	 ASSERT_FALSE(cnf->assignment_from_competition_format(is, decided));
+	 ASSERT_FALSE(decided);
+  }
+  delete cnf;
+}
+
+TEST(external_solver, unsatisfiable) {
+  mped_t ped;
+  pedcnf_t* cnf= prepare_cnf(FEASIBLE_PEDIGREE_STR, ped);
+  external_solver_t solver("cat > /dev/null; echo 's UNSATISFIABLE'; exit 20");
+  bool decided;
+  ASSERT_FALSE(solver.solve(*cnf, vector<string>(), decided));
+  ASSERT_TRUE(decided);
+  ASSERT_EQ(20, solver.exit_status());
+  delete cnf;
+}
+
+TEST(external_solver, undecided) {
+  mped_t ped;
+  pedcnf_t* cnf= prepare_cnf(FEASIBLE_PEDIGREE_STR, ped);
+  bool decided;
+  {
+	 external_solver_t solver("cat > /dev/null; echo 'c no result'; exit 1");
+	 ASSERT_FALSE(solver.solve(*cnf, vector<string>(), decided));
+	 ASSERT_FALSE(decided);
+	 ASSERT_EQ(1, solver.exit_status());
+  }
+  {
+	 external_solver_t solver("/nonexistent/sat-solver %%INPUT%%");
+	 ASSERT_FALSE(solver.solve(*cnf, vector<string>(), decided));
+	 ASSERT_FALSE(decided);
+	 ASSERT_EQ(127, solver.exit_status());
+  }
+  delete cnf;
+}
+
+// The solver exits without reading the instance
+TEST(external_solver, unread_input) {
+  mped_t ped;
+  pedcnf_t* cnf= prepare_cnf(FEASIBLE_PEDIGREE_STR, ped);
+  external_solver_t solver("echo 's UNSATISFIABLE'");
+  bool decided;
+  ASSERT_FALSE(solver.solve(*cnf, vector<string>(), decided));
+  ASSERT_TRUE(decided);
+  delete cnf;
+}
+
+#ifdef INTERNAL_SAT_SOLVER
+
+TEST(external_solver, satisfiable) {
+  const boost::filesystem::path model_file=
+	 boost::filesystem::temp_directory_path() /
+	 boost::filesystem::unique_path("zrhc-model-%%%%-%%%%");
+// Compute an assignment with the internal solver and let the external
+// solver print it
+  {
+	 mped_t ped;
+	 pedcnf_t* cnf= prepare_cnf(FEASIBLE_PEDIGREE_STR, ped);
+	 ASSERT_TRUE(cnf->solve());
+	 ofstream os(model_file.string().c_str());
+	 os << "s SATISFIABLE\n";
+	 for (size_t i= 0; i < cnf->vals().size(); ++i) {
+		os << (i % 10 == 0 ? "v" : "") << " " << (cnf->vals()[i] ? "" : "-") << (i+1) <<
+		  (i % 10 == 9 ? "\n" : "");
+	 }
+	 os << " 0\n";
+	 delete cnf;
+  }
+  mped_t ped;
+  pedcnf_t* cnf= prepare_cnf(FEASIBLE_PEDIGREE_STR, ped);
+  external_solver_t solver("cat %%INPUT%% > /dev/null; cat '" +
+									model_file.string() + "'; exit 10");
+  bool decided;
+  ASSERT_TRUE(solver.solve(*cnf, vector<string>(1, "test"), decided));
+  ASSERT_TRUE(decided);
+  ASSERT_EQ(10, solver.exit_status());
+  ASSERT_TRUE(cnf->is_satisfying_assignment());
+  ASSERT_TRUE(zrhcstar_t().compute_HC_from_model(ped, cnf));
+  delete cnf;
+  boost::filesystem::remove(model_file);
+}
+
+#endif // INTERNAL_SAT_SOLVER
+
+#endif // ONLY_INTERNAL_SAT_SOLVER
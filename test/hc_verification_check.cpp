@@ -0,0 +1,134 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "zrhc_app.hpp"
+#include "hc_verification.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+typedef zrhcstar_t::family_t family_t;
+
+// Build a zero-recombinant haplotype configuration of 'len' loci for the
+// pedigree 1 x 2 -> {3, 4}, 3 x 5 -> 6
+static void
+build_configuration(const size_t len, unsigned int& seed,
+						  zrhcstar_t::pedigree_t& mped) {
+  const size_t n= 6;
+  const int father[]= { 0, 0, 1, 1, 0, 3 };
+  const int mother[]= { 0, 0, 2, 2, 0, 5 };
+  vector< vector<int> > hp(n, vector<int>(len)), hm(n, vector<int>(len));
+  for (size_t i= 0; i < n; ++i) {
+	 seed= seed * 1103515245u + 12345u;
+	 const bool from_hp_f= (seed >> 16) & 1;
+	 const bool from_hp_m= (seed >> 17) & 1;
+	 for (size_t l= 0; l < len; ++l) {
+		if (father[i] == 0) {
+		  seed= seed * 1103515245u + 12345u;
+		  hp[i][l]= 1 + ((seed >> 16) & 1);
+		  hm[i][l]= 1 + ((seed >> 17) & 1);
+		} else {
+		  hp[i][l]= from_hp_f ? hp[father[i]-1][l] : hm[father[i]-1][l];
+		  hm[i][l]= from_hp_m ? hp[mother[i]-1][l] : hm[mother[i]-1][l];
+		}
+	 }
+  }
+  ostringstream os;
+  for (size_t i= 0; i < n; ++i) {
+	 os << "0 " << (i+1) << " " << father[i] << " " << mother[i] << " "
+		 << ((i == 1 || i == 4) ? 2 : 1) << " phenotype";
+	 for (size_t l= 0; l < len; ++l) {
+		os << " " << std::min(hp[i][l], hm[i][l]) << " " << std::max(hp[i][l], hm[i][l]);
+	 }
+	 os << "\n";
+  }
+  istringstream is(os.str());
+  zrhcstar_t().read_pedigree(is, mped);
+  family_t& fam= mped.families().front();
+  for (size_t i= 0; i < n; ++i) {
+	 family_t::individual_t& ind= fam.get_by_id(i+1);
+	 for (size_t l= 0; l < len; ++l) {
+		ind.hp(l)= (hp[i][l] == 1) ? family_t::h::ALLELE1 : family_t::h::ALLELE2;
+		ind.hm(l)= (hm[i][l] == 1) ? family_t::h::ALLELE1 : family_t::h::ALLELE2;
+	 }
+  }
+}
+
+static void
+check_same_results(const family_t& fam) {
+  for (unsigned int n_threads= 1; n_threads <= 2; ++n_threads) {
+	 packed_haplotype_configuration_t<family_t> phc(fam, n_threads);
+	 ASSERT_EQ( fam.is_completely_haplotyped(), phc.is_completely_haplotyped() );
+	 ASSERT_EQ( fam.is_consistent(), phc.is_consistent() );
+	 ASSERT_EQ( fam.is_zero_recombinant(), phc.is_zero_recombinant() );
+	 ASSERT_EQ( fam.is_zero_recombinant(0, 64), phc.is_zero_recombinant(0, 64) );
+	 ASSERT_EQ( fam.is_zero_recombinant(60, 70), phc.is_zero_recombinant(60, 70) );
+	 ASSERT_EQ( fam.is_zero_recombinant(64, fam.genotype_length()),
+					phc.is_zero_recombinant(64, fam.genotype_length()) );
+  }
+}
+
+TEST(hc_verification, valid_configuration) {
+  unsigned int seed= 42;
+  zrhcstar_t::pedigree_t mped;
+  build_configuration(100, seed, mped);
+  const family_t& fam= mped.families().front();
+  ASSERT_TRUE( fam.is_completely_haplotyped() );
+  ASSERT_TRUE( fam.is_consistent() );
+  ASSERT_TRUE( fam.is_zero_recombinant() );
+  ASSERT_TRUE( is_valid_ZRHC(fam) );
+  check_same_results(fam);
+}
+
+TEST(hc_verification, altered_configurations) {
+  unsigned int seed= 7;
+  const family_t::h alleles[]= { family_t::h::ALLELE1,
+											family_t::h::ALLELE2,
+											family_t::h::MISS };
+  for (size_t iter= 0; iter < 200; ++iter) {
+	 zrhcstar_t::pedigree_t mped;
+	 build_configuration(100, seed, mped);
+	 family_t& fam= mped.families().front();
+	 seed= seed * 1103515245u + 12345u;
+	 family_t::individual_t& ind= fam.get_by_progr((seed >> 16) % fam.size());
+	 seed= seed * 1103515245u + 12345u;
+	 const size_t l= (seed >> 16) % fam.genotype_length();
+	 seed= seed * 1103515245u + 12345u;
+	 const family_t::h& allele= alleles[(seed >> 16) % 3];
+	 if ((seed >> 20) & 1) {
+		ind.hp(l)= allele;
+	 } else {
+		ind.hm(l)= allele;
+	 }
+	 check_same_results(fam);
+  }
+}
@@ -0,0 +1,176 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "incremental_solver.hpp"
+#include "test_pedigrees.hpp"
+
+#include <sstream>
+#include <string>
+
+#ifdef INTERNAL_SAT_SOLVER
+
+using namespace std;
+
+// The same family, with a different genotype of individual 4 at the last
+// locus (it affects only the constraints of its child 5)
+#define CHANGED_PEDIGREE_STR											  \
+  "0 1 0 0 1 phenotype 1 1 2 2 2 2 2 2 1 1\n"						  \
+  "0 2 0 0 2 phenotype 2 2 1 1 1 1 1 1 1 1\n"						  \
+  "0 3 1 2 2 phenotype 1 2 0 0 1 2 1 2 1 1\n"						  \
+  "0 4 0 0 1 phenotype 1 2 1 2 1 1 1 1 2 2\n"						  \
+  "0 5 4 3 1 phenotype 1 2 1 2 0 0 1 1 1 2\n"
+
+// The same family, with a Mendelian error of individual 5 at locus 3
+#define CHANGED_INFEASIBLE_PEDIGREE_STR								  \
+  "0 1 0 0 1 phenotype 1 1 2 2 2 2 2 2 1 1\n"						  \
+  "0 2 0 0 2 phenotype 2 2 1 1 1 1 1 1 1 1\n"						  \
+  "0 3 1 2 2 phenotype 1 2 0 0 1 2 1 2 1 1\n"						  \
+  "0 4 0 0 1 phenotype 1 2 1 2 1 1 1 1 0 0\n"						  \
+  "0 5 4 3 1 phenotype 1 2 1 2 0 0 2 2 1 2\n"
+
+// A family with a different structure (individual 5 has no parents)
+#define OTHER_PEDIGREE_STR												  \
+  "0 1 0 0 1 phenotype 1 1 2 2 2 2 2 2 1 1\n"						  \
+  "0 2 0 0 2 phenotype 2 2 1 1 1 1 1 1 1 1\n"						  \
+  "0 3 1 2 2 phenotype 1 2 0 0 1 2 1 2 1 1\n"						  \
+  "0 4 0 0 1 phenotype 1 2 1 2 1 1 1 1 0 0\n"						  \
+  "0 5 0 0 1 phenotype 1 2 1 2 0 0 1 1 1 2\n"
+
+typedef zrhcstar_t::family_t family_t;
+typedef incremental_solver_t<family_t> inc_solver_t;
+
+// The decoding imputes the missing genotypes, so it works on a copy of the
+// pedigree
+static bool
+is_valid_solution(const string& str, inc_solver_t& solver) {
+  mped_t ped;
+  read_pedigree(str, ped);
+  pedcnf_t* cnf= &solver.cnf();
+  return zrhcstar_t().compute_HC_from_model(ped, cnf);
+}
+
+TEST(incremental_solver, update) {
+  mped_t ped, changed, infeasible;
+  read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+  read_pedigree(CHANGED_PEDIGREE_STR, changed);
+  read_pedigree(CHANGED_INFEASIBLE_PEDIGREE_STR, infeasible);
+
+  inc_solver_t solver;
+  solver.initialize(ped.families().front());
+  ASSERT_TRUE(solver.solve());
+  ASSERT_TRUE(is_valid_solution(FEASIBLE_PEDIGREE_STR, solver));
+
+  ASSERT_TRUE(solver.has_same_structure(changed.families().front()));
+  ASSERT_EQ(1u, solver.update(changed.families().front()));
+  ASSERT_TRUE(solver.solve());
+  ASSERT_TRUE(is_valid_solution(CHANGED_PEDIGREE_STR, solver));
+  ASSERT_EQ(0u, solver.update(changed.families().front()));
+
+// Revert the change of individual 4 and add the Mendelian error
+  ASSERT_EQ(2u, solver.update(infeasible.families().front()));
+  ASSERT_FALSE(solver.solve());
+  ASSERT_FALSE(solver.is_interrupted());
+
+// Revert the Mendelian error
+  ASSERT_EQ(1u, solver.update(ped.families().front()));
+  ASSERT_TRUE(solver.solve());
+  ASSERT_TRUE(is_valid_solution(FEASIBLE_PEDIGREE_STR, solver));
+}
+
+TEST(incremental_solver, structure) {
+  mped_t ped, other;
+  read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+  read_pedigree(OTHER_PEDIGREE_STR, other);
+  inc_solver_t solver;
+  solver.initialize(ped.families().front());
+  ASSERT_TRUE(solver.has_same_structure(ped.families().front()));
+  ASSERT_FALSE(solver.has_same_structure(other.families().front()));
+}
+
+TEST(incremental_solver, save_and_load_state) {
+  mped_t ped, changed, infeasible;
+  read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+  read_pedigree(CHANGED_PEDIGREE_STR, changed);
+  read_pedigree(CHANGED_INFEASIBLE_PEDIGREE_STR, infeasible);
+
+  stringstream state, updated_state;
+  pedcnf_t::varvec_t vars;
+  size_t no_of_clauses;
+  {
+	 inc_solver_t solver(false, "options");
+	 solver.initialize(ped.families().front());
+	 ASSERT_TRUE(solver.solve());
+	 solver.save_state(state);
+	 vars= solver.cnf().vars();
+	 no_of_clauses= solver.cnf().no_of_clauses();
+  }
+  {
+	 istringstream is(state.str());
+	 inc_solver_t solver(false, "other options");
+	 ASSERT_FALSE(solver.load_state(is));
+  }
+  {
+	 istringstream is(state.str());
+	 inc_solver_t solver(false, "options");
+	 ASSERT_TRUE(solver.load_state(is));
+// The instance is restored, not encoded again
+	 ASSERT_TRUE(vars == solver.cnf().vars());
+	 ASSERT_EQ(no_of_clauses, solver.cnf().no_of_clauses());
+	 ASSERT_TRUE(solver.has_same_structure(changed.families().front()));
+	 ASSERT_EQ(1u, solver.update(changed.families().front()));
+	 ASSERT_TRUE(solver.solve());
+	 ASSERT_TRUE(is_valid_solution(CHANGED_PEDIGREE_STR, solver));
+// The state saved after an update is reused by the next run
+	 solver.save_state(updated_state);
+  }
+  {
+	 istringstream is(updated_state.str());
+	 inc_solver_t solver(false, "options");
+	 ASSERT_TRUE(solver.load_state(is));
+	 ASSERT_EQ(0u, solver.update(changed.families().front()));
+	 ASSERT_TRUE(solver.solve());
+	 ASSERT_TRUE(is_valid_solution(CHANGED_PEDIGREE_STR, solver));
+	 ASSERT_EQ(1u, solver.update(ped.families().front()));
+	 ASSERT_TRUE(solver.solve());
+	 ASSERT_TRUE(is_valid_solution(FEASIBLE_PEDIGREE_STR, solver));
+  }
+  {
+	 istringstream is(state.str());
+	 inc_solver_t solver(false, "options");
+	 ASSERT_TRUE(solver.load_state(is));
+	 ASSERT_EQ(1u, solver.update(infeasible.families().front()));
+	 ASSERT_FALSE(solver.solve());
+  }
+  {
+	 istringstream is("ZRHCstar incremental state 0\n");
+	 inc_solver_t solver(false, "options");
+	 ASSERT_FALSE(solver.load_state(is));
+  }
+}
+
+#endif // INTERNAL_SAT_SOLVER
@@ -0,0 +1,81 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "instance_estimate.hpp"
+
+#include <sstream>
+
+using namespace std;
+
+TEST(instance_estimate, scan_pedigree_file) {
+  istringstream is("0 1 0 0 1 phenotype 1 1 2 2 2 2 2 2 1 1\n"
+						 "0 2 0 0 2 phenotype 2 2 1 1 1 1 1 1 1 1\n"
+						 "\n"
+						 "0 3 1 2 2 phenotype 1 2 0 0 1 2 1 2 1 1\n"
+						 "0 4 0 0 1 phenotype 1 2 1 2 1 1 1 1 0 0\n"
+						 "0 5 4 3 1 phenotype 1 2 1 2 0 0 1 1 1 2\n");
+  pedigree_file_stats_t stats;
+  scan_pedigree_file(is, stats);
+  ASSERT_EQ( 5u, stats.individuals );
+  ASSERT_EQ( 3u, stats.founders );
+  ASSERT_EQ( 5u, stats.loci );
+  ASSERT_EQ( 25u, stats.genotypes );
+  ASSERT_EQ( 3u, stats.missing_genotypes );
+  ASSERT_EQ( 8u, stats.heterozygous_genotypes );
+  ASSERT_DOUBLE_EQ( 0.12, stats.missing_rate() );
+}
+
+TEST(instance_estimate, estimate_instance) {
+  pedigree_file_stats_t stats;
+  instance_estimate_t empty= estimate_instance(stats, false);
+  ASSERT_EQ( 0.0, empty.variables );
+  ASSERT_EQ( 0.0, empty.memory_mb );
+
+  stats.individuals= 1000;
+  stats.founders= 200;
+  stats.loci= 100;
+  stats.genotypes= 100000;
+  stats.heterozygous_genotypes= 30000;
+  stats.missing_genotypes= 5000;
+  instance_estimate_t small= estimate_instance(stats, false);
+  instance_estimate_t small_xor= estimate_instance(stats, true);
+  ASSERT_LT( 0.0, small.clauses );
+  ASSERT_EQ( 0.0, small.xor_clauses );
+  ASSERT_LT( 0.0, small_xor.xor_clauses );
+  ASSERT_GT( small.clauses, small_xor.clauses );
+
+// More loci and more missing genotypes give a larger instance
+  stats.loci= 200;
+  stats.genotypes= 200000;
+  stats.heterozygous_genotypes= 60000;
+  stats.missing_genotypes= 20000;
+  instance_estimate_t large= estimate_instance(stats, false);
+  ASSERT_LT( small.variables, large.variables );
+  ASSERT_LT( small.clauses, large.clauses );
+  ASSERT_LT( small.memory_mb, large.memory_mb );
+}
@@ -0,0 +1,125 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "zrhc_app.hpp"
+#include "instance_predictor.hpp"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// A random pedigree (in PLINK format) where each individual inherits an
+// allele from each parent and some genotypes are missing
+static string
+random_pedigree(const size_t n_founders, const size_t n_children,
+					 const size_t n_loci, const unsigned int seed) {
+  srand(seed);
+  vector< vector<int> > alleles;
+  vector<size_t> fathers, mothers;
+  ostringstream os;
+  for (size_t i= 0; i < n_founders + n_children; ++i) {
+	 const int sex= (i % 2) + 1;
+	 size_t father= 0, mother= 0;
+	 alleles.push_back(vector<int>(2*n_loci));
+	 if (i >= n_founders) {
+		father= fathers[rand() % fathers.size()];
+		mother= mothers[rand() % mothers.size()];
+	 }
+	 for (size_t l= 0; l < n_loci; ++l) {
+		if (i < n_founders) {
+		  alleles[i][2*l]= 1 + (rand() % 2);
+		  alleles[i][2*l+1]= 1 + (rand() % 2);
+		} else {
+		  alleles[i][2*l]= alleles[father-1][2*l + (rand() % 2)];
+		  alleles[i][2*l+1]= alleles[mother-1][2*l + (rand() % 2)];
+		}
+	 }
+	 os << "0 " << (i+1) << " " << father << " " << mother << " " << sex <<
+		" phenotype";
+	 for (size_t l= 0; l < n_loci; ++l) {
+		if (rand() % 5 == 0) {
+		  os << " 0 0";
+		} else {
+		  os << " " << alleles[i][2*l] << " " << alleles[i][2*l+1];
+		}
+	 }
+	 os << "\n";
+	 (sex == 1 ? fathers : mothers).push_back(i+1);
+  }
+  return os.str();
+}
+
+static void
+check_prediction(const string& pedigree, const bool xor_clauses,
+					  const bool break_symmetries, const bool dedup_loci) {
+  zrhcstar_t zrhcstar(xor_clauses, break_symmetries, false, dedup_loci);
+  zrhcstar_t::pedigree_t ped;
+  istringstream is(pedigree);
+  zrhcstar.read_pedigree(is, ped);
+  const instance_estimate_t e= zrhcstar.predict_sat(ped);
+  pedcnf_t* cnf;
+  zrhcstar.prepare_sat(ped, cnf);
+  EXPECT_EQ( cnf->vars().size(), (size_t)e.variables );
+  EXPECT_EQ( cnf->no_of_clauses() - cnf->no_of_xor_clauses(), (size_t)e.clauses );
+  EXPECT_EQ( cnf->no_of_xor_clauses(), (size_t)e.xor_clauses );
+  EXPECT_LT( 0.0, e.memory_mb );
+  delete cnf;
+}
+
+TEST(instance_predictor, exact_size) {
+  for (unsigned int seed= 1; seed <= 5; ++seed) {
+	 const string pedigree= random_pedigree(6, 20, 15, seed);
+	 check_prediction(pedigree, false, false, false);
+	 check_prediction(pedigree, true, false, false);
+	 check_prediction(pedigree, false, true, false);
+	 check_prediction(pedigree, true, true, true);
+  }
+}
+
+TEST(instance_predictor, guarded_loci) {
+  zrhcstar_t zrhcstar;
+  zrhcstar_t::pedigree_t ped;
+  istringstream is(random_pedigree(4, 10, 8, 42));
+  zrhcstar.read_pedigree(is, ped);
+  const zrhcstar_t::family_t& family= ped.families().front();
+  vector<size_t> loci;
+  loci.push_back(5);
+  loci.push_back(1);
+  loci.push_back(2);
+  ped2cnf_conv_t<zrhcstar_t::family_t::gen_t, zrhcstar_t::family_t::hap_t,
+					  zrhcstar_t::family_t::phen_t, zrhcstar_t::family_t::id_t,
+					  pedcnf_t> conv(false, false, true);
+  pedcnf_t* cnf= conv.convert(family, loci);
+  const instance_estimate_t e= predict_instance(family, loci, false, false, true);
+  EXPECT_EQ( cnf->vars().size(), (size_t)e.variables );
+  EXPECT_EQ( cnf->no_of_clauses(), (size_t)e.clauses );
+  delete cnf;
+}
@@ -0,0 +1,88 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "test_pedigrees.hpp"
+
+#include <vector>
+
+using namespace std;
+
+#ifdef INTERNAL_SAT_SOLVER
+// Individual 3 is not genotyped, but it must be 1/1 at locus 0, thus its
+// child 5 cannot be heterozygous
+#define LOCUS_INFEASIBLE_PEDIGREE_STR								  \
+  "0 1 0 0 1 phenotype 1 1 1 1\n"										  \
+  "0 2 0 0 2 phenotype 1 1 1 2\n"										  \
+  "0 3 1 2 2 phenotype 0 0 0 0\n"										  \
+  "0 4 0 0 1 phenotype 1 1 1 1\n"										  \
+  "0 5 4 3 1 phenotype 1 2 1 2\n"
+
+TEST(locus_check, infeasible_loci) {
+  zrhcstar_t::pedigree_t ped;
+  read_pedigree(LOCUS_INFEASIBLE_PEDIGREE_STR, ped);
+  zrhcstar_t zrhcstar;
+  ASSERT_TRUE( zrhcstar.is_mendelian_consistent(ped) );
+  vector<size_t> infeasible_loci;
+  vector<size_t> undecided_loci;
+  for (unsigned int n_threads= 1; n_threads <= 3; ++n_threads) {
+	 ASSERT_FALSE( zrhcstar.find_infeasible_loci(ped, infeasible_loci,
+														 undecided_loci, n_threads) );
+	 ASSERT_TRUE( undecided_loci.empty() );
+	 ASSERT_EQ( 1u, infeasible_loci.size() );
+	 ASSERT_EQ( 0u, infeasible_loci.front() );
+  }
+
+  zrhcstar_t::pedigree_t ped_ok;
+  read_pedigree(FEASIBLE_PEDIGREE_STR, ped_ok);
+  for (unsigned int n_threads= 0; n_threads <= 2; ++n_threads) {
+	 ASSERT_TRUE( zrhcstar.find_infeasible_loci(ped_ok, infeasible_loci,
+														undecided_loci, n_threads) );
+	 ASSERT_TRUE( undecided_loci.empty() );
+	 ASSERT_TRUE( infeasible_loci.empty() );
+  }
+}
+
+// The loci of INFEASIBLE_PEDIGREE_STR are feasible by themselves (the s
+// variables are free at each locus), although the pedigree is infeasible
+TEST(locus_check, feasible_loci_of_infeasible_pedigree) {
+  for (size_t break_symmetries= 0; break_symmetries <= 1; ++break_symmetries) {
+	 zrhcstar_t zrhcstar(false, break_symmetries == 1);
+	 zrhcstar_t::pedigree_t ped;
+	 read_pedigree(INFEASIBLE_PEDIGREE_STR, ped, zrhcstar);
+	 vector<size_t> infeasible_loci, undecided_loci;
+	 ASSERT_TRUE( zrhcstar.find_infeasible_loci(ped, infeasible_loci,
+																undecided_loci, 1) );
+	 ASSERT_TRUE( undecided_loci.empty() );
+	 ASSERT_TRUE( infeasible_loci.empty() );
+	 pedcnf_t* cnf;
+	 zrhcstar.prepare_sat(ped, cnf);
+	 ASSERT_FALSE( cnf->solve() );
+	 delete cnf;
+  }
+}
+#endif // INTERNAL_SAT_SOLVER
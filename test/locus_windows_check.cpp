@@ -0,0 +1,161 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "locus_windows.hpp"
+#include "test_pedigrees.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The founder 1 must transmit the haplotype 1 1 1 to individual 3, thus its
+// phases on two overlapping windows can be stitched only in one way
+#define STITCHING_PEDIGREE_STR										  \
+  "0 1 0 0 1 phenotype 1 2 1 2 1 2\n"							  \
+  "0 2 0 0 2 phenotype 1 1 1 1 1 1\n"							  \
+  "0 3 1 2 1 phenotype 1 1 1 1 1 1\n"
+
+TEST(locus_windows, single_window) {
+  vector<locus_window_t> w= compute_locus_windows(10, 0, 0);
+  ASSERT_EQ(1u, w.size());
+  ASSERT_EQ(0u, w[0].first);
+  ASSERT_EQ(0u, w[0].owned);
+  ASSERT_EQ(10u, w[0].last);
+  w= compute_locus_windows(10, 20, 5);
+  ASSERT_EQ(1u, w.size());
+  ASSERT_EQ(10u, w[0].last);
+}
+
+TEST(locus_windows, overlapping_windows) {
+  vector<locus_window_t> w= compute_locus_windows(10, 4, 1);
+  ASSERT_EQ(3u, w.size());
+  ASSERT_EQ(0u, w[0].first); ASSERT_EQ(0u, w[0].owned); ASSERT_EQ(4u, w[0].last);
+  ASSERT_EQ(3u, w[1].first); ASSERT_EQ(4u, w[1].owned); ASSERT_EQ(7u, w[1].last);
+  ASSERT_EQ(6u, w[2].first); ASSERT_EQ(7u, w[2].owned); ASSERT_EQ(10u, w[2].last);
+}
+
+TEST(locus_windows, disjoint_windows) {
+  vector<locus_window_t> w= compute_locus_windows(5, 2, 0);
+  ASSERT_EQ(3u, w.size());
+  ASSERT_EQ(4u, w[2].first); ASSERT_EQ(4u, w[2].owned); ASSERT_EQ(5u, w[2].last);
+}
+
+TEST(locus_windows, invalid_overlap) {
+  ASSERT_THROW(compute_locus_windows(10, 4, 4), std::logic_error);
+}
+
+#ifdef INTERNAL_SAT_SOLVER
+TEST(locus_windows, solve_by_windows) {
+  const size_t sizes[]= { 1, 2, 3, 5 };
+  for (size_t i= 0; i < 4; ++i) {
+	 for (size_t overlap= 0; overlap < sizes[i]; ++overlap) {
+		zrhcstar_t zrhcstar;
+		mped_t ped;
+		read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+		ASSERT_EQ( "ZRHC", zrhcstar.compute_HC_by_windows(ped, sizes[i], overlap, 2) );
+		const zrhcstar_t::family_t& fam= ped.families().front();
+		ASSERT_TRUE( fam.is_completely_haplotyped() );
+		ASSERT_TRUE( fam.is_consistent() );
+	 }
+  }
+}
+
+TEST(locus_windows, stitch_founder_phases) {
+  typedef zrhcstar_t::family_t family_t;
+  zrhcstar_t zrhcstar;
+  mped_t ped;
+  read_pedigree(STITCHING_PEDIGREE_STR, ped);
+  family_t& fam= ped.families().front();
+  const vector<locus_window_t> w= compute_locus_windows(3, 2, 1);
+  ASSERT_EQ(2u, w.size());
+  window_model_t models[2];
+  for (size_t i= 0; i < 2; ++i) {
+	 pedcnf_t* cnf= zrhcstar.encode(fam, w[i].first, w[i].last);
+	 ASSERT_TRUE( cnf->solve() );
+	 models[i].set(fam, *cnf, w[i]);
+	 delete cnf;
+  }
+  compute_ZRHC_from_SAT(fam, models[0], w[0].owned, w[0].last);
+// Give the founder the phase opposite to the one of the second window on
+// the shared locus
+  family_t::individual_t& founder= fam.get_by_progr(0);
+  ASSERT_TRUE( founder.is_founder() );
+  if (models[1].h(founder.progr_id(), 1) ==
+		(founder.hp(1) == family_t::h::ALLELE2)) {
+	 for (size_t l= w[0].owned; l < w[0].last; ++l) {
+		std::swap(founder.hp(l), founder.hm(l));
+	 }
+  }
+  compute_ZRHC_from_SAT(fam, models[1], w[1].owned, w[1].last);
+  ASSERT_EQ( 1u, stitch_founder_phases(fam, models[1], w[1]) );
+  ASSERT_TRUE( founder.hp(1) == founder.hp(2) );
+  ASSERT_TRUE( fam.is_completely_haplotyped() );
+  ASSERT_TRUE( fam.is_consistent() );
+}
+
+TEST(locus_windows, solve_by_windows_stitching) {
+  for (unsigned int n_threads= 1; n_threads <= 2; ++n_threads) {
+	 zrhcstar_t zrhcstar;
+	 mped_t ped;
+	 read_pedigree(STITCHING_PEDIGREE_STR, ped);
+	 ASSERT_EQ( "ZRHC", zrhcstar.compute_HC_by_windows(ped, 2, 1, n_threads) );
+	 const zrhcstar_t::family_t& fam= ped.families().front();
+	 const zrhcstar_t::family_t::individual_t& founder= fam.get_by_progr(0);
+	 ASSERT_TRUE( founder.hp(0) == founder.hp(1) );
+	 ASSERT_TRUE( founder.hp(1) == founder.hp(2) );
+  }
+}
+
+TEST(locus_windows, solve_by_blocks) {
+  for (size_t block_size= 1; block_size <= 6; ++block_size) {
+	 zrhcstar_t zrhcstar;
+	 mped_t ped;
+	 read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+	 size_t no_of_feasible_loci= 0;
+	 ASSERT_EQ( "ZRHC", zrhcstar.compute_HC_by_blocks(ped, block_size,
+															  no_of_feasible_loci) );
+	 ASSERT_EQ( 5u, no_of_feasible_loci );
+  }
+}
+
+TEST(locus_windows, solve_by_blocks_infeasible) {
+  const size_t expected[]= { 1, 0, 0 };
+  for (size_t block_size= 1; block_size <= 3; ++block_size) {
+	 zrhcstar_t zrhcstar(false, true);
+	 mped_t ped;
+	 read_pedigree(INFEASIBLE_PEDIGREE_STR, ped);
+	 size_t no_of_feasible_loci= 10;
+	 ASSERT_EQ( "NO_ZRHC", zrhcstar.compute_HC_by_blocks(ped, block_size,
+																no_of_feasible_loci) );
+	 ASSERT_EQ( expected[block_size-1], no_of_feasible_loci );
+  }
+}
+#endif // INTERNAL_SAT_SOLVER
@@ -0,0 +1,99 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "mendelian_check.hpp"
+#include "test_pedigrees.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+typedef vector< pair<size_t, size_t> > errors_t;
+
+TEST(mendelian_check, consistent) {
+  zrhcstar_t::pedigree_t ped;
+  read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+  errors_t errors;
+  ASSERT_TRUE( check_mendelian_consistency(ped.families().front(), errors) );
+  ASSERT_TRUE( errors.empty() );
+  ASSERT_TRUE( zrhcstar_t().is_mendelian_consistent(ped) );
+}
+
+TEST(mendelian_check, inconsistent) {
+  zrhcstar_t::pedigree_t ped;
+  read_pedigree(INCONSISTENT_PEDIGREE_STR, ped);
+  const zrhcstar_t::family_t& fam= ped.families().front();
+  errors_t errors;
+  ASSERT_FALSE( check_mendelian_consistency(fam, errors) );
+  ASSERT_EQ( 3u, errors.size() );
+  const size_t loci[]= { 0, 1, 3 };
+  for (size_t i= 0; i < errors.size(); ++i) {
+	 ASSERT_EQ( 3u, fam.get_by_progr(errors[i].first).id() );
+	 ASSERT_EQ( loci[i], errors[i].second );
+  }
+  ASSERT_FALSE( zrhcstar_t().is_mendelian_consistent(ped) );
+}
+
+// Errors are found also beyond the first word of packed genotypes
+TEST(mendelian_check, long_genotypes) {
+  const size_t len= 150;
+  const size_t err_locus= 130;
+  ostringstream os;
+  for (size_t i= 1; i <= 3; ++i) {
+	 os << "0 " << i << " " << ((i == 3) ? "1 2" : "0 0") << " " << ((i == 2) ? 2 : 1)
+		 << " phenotype";
+	 for (size_t l= 0; l < len; ++l) {
+		os << ((i == 2 && l == err_locus) ? " 2 2" : " 1 1");
+	 }
+	 os << "\n";
+  }
+  zrhcstar_t::pedigree_t ped;
+  read_pedigree(os.str(), ped);
+  errors_t errors;
+  ASSERT_FALSE( check_mendelian_consistency(ped.families().front(), errors) );
+  ASSERT_EQ( 1u, errors.size() );
+  ASSERT_EQ( err_locus, errors.front().second );
+}
+
+// The encoding of a pedigree with a Mendelian error between homozygous
+// individuals must be unsatisfiable
+TEST(mendelian_check, encoding) {
+  zrhcstar_t::pedigree_t ped;
+  read_pedigree(INCONSISTENT_PEDIGREE_STR, ped);
+  zrhcstar_t zrhcstar;
+  pedcnf_t* cnf;
+  zrhcstar.prepare_sat(ped, cnf);
+#ifdef INTERNAL_SAT_SOLVER
+  ASSERT_FALSE( cnf->solve() );
+#endif // INTERNAL_SAT_SOLVER
+  delete cnf;
+}
@@ -0,0 +1,130 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "parallel.hpp"
+
+#include <vector>
+
+#include <boost/thread.hpp>
+
+using namespace std;
+
+// Task that records the maximum total weight of the running tasks
+class weighted_task_t {
+private:
+  const vector<double>& _weights;
+  boost::mutex _mutex;
+  double _used;
+
+public:
+  double max_used;
+  vector<bool> done;
+
+  explicit weighted_task_t(const vector<double>& weights)
+		:_weights(weights), _used(0.0), max_used(0.0), done(weights.size(), false)
+  {};
+
+  void operator()(const size_t i) {
+	 {
+		boost::mutex::scoped_lock lock(_mutex);
+		_used += _weights[i];
+		max_used= std::max(max_used, _used);
+	 }
+	 boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+	 {
+		boost::mutex::scoped_lock lock(_mutex);
+		_used -= _weights[i];
+		done[i]= true;
+	 }
+  };
+};
+
+TEST(parallel, parallel_for_within_budget) {
+  vector<double> weights;
+  weights.push_back(8.0);
+  weights.push_back(6.0);
+  weights.push_back(4.0);
+  weights.push_back(3.0);
+  weights.push_back(2.0);
+  weights.push_back(1.0);
+  weights.push_back(1.0);
+  weighted_task_t task(weights);
+  parallel_for(weights.size(), task, weights, 10.0, 4);
+  ASSERT_LE( task.max_used, 10.0 );
+  for (size_t i= 0; i < weights.size(); ++i) {
+	 ASSERT_TRUE( task.done[i] );
+  }
+}
+
+TEST(parallel, parallel_for_over_budget) {
+// A task heavier than the budget is executed alone
+  vector<double> weights;
+  weights.push_back(20.0);
+  weights.push_back(1.0);
+  weights.push_back(1.0);
+  weighted_task_t task(weights);
+  parallel_for(weights.size(), task, weights, 10.0, 3);
+  ASSERT_DOUBLE_EQ( 20.0, task.max_used );
+  for (size_t i= 0; i < weights.size(); ++i) {
+	 ASSERT_TRUE( task.done[i] );
+  }
+}
+
+// Task that counts its executions
+class counting_task_t {
+private:
+  boost::mutex& _mutex;
+  size_t& _count;
+
+public:
+  counting_task_t(boost::mutex& mutex, size_t& count)
+		:_mutex(mutex), _count(count)
+  {};
+
+  void operator()() {
+	 boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+	 boost::mutex::scoped_lock lock(_mutex);
+	 ++_count;
+  };
+};
+
+TEST(parallel, thread_pool) {
+  boost::mutex mutex;
+  size_t count= 0;
+  thread_pool_t pool(3);
+  ASSERT_EQ( 3u, pool.size() );
+  for (size_t i= 0; i < 50; ++i)
+	 pool.submit(counting_task_t(mutex, count));
+  pool.wait();
+  ASSERT_EQ( 50u, count );
+// The threads are reused
+  for (size_t i= 0; i < 20; ++i)
+	 pool.submit(counting_task_t(mutex, count));
+  pool.wait();
+  ASSERT_EQ( 70u, count );
+}
@@ -27,6 +27,7 @@
 #include <gtest/gtest.h>
 
 #include "zrhc_app.hpp"
+#include "test_pedigrees.hpp"
 
 #include <iostream>
 #include <sstream>
@@ -160,3 +161,241 @@ TEST(zrhc, sattohc) {
 
 }
 #endif
+
+TEST(zrhc, pedtocnf_break_symmetries) {
+  string pedigree(PEDIGREE_STR);
+
+  istringstream is(pedigree);
+  istringstream is_sb(pedigree);
+
+  zrhcstar_t zrhcstar;
+  zrhcstar_t zrhcstar_sb(false, true);
+
+  zrhcstar_t::pedigree_t ped;
+  zrhcstar_t::pedigree_t ped_sb;
+  pedcnf_t* cnf;
+  pedcnf_t* cnf_sb;
+  zrhcstar.prepare_pedigree_and_sat(is, ped, cnf);
+  zrhcstar_sb.prepare_pedigree_and_sat(is_sb, ped_sb, cnf_sb);
+
+// Only founder 4 has children and a heterozygous locus
+  ASSERT_EQ( cnf->vars().size(), cnf_sb->vars().size() );
+  ASSERT_EQ( cnf->no_of_clauses()+1, cnf_sb->no_of_clauses() );
+  delete cnf;
+
+#ifdef INTERNAL_SAT_SOLVER
+  ASSERT_TRUE( cnf_sb->solve() );
+  ASSERT_TRUE( zrhcstar_sb.compute_HC_from_model(ped_sb, cnf_sb) );
+  typedef zrhcstar_t::family_t family_t;
+  const family_t& fam= ped_sb.families().front();
+  BOOST_FOREACH( const family_t::individual_t& ind, fam.individuals() ) {
+	 if (ind.is_founder() && ind.has_children() && is_heterozygous(ind.g(0))) {
+		ASSERT_EQ( family_t::h::ALLELE1, ind.hp(0) );
+	 }
+  }
+#endif // INTERNAL_SAT_SOLVER
+  delete cnf_sb;
+}
+
+TEST(zrhc, pedtocnf_s_vars_first) {
+  string pedigree(PEDIGREE_STR);
+
+  istringstream is(pedigree);
+
+  zrhcstar_t zrhcstar(false, false, true);
+
+  zrhcstar_t::pedigree_t ped;
+  pedcnf_t* cnf;
+  zrhcstar.prepare_pedigree_and_sat(is, ped, cnf);
+
+// The s variables must have the smallest indices
+  const size_t no_of_s= cnf->s().size();
+  ASSERT_LT( 0u, no_of_s );
+  BOOST_FOREACH( const pedcnf_t::varmap_t::value_type& v, cnf->s() ) {
+	 ASSERT_LE( v.second, (int)no_of_s );
+  }
+
+#ifdef INTERNAL_SAT_SOLVER
+  ASSERT_TRUE( cnf->solve() );
+  ASSERT_TRUE( zrhcstar.compute_HC_from_model(ped, cnf) );
+#endif // INTERNAL_SAT_SOLVER
+  delete cnf;
+}
+
+// Parent 2 is heterozygous only at locus 1 and parent 1 only at locus 2
+#define LATE_HETEROZYGOUS_PEDIGREE_STR								  \
+  "0 1 0 0 1 phenotype 1 1 1 1 1 2\n"								  \
+  "0 2 0 0 2 phenotype 1 1 1 2 1 1\n"								  \
+  "0 3 1 2 1 phenotype 1 1 1 2 1 2\n"
+
+// When the loci are encoded block by block, the s variables of the later
+// blocks must be numbered before the variables of the previous blocks
+TEST(zrhc, pedtocnf_s_vars_first_blocks) {
+  typedef zrhcstar_t::family_t family_t;
+  mped_t ped;
+  read_pedigree(LATE_HETEROZYGOUS_PEDIGREE_STR, ped);
+  const family_t& family= ped.families().front();
+  ped2cnf_conv_t<family_t::gen_t, family_t::hap_t,
+					  family_t::phen_t, family_t::id_t,
+					  pedcnf_t> conv(false, true);
+  pedcnf_t cnf;
+  conv.number_s_vars_first(cnf, family);
+  ASSERT_EQ( 2u, cnf.s().size() );
+  for (size_t l= 0; l < family.genotype_length(); ++l) {
+	 conv.add_loci(cnf, family, l, l+1, 0);
+  }
+  ASSERT_EQ( 2u, cnf.s().size() );
+  ASSERT_LT( 2u, cnf.vars().size() );
+  BOOST_FOREACH( const pedcnf_t::varmap_t::value_type& v, cnf.s() ) {
+	 ASSERT_LE( v.second, 2 );
+  }
+#ifdef INTERNAL_SAT_SOLVER
+  ASSERT_TRUE( cnf.solve() );
+#endif // INTERNAL_SAT_SOLVER
+}
+
+#define DUP_PEDIGREE_STR															\
+  "0 1 0 0 1 phenotype 1 1 2 2 1 1 1 1 2 2\n"							\
+  "0 2 0 0 2 phenotype 2 2 1 1 2 2 1 1 1 1\n"							\
+  "0 3 1 2 2 phenotype 1 2 0 0 1 2 1 1 0 0\n"							\
+  "0 4 0 0 1 phenotype 1 2 1 2 1 2 1 1 1 2\n"							\
+  "0 5 4 3 1 phenotype 1 2 1 2 1 2 1 1 1 2\n"
+
+#define DEDUP_PEDIGREE_STR															\
+  "0 1 0 0 1 phenotype 1 1 2 2\n"												\
+  "0 2 0 0 2 phenotype 2 2 1 1\n"												\
+  "0 3 1 2 2 phenotype 1 2 0 0\n"												\
+  "0 4 0 0 1 phenotype 1 2 1 2\n"												\
+  "0 5 4 3 1 phenotype 1 2 1 2\n"
+
+TEST(zrhc, pedtocnf_dedup_loci) {
+  string pedigree(DUP_PEDIGREE_STR);
+  string dedup_pedigree(DEDUP_PEDIGREE_STR);
+
+  istringstream is(pedigree);
+  istringstream is_dedup(dedup_pedigree);
+
+  zrhcstar_t zrhcstar(false, false, false, true);
+  zrhcstar_t zrhcstar_dedup;
+
+  zrhcstar_t::pedigree_t ped;
+  zrhcstar_t::pedigree_t ped_dedup;
+  pedcnf_t* cnf;
+  pedcnf_t* cnf_dedup;
+  zrhcstar.prepare_pedigree_and_sat(is, ped, cnf);
+  zrhcstar_dedup.prepare_pedigree_and_sat(is_dedup, ped_dedup, cnf_dedup);
+
+// Loci 2 and 4 are copies of loci 0 and 1, locus 3 is trivial
+  ASSERT_EQ( 0u, cnf->locus_representative(2) );
+  ASSERT_EQ( 1u, cnf->locus_representative(4) );
+  ASSERT_EQ( 3u, cnf->locus_representative(3) );
+  ASSERT_EQ( cnf_dedup->vars().size(), cnf->vars().size() );
+  ASSERT_EQ( cnf_dedup->no_of_clauses(), cnf->no_of_clauses() );
+  delete cnf_dedup;
+
+#ifdef INTERNAL_SAT_SOLVER
+  ASSERT_TRUE( cnf->solve() );
+  ASSERT_TRUE( zrhcstar.compute_HC_from_model(ped, cnf) );
+  typedef zrhcstar_t::family_t family_t;
+  const family_t& fam= ped.families().front();
+  BOOST_FOREACH( const family_t::individual_t& ind, fam.individuals() ) {
+	 ASSERT_EQ( ind.hp(0), ind.hp(2) );
+	 ASSERT_EQ( ind.hm(1), ind.hm(4) );
+	 ASSERT_EQ( family_t::h::ALLELE1, ind.hp(3) );
+  }
+#endif // INTERNAL_SAT_SOLVER
+  delete cnf;
+}
+
+#ifdef INTERNAL_SAT_SOLVER
+TEST(zrhc, unsat_core) {
+  zrhcstar_t zrhcstar;
+  vector< pair<size_t, size_t> > core;
+
+  mped_t ped;
+  read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+  ASSERT_EQ( "ZRHC", zrhcstar.compute_HC_with_unsat_core(ped, core) );
+  ASSERT_TRUE( core.empty() );
+
+  mped_t ped_inf;
+  read_pedigree(INFEASIBLE_PEDIGREE_STR, ped_inf);
+  ASSERT_EQ( "NO_ZRHC", zrhcstar.compute_HC_with_unsat_core(ped_inf, core) );
+  const zrhcstar_t::family_t& fam= ped_inf.families().front();
+  ASSERT_EQ( 4u, core.size() );
+  for (size_t i= 0; i < core.size(); ++i) {
+	 ASSERT_EQ( 3u + i/2, fam.get_by_progr(core[i].first).id() );
+	 ASSERT_EQ( i%2, core[i].second );
+  }
+}
+#endif // INTERNAL_SAT_SOLVER
+
+#ifdef INTERNAL_SAT_SOLVER
+TEST(zrhc, packed_model) {
+// Individual 6 has no relatives and it is not genotyped, thus no variable
+// is associated to it
+  string pedigree(PEDIGREE_STR "0 6 0 0 1 phenotype 0 0 0 0 0 0 0 0 0 0\n");
+  istringstream is(pedigree);
+  zrhcstar_t zrhcstar;
+  zrhcstar_t::pedigree_t ped;
+  pedcnf_t* cnf;
+  zrhcstar.prepare_pedigree_and_sat(is, ped, cnf);
+  ASSERT_TRUE( cnf->solve() );
+
+  const zrhcstar_t::family_t& fam= ped.families().front();
+  const packed_model_t model(*cnf, fam.size(), fam.genotype_length());
+  BOOST_FOREACH( const pedcnf_t::varmap_t::value_type& v, cnf->h() ) {
+	 ASSERT_EQ( cnf->h(v.first.get<0>(), v.first.get<1>()),
+					model.h(v.first.get<0>(), v.first.get<1>()) );
+  }
+  BOOST_FOREACH( const pedcnf_t::varmap_t::value_type& v, cnf->w() ) {
+	 ASSERT_EQ( cnf->w(v.first.get<0>(), v.first.get<1>()),
+					model.w(v.first.get<0>(), v.first.get<1>()) );
+  }
+
+  ASSERT_TRUE( zrhcstar.compute_HC_from_model(ped, cnf) );
+  const zrhcstar_t::family_t::individual_t& ind= fam.get_by_id(6);
+  for (size_t l= 0; l < fam.genotype_length(); ++l) {
+	 ASSERT_EQ( zrhcstar_t::family_t::g::HOMO1, ind.g(l) );
+  }
+  delete cnf;
+}
+
+// The haplotypes of the loci of several words are decoded a word at a time
+TEST(zrhc, packed_model_words) {
+  const char* genotypes[]= {
+	 " 1 1 2 2 2 2 2 2 1 1", " 2 2 1 1 1 1 1 1 1 1", " 1 2 0 0 1 2 1 2 1 1",
+	 " 1 2 1 2 1 1 1 1 0 0", " 1 2 1 2 0 0 1 1 1 2"
+  };
+  const char* individuals[]= {
+	 "0 1 0 0 1 phenotype", "0 2 0 0 2 phenotype", "0 3 1 2 2 phenotype",
+	 "0 4 0 0 1 phenotype", "0 5 4 3 1 phenotype"
+  };
+  ostringstream os;
+  for (size_t i= 0; i < 5; ++i) {
+	 os << individuals[i];
+	 for (size_t r= 0; r < 30; ++r)
+		os << genotypes[i];
+	 os << "\n";
+  }
+  istringstream is(os.str());
+  zrhcstar_t zrhcstar;
+  zrhcstar_t::pedigree_t ped;
+  pedcnf_t* cnf;
+  zrhcstar.prepare_pedigree_and_sat(is, ped, cnf);
+  ASSERT_TRUE( cnf->solve() );
+
+  const zrhcstar_t::family_t& fam= ped.families().front();
+  ASSERT_EQ( 150u, fam.genotype_length() );
+  const packed_model_t model(*cnf, fam.size(), fam.genotype_length());
+  ASSERT_EQ( 3u, model.no_of_words() );
+  for (size_t i= 0; i < fam.size(); ++i) {
+	 for (size_t l= 0; l < fam.genotype_length(); ++l) {
+		const packed_word_t word(model, i, l / packed_model_t::WORD_BITS);
+		ASSERT_EQ( model.h(i, l), word.h(i, l) );
+		ASSERT_EQ( model.w(i, l), word.w(i, l) );
+	 }
+  }
+  ASSERT_TRUE( zrhcstar.compute_HC_from_model(ped, cnf) );
+  delete cnf;
+}
+#endif // INTERNAL_SAT_SOLVER
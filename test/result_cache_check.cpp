@@ -0,0 +1,161 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "result_cache.hpp"
+#include "test_pedigrees.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// The same family, with the individuals in a different order
+#define SHUFFLED_PEDIGREE_STR											  \
+  "0 5 4 3 1 phenotype 1 2 1 2 0 0 1 1 1 2\n"						  \
+  "0 3 1 2 2 phenotype 1 2 0 0 1 2 1 2 1 1\n"						  \
+  "0 1 0 0 1 phenotype 1 1 2 2 2 2 2 2 1 1\n"						  \
+  "0 4 0 0 1 phenotype 1 2 1 2 1 1 1 1 0 0\n"						  \
+  "0 2 0 0 2 phenotype 2 2 1 1 1 1 1 1 1 1\n"
+
+// The same family, with a different genotype of individual 4
+#define CHANGED_PEDIGREE_STR											  \
+  "0 1 0 0 1 phenotype 1 1 2 2 2 2 2 2 1 1\n"						  \
+  "0 2 0 0 2 phenotype 2 2 1 1 1 1 1 1 1 1\n"						  \
+  "0 3 1 2 2 phenotype 1 2 0 0 1 2 1 2 1 1\n"						  \
+  "0 4 0 0 1 phenotype 1 2 1 2 1 1 1 1 2 2\n"						  \
+  "0 5 4 3 1 phenotype 1 2 1 2 0 0 1 1 1 2\n"
+
+typedef zrhcstar_t::family_t family_t;
+
+typedef temp_path_test_t result_cache_test;
+
+TEST(result_cache, hash) {
+  ASSERT_EQ("da39a3ee5e6b4b0d3255bfef95601890afd80709",
+				result_cache_t::hash(""));
+  ASSERT_EQ("a9993e364706816aba3e25717850c26c9cd0d89d",
+				result_cache_t::hash("abc"));
+}
+
+TEST_F(result_cache_test, key) {
+  result_cache_t cache(tmp_path.string(), "xor=0");
+  result_cache_t xor_cache(tmp_path.string(), "xor=1");
+  mped_t ped, shuffled, changed;
+  read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+  read_pedigree(SHUFFLED_PEDIGREE_STR, shuffled);
+  read_pedigree(CHANGED_PEDIGREE_STR, changed);
+  const string key= cache.key(ped.families().front());
+  ASSERT_EQ(40u, key.size());
+  ASSERT_EQ(key, cache.key(shuffled.families().front()));
+  ASSERT_NE(key, cache.key(changed.families().front()));
+  ASSERT_NE(key, xor_cache.key(ped.families().front()));
+}
+
+#ifdef INTERNAL_SAT_SOLVER
+
+TEST_F(result_cache_test, store_and_load) {
+  result_cache_t cache(tmp_path.string(), "");
+  mped_t ped, shuffled, other;
+  read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+  read_pedigree(SHUFFLED_PEDIGREE_STR, shuffled);
+  read_pedigree(CHANGED_PEDIGREE_STR, other);
+  family_t& family= ped.families().front();
+  family_t& shuffled_family= shuffled.families().front();
+  bool is_zrhc;
+
+  const string key= cache.key(family);
+  ASSERT_FALSE(cache.load(key, shuffled_family, is_zrhc));
+
+  pedcnf_t* cnf;
+  zrhcstar_t zrhcstar;
+  zrhcstar.prepare_sat(ped, cnf);
+  ASSERT_TRUE(cnf->solve());
+  ASSERT_TRUE(zrhcstar.compute_HC_from_model(ped, cnf));
+  delete cnf;
+  cache.store(key, family, true);
+
+  ASSERT_TRUE(cache.load(key, shuffled_family, is_zrhc));
+  ASSERT_TRUE(is_zrhc);
+  BOOST_FOREACH( const family_t::individual_t& ind, family.individuals() ) {
+	 ASSERT_EQ(tostr(ind.hp()), tostr(shuffled_family[ind.id()].hp()));
+	 ASSERT_EQ(tostr(ind.hm()), tostr(shuffled_family[ind.id()].hm()));
+  }
+
+  const string other_key= cache.key(other.families().front());
+  cache.store(other_key, other.families().front(), false);
+  ASSERT_TRUE(cache.load(other_key, other.families().front(), is_zrhc));
+  ASSERT_FALSE(is_zrhc);
+}
+
+#endif // INTERNAL_SAT_SOLVER
+
+TEST_F(result_cache_test, invalid_entry) {
+  result_cache_t cache(tmp_path.string(), "");
+  mped_t ped;
+  read_pedigree(FEASIBLE_PEDIGREE_STR, ped);
+  family_t& family= ped.families().front();
+  const string key= cache.key(family);
+// Individual 1 is homozygous (allele 1) at the first locus
+  {
+	 ofstream os((tmp_path / key).string().c_str());
+	 os << "ZRHC\n"
+		 "1 21221 12221\n"
+		 "2 21111 21111\n"
+		 "3 12121 21121\n"
+		 "4 12111 21112\n"
+		 "5 11111 21112\n";
+  }
+  bool is_zrhc;
+  ASSERT_FALSE(cache.load(key, family, is_zrhc));
+  ASSERT_FALSE(boost::filesystem::exists(tmp_path / key));
+  ASSERT_FALSE(family.is_completely_haplotyped());
+}
+
+#ifdef INTERNAL_SAT_SOLVER
+
+TEST_F(result_cache_test, solve_pedigree) {
+  result_cache_t cache(tmp_path.string(), "");
+  zrhcstar_t zrhcstar;
+  zrhcstar.set_result_cache(&cache);
+  string message;
+  {
+	 mped_t ped;
+	 istringstream is(FEASIBLE_PEDIGREE_STR);
+	 ASSERT_EQ("ZRHC", zrhcstar.solve_pedigree(is, ped, message));
+	 ASSERT_EQ("", message);
+  }
+  {
+	 mped_t ped;
+	 istringstream is(SHUFFLED_PEDIGREE_STR);
+	 ASSERT_EQ("ZRHC", zrhcstar.solve_pedigree(is, ped, message));
+	 ASSERT_EQ("cached", message);
+	 ASSERT_TRUE(ped.families().front().is_zero_recombinant());
+  }
+}
+
+#endif // INTERNAL_SAT_SOLVER
@@ -0,0 +1,121 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "run_stats.hpp"
+
+#include <sstream>
+#include <string>
+
+#include <boost/thread.hpp>
+
+using namespace std;
+
+// Use CPU time until 'seconds' of CPU time of the thread have elapsed
+static void
+busy_wait(const double seconds) {
+  const double start= run_stats_t::thread_cpu_time();
+  while (run_stats_t::thread_cpu_time() - start < seconds)
+	 ;
+}
+
+TEST(run_stats, phases_and_counters) {
+  run_stats_t& rs= run_stats_t::get_run_stats();
+  rs.clear();
+  {
+	 phase_timer_t timer("parsing");
+  }
+  {
+	 phase_timer_t timer("encoding");
+	 timer.stop();
+	 timer.stop();
+  }
+  {
+	 phase_timer_t timer("parsing");
+  }
+  const run_stats_t::phases_t phases= rs.phases();
+  ASSERT_EQ( 2u, phases.size() );
+  ASSERT_EQ( "parsing", phases[0].name );
+  ASSERT_EQ( 2u, phases[0].calls );
+  ASSERT_EQ( "encoding", phases[1].name );
+  ASSERT_EQ( 1u, phases[1].calls );
+  ASSERT_GE( phases[0].wall_time, 0.0 );
+  ASSERT_GE( phases[0].cpu_time, 0.0 );
+
+  rs.set_counter("variables", 10);
+  rs.add_to_counter("variables", 5);
+  rs.add_to_counter("clauses", 7);
+  rs.set_counter("clauses", 3);
+  ASSERT_EQ( 15, rs.counter("variables") );
+  ASSERT_EQ( 3, rs.counter("clauses") );
+  ASSERT_EQ( 0, rs.counter("xor_clauses") );
+  ASSERT_EQ( 2u, rs.counters().size() );
+
+  rs.clear();
+  ASSERT_TRUE( rs.phases().empty() );
+  ASSERT_TRUE( rs.counters().empty() );
+}
+
+// The CPU time used by another thread is not charged to a phase
+TEST(run_stats, phase_cpu_time_of_thread) {
+  run_stats_t& rs= run_stats_t::get_run_stats();
+  rs.clear();
+  {
+	 phase_timer_t timer("waiting");
+	 boost::thread busy(boost::bind(busy_wait, 0.2));
+	 busy.join();
+  }
+  {
+	 phase_timer_t timer("working");
+	 busy_wait(0.2);
+  }
+  const run_stats_t::phases_t phases= rs.phases();
+  ASSERT_EQ( 2u, phases.size() );
+  ASSERT_GE( phases[0].wall_time, 0.2 );
+  ASSERT_LT( phases[0].cpu_time, 0.1 );
+  ASSERT_GE( phases[1].cpu_time, 0.2 );
+  rs.clear();
+}
+
+TEST(run_stats, json) {
+  run_stats_t& rs= run_stats_t::get_run_stats();
+  rs.clear();
+  rs.set_info("pedigree", "dir\"ped\".txt");
+  {
+	 phase_timer_t timer("solving");
+  }
+  rs.set_counter("clauses", 42);
+  ostringstream os;
+  rs.write_json(os);
+  const string json= os.str();
+  ASSERT_NE( string::npos, json.find("\"pedigree\": \"dir\\\"ped\\\".txt\"") );
+  ASSERT_NE( string::npos, json.find("\"peak_rss_kb\": ") );
+  ASSERT_NE( string::npos, json.find("{ \"name\": \"solving\", \"calls\": 1,") );
+  ASSERT_NE( string::npos, json.find("\"clauses\": 42") );
+  ASSERT_GT( run_stats_t::peak_rss_kb(), 0 );
+  rs.clear();
+}
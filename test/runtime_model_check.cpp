@@ -0,0 +1,101 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "runtime_model.hpp"
+#include "run_stats.hpp"
+
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+static recorded_run_t
+make_run(const double variables, const double clauses,
+			const double seconds) {
+  recorded_run_t run;
+  run.variables= variables;
+  run.clauses= clauses;
+  run.seconds= seconds;
+  return run;
+}
+
+TEST(runtime_model, fit_and_predict) {
+// seconds = 0.5 + 1e-5 * variables + 2e-6 * clauses (no xor-clauses)
+  vector<recorded_run_t> runs;
+  runs.push_back(make_run(1000, 5000, 0.5 + 0.01 + 0.01));
+  runs.push_back(make_run(20000, 60000, 0.5 + 0.2 + 0.12));
+  runs.push_back(make_run(50000, 100000, 0.5 + 0.5 + 0.2));
+  runs.push_back(make_run(300000, 2000000, 0.5 + 3.0 + 4.0));
+  runtime_model_t model;
+  model.fit(runs);
+  ASSERT_EQ( 4u, model.no_of_runs() );
+  EXPECT_NEAR( 0.5, model.coefficients()[0], 1e-6 );
+  EXPECT_NEAR( 1e-5, model.coefficients()[1], 1e-9 );
+  EXPECT_NEAR( 2e-6, model.coefficients()[2], 1e-9 );
+  EXPECT_EQ( 0.0, model.coefficients()[3] );
+
+  instance_estimate_t instance;
+  instance.variables= 100000;
+  instance.clauses= 500000;
+  EXPECT_NEAR( 2.5, model.predict(instance), 1e-6 );
+
+  stringstream ss;
+  model.save(ss);
+  runtime_model_t loaded;
+  loaded.load(ss);
+  ASSERT_EQ( 4u, loaded.no_of_runs() );
+  EXPECT_NEAR( model.predict(instance), loaded.predict(instance), 1e-6 );
+}
+
+TEST(runtime_model, read_recorded_run) {
+  run_stats_t& rs= run_stats_t::get_run_stats();
+  rs.clear();
+  rs.add_phase_time("parsing", 0.25, 0.25);
+  rs.add_phase_time("encoding", 0.5, 0.5);
+  rs.add_phase_time("solving", 1.5, 1.5);
+  rs.set_counter("variables", 1000);
+  rs.set_counter("clauses", 3000);
+  rs.set_counter("xor_clauses", 200);
+  rs.set_counter("dummy_variables", 10);
+  rs.set_counter("exit_status", 0);
+  stringstream ss;
+  rs.write_json(ss);
+  recorded_run_t run;
+  ASSERT_TRUE( read_recorded_run(ss, run) );
+  EXPECT_EQ( 1000.0, run.variables );
+  EXPECT_EQ( 3000.0, run.clauses );
+  EXPECT_EQ( 200.0, run.xor_clauses );
+  EXPECT_DOUBLE_EQ( 2.0, run.seconds );
+
+// Interrupted runs are not used
+  rs.set_counter("exit_status", 3);
+  stringstream ss2;
+  rs.write_json(ss2);
+  ASSERT_FALSE( read_recorded_run(ss2, run) );
+  rs.clear();
+}
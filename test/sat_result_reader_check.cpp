@@ -0,0 +1,181 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "sat_result_reader.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static string
+values(const vector<bool>& vals) {
+  string s;
+  for (size_t i= 0; i < vals.size(); ++i)
+	 s.push_back(vals[i] ? '1' : '0');
+  return s;
+}
+
+TEST(sat_result_reader, minisat_format) {
+  vector<bool> vals(5, false);
+  bool decided;
+  {
+	 istringstream is("SAT\n1 -2 3 4 -5 0\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_TRUE(reader.read(vals, decided));
+	 ASSERT_TRUE(decided);
+	 ASSERT_EQ("10110", values(vals));
+	 ASSERT_EQ(5u, reader.no_of_assigned());
+  }
+  {
+	 istringstream is("UNSAT\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_FALSE(reader.read(vals, decided));
+	 ASSERT_TRUE(decided);
+  }
+  {
+	 istringstream is("INDET\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_FALSE(reader.read(vals, decided));
+	 ASSERT_FALSE(decided);
+  }
+}
+
+TEST(sat_result_reader, competition_format) {
+  vector<bool> vals(5, false);
+  bool decided;
+  {
+	 istringstream is("c a comment\r\n"
+							"s SATISFIABLE\r\n"
+							"v -1 2\r\n"
+							"c another comment\n"
+							"v\t3 -4\n"
+							"v 5 0\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_TRUE(reader.read(vals, decided));
+	 ASSERT_TRUE(decided);
+	 ASSERT_EQ("01101", values(vals));
+  }
+  {
+	 istringstream is("c a comment\ns UNSATISFIABLE\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_FALSE(reader.read(vals, decided));
+	 ASSERT_TRUE(decided);
+  }
+  {
+	 istringstream is("s UNKNOWN\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_FALSE(reader.read(vals, decided));
+	 ASSERT_FALSE(decided);
+  }
+  {
+	 istringstream is("");
+	 sat_result_reader_t reader(is);
+	 ASSERT_FALSE(reader.read(vals, decided));
+	 ASSERT_FALSE(decided);
+  }
+}
+
+// The lines are longer than the buffer of the reader
+TEST(sat_result_reader, small_buffer) {
+  const size_t n= 1000;
+  ostringstream os;
+  os << "c solver output\ns SATISFIABLE\nv";
+  for (size_t i= 1; i <= n; ++i)
+	 os << " " << ((i % 3 == 0) ? "-" : "") << i;
+  os << " 0\n";
+  vector<bool> vals(n, false);
+  bool decided;
+  for (size_t buffer_size= 1; buffer_size <= 7; buffer_size += 3) {
+	 istringstream is(os.str());
+	 sat_result_reader_t reader(is, buffer_size);
+	 ASSERT_TRUE(reader.read(vals, decided));
+	 ASSERT_TRUE(decided);
+	 ASSERT_EQ(n, reader.no_of_assigned());
+	 for (size_t i= 1; i <= n; ++i) {
+		ASSERT_EQ(i % 3 != 0, vals[i-1]);
+	 }
+  }
+}
+
+TEST(sat_result_reader, coverage) {
+  vector<bool> vals(5, false);
+  bool decided;
+  {
+// The values of the previous assignment are not kept
+	 vals.assign(5, true);
+	 istringstream is("s SATISFIABLE\nv 1 -2 0\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_TRUE(reader.read(vals, decided));
+	 ASSERT_EQ(2u, reader.no_of_assigned());
+	 ASSERT_EQ("10000", values(vals));
+  }
+  {
+	 istringstream is("s SATISFIABLE\nv 1 -2 1 0\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_TRUE(reader.read(vals, decided));
+	 ASSERT_EQ(2u, reader.no_of_assigned());
+  }
+}
+
+TEST(sat_result_reader, malformed) {
+  vector<bool> vals(5, false);
+  bool decided;
+  {
+// Conflicting values
+	 istringstream is("s SATISFIABLE\nv 1 -2 -1 0\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_THROW({ reader.read(vals, decided); }, logic_error);
+  }
+  {
+// Variable out of range
+	 istringstream is("SAT\n1 -2 6 0\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_THROW({ reader.read(vals, decided); }, logic_error);
+  }
+  {
+// Not a literal
+	 istringstream is("s SATISFIABLE\nv 1 x2 0\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_THROW({ reader.read(vals, decided); }, logic_error);
+  }
+  {
+// Missing end of the assignment
+	 istringstream is("s SATISFIABLE\nv 1 -2\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_THROW({ reader.read(vals, decided); }, logic_error);
+  }
+  {
+// End of the assignment without the 'v' prefix
+	 istringstream is("s SATISFIABLE\nv 1 -2\n 0\n");
+	 sat_result_reader_t reader(is);
+	 ASSERT_THROW({ reader.read(vals, decided); }, logic_error);
+  }
+}
@@ -0,0 +1,168 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "sat_solver_interface.hpp"
+#include "run_stats.hpp"
+
+#include <set>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+using namespace std;
+
+#ifdef INTERNAL_SAT_SOLVER
+
+// Variable of pigeon p in hole h
+static int
+php_var(const int p, const int h, const int holes) {
+  return p*holes + h + 1;
+}
+
+// Pigeonhole principle with 'holes'+1 pigeons (unsatisfiable)
+static void
+add_pigeonhole(SAT_solver_iface_t& solver, const int holes) {
+  for (int p= 0; p <= holes; ++p) {
+	 set<int> clause;
+	 for (int h= 0; h < holes; ++h)
+		clause.insert(php_var(p, h, holes));
+	 solver.add_clause(clause);
+  }
+  for (int h= 0; h < holes; ++h) {
+	 for (int p1= 0; p1 <= holes; ++p1) {
+		for (int p2= p1+1; p2 <= holes; ++p2) {
+		  set<int> clause;
+		  clause.insert(-php_var(p1, h, holes));
+		  clause.insert(-php_var(p2, h, holes));
+		  solver.add_clause(clause);
+		}
+	 }
+  }
+}
+
+TEST(sat_solver_interface, statistics) {
+  run_stats_t& rs= run_stats_t::get_run_stats();
+  rs.clear();
+  SAT_solver_iface_t solver;
+  ASSERT_EQ( 0u, solver.statistics().conflicts );
+  add_pigeonhole(solver, 7);
+  ASSERT_FALSE( solver.solve() );
+  const SAT_solver_stats_t stats= solver.statistics();
+  ASSERT_GT( stats.conflicts, 0u );
+  ASSERT_GT( stats.decisions, 0u );
+  ASSERT_GT( stats.propagations, 0u );
+  ASSERT_GT( stats.restarts, 0u );
+  ASSERT_EQ( (long long)stats.conflicts, rs.counter("solver_conflicts") );
+  ASSERT_EQ( (long long)stats.decisions, rs.counter("solver_decisions") );
+  rs.clear();
+}
+
+TEST(sat_solver_interface, incremental_statistics) {
+  run_stats_t& rs= run_stats_t::get_run_stats();
+  rs.clear();
+  SAT_solver_iface_t solver;
+  solver.set_incremental(true);
+  set<int> clause;
+  clause.insert(1);
+  clause.insert(2);
+  solver.add_clause(clause);
+  ASSERT_TRUE( solver.solve() );
+  const long long first= rs.counter("solver_decisions");
+  ASSERT_EQ( (long long)solver.statistics().decisions, first );
+  clause.clear();
+  clause.insert(-1);
+  clause.insert(3);
+  solver.add_clause(clause);
+  ASSERT_TRUE( solver.solve() );
+// Only the statistics of the second solve are added
+  ASSERT_EQ( (long long)solver.statistics().decisions,
+				 rs.counter("solver_decisions") );
+  rs.clear();
+}
+
+TEST(sat_solver_interface, conflict_budget) {
+  SAT_solver_iface_t::set_budgets(10, 0.0, 0);
+  SAT_solver_iface_t solver;
+  add_pigeonhole(solver, 7);
+  ASSERT_FALSE( solver.solve() );
+  ASSERT_TRUE( solver.is_interrupted() );
+  ASSERT_LE( solver.statistics().conflicts, 10u );
+// Without budgets the instance is proved unsatisfiable
+  SAT_solver_iface_t::set_budgets(0, 0.0, 0);
+  ASSERT_FALSE( solver.solve() );
+  ASSERT_FALSE( solver.is_interrupted() );
+}
+
+TEST(sat_solver_interface, time_budget) {
+  SAT_solver_iface_t::set_budgets(0, 0.2, 0);
+  SAT_solver_iface_t solver;
+  add_pigeonhole(solver, 11);
+  const double start= run_stats_t::wall_time();
+  ASSERT_FALSE( solver.solve() );
+  ASSERT_TRUE( solver.is_interrupted() );
+  ASSERT_LT( run_stats_t::wall_time() - start, 5.0 );
+// The time budget applies to each solve, hence a later (easy) solve is not
+// interrupted even if the budget has already passed since the first one
+  boost::this_thread::sleep(boost::posix_time::milliseconds(300));
+  SAT_solver_iface_t easy;
+  add_pigeonhole(easy, 2);
+  ASSERT_FALSE( easy.solve() );
+  ASSERT_FALSE( easy.is_interrupted() );
+  SAT_solver_iface_t::set_budgets(0, 0.0, 0);
+}
+
+static void
+count_progress(const SAT_solver_progress_t& progress, int* calls) {
+  ++(*calls);
+  if (progress.conflicts > 0) {
+	 SAT_solver_iface_t::request_interrupt();
+  }
+}
+
+TEST(sat_solver_interface, progress_and_interruption) {
+  int calls= 0;
+  SAT_solver_iface_t::set_progress_interval(1e-9);
+  SAT_solver_iface_t::set_progress_callback(boost::bind(count_progress, _1, &calls));
+  SAT_solver_iface_t solver;
+  add_pigeonhole(solver, 11);
+  ASSERT_FALSE( solver.solve() );
+  ASSERT_TRUE( solver.is_interrupted() );
+  ASSERT_TRUE( SAT_solver_iface_t::is_interrupt_requested() );
+  ASSERT_GT( calls, 0 );
+  const SAT_solver_progress_t progress= solver.progress();
+  ASSERT_GT( progress.conflicts, 0u );
+  ASSERT_GT( progress.restarts, 0u );
+  ASSERT_GT( progress.clauses, 0u );
+  SAT_solver_iface_t::set_progress_callback(SAT_solver_iface_t::progress_callback_t());
+  SAT_solver_iface_t::set_progress_interval(10.0);
+  SAT_solver_iface_t::clear_interrupt_request();
+  ASSERT_FALSE( SAT_solver_iface_t::is_interrupt_requested() );
+}
+
+#endif // INTERNAL_SAT_SOLVER
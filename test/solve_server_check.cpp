@@ -0,0 +1,184 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include <gtest/gtest.h>
+
+#include "solve_server.hpp"
+#include "test_pedigrees.hpp"
+
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+
+#include <unistd.h>
+
+using namespace std;
+
+#ifdef INTERNAL_SAT_SOLVER
+
+static string
+request(const string& id, const string& pedigree) {
+  ostringstream os;
+  os << "SOLVE " << id << " " << pedigree.size() << "\n" << pedigree;
+  return os.str();
+}
+
+// Read the responses as a map from the id to the pair (status, payload)
+static map< string, pair<string, string> >
+read_responses(const string& responses) {
+  map< string, pair<string, string> > ris;
+  istringstream is(responses);
+  string id, status;
+  size_t length;
+  while (is >> id >> status >> length) {
+	 is.get();
+	 string payload(length, '\0');
+	 is.read(&payload[0], length);
+	 ris[id]= make_pair(status, payload);
+  }
+  return ris;
+}
+
+TEST(solve_server, serve) {
+  zrhcstar_t zrhcstar;
+  solve_server_t server(zrhcstar, 2);
+  istringstream in(request("a", FEASIBLE_PEDIGREE_STR) +
+						 request("b", INCONSISTENT_PEDIGREE_STR) +
+						 request("c", "0 1 0 0 1 phenotype 1\n") +
+						 request("d", FEASIBLE_PEDIGREE_STR) +
+						 "QUIT\n" +
+						 request("e", FEASIBLE_PEDIGREE_STR));
+  ostringstream out;
+  ASSERT_EQ( 4u, server.serve(in, out) );
+  map< string, pair<string, string> > responses= read_responses(out.str());
+  ASSERT_EQ( 4u, responses.size() );
+  ASSERT_EQ( "ZRHC", responses["a"].first );
+  ASSERT_EQ( "NO_ZRHC", responses["b"].first );
+  ASSERT_EQ( "ERROR", responses["c"].first );
+  ASSERT_EQ( "ZRHC", responses["d"].first );
+  ASSERT_EQ( responses["a"].second, responses["d"].second );
+// The haplotype configuration has a row for each individual
+  istringstream hap(responses["a"].second);
+  string line;
+  size_t n_lines= 0;
+  while (getline(hap, line)) ++n_lines;
+  ASSERT_EQ( 5u, n_lines );
+}
+
+TEST(solve_server, malformed_request) {
+  zrhcstar_t zrhcstar;
+  solve_server_t server(zrhcstar, 1);
+  istringstream in(request("a", FEASIBLE_PEDIGREE_STR) +
+						 "SOLVE b\n" +
+						 request("c", FEASIBLE_PEDIGREE_STR));
+  ostringstream out;
+  ASSERT_EQ( 1u, server.serve(in, out) );
+  map< string, pair<string, string> > responses= read_responses(out.str());
+  ASSERT_EQ( 2u, responses.size() );
+  ASSERT_EQ( "ZRHC", responses["a"].first );
+  ASSERT_EQ( "ERROR", responses["-"].first );
+}
+
+TEST(solve_server, invalid_length) {
+  zrhcstar_t zrhcstar;
+  const string large(400, '\n');
+  solve_server_t server(zrhcstar, 1, 300);
+  istringstream in(string("SOLVE a -1\n") +
+						 "SOLVE b 99999999999999999999999\n" +
+						 request("c", large) +
+						 request("d", FEASIBLE_PEDIGREE_STR));
+  ostringstream out;
+  ASSERT_EQ( 1u, server.serve(in, out) );
+  map< string, pair<string, string> > responses= read_responses(out.str());
+  ASSERT_EQ( 4u, responses.size() );
+  ASSERT_EQ( "ERROR", responses["a"].first );
+  ASSERT_EQ( "ERROR", responses["b"].first );
+  ASSERT_EQ( "ERROR", responses["c"].first );
+  ASSERT_EQ( "ZRHC", responses["d"].first );
+}
+
+static void
+serve_pipes(solve_server_t& server, const int in_fd, const int out_fd,
+				size_t& n_requests) {
+  namespace io= boost::iostreams;
+  io::stream<io::file_descriptor_source> in(in_fd, io::close_handle);
+  io::stream<io::file_descriptor_sink> out(out_fd, io::close_handle);
+  n_requests= server.serve(in, out);
+}
+
+// The client sends all the requests before reading the responses, which
+// do not fit in the buffers of the pipes
+TEST(solve_server, pipe_client) {
+  const size_t n_loci= 1000;
+  const size_t n_pedigrees= 200;
+  ostringstream ped_os;
+  for (size_t ind= 1; ind <= 3; ++ind) {
+	 ped_os << "0 " << ind << " " << ((ind == 3) ? "1 2 " : "0 0 ") <<
+		((ind == 2) ? 2 : 1) << " phenotype";
+	 for (size_t l= 0; l < n_loci; ++l)
+		ped_os << " 1 1";
+	 ped_os << "\n";
+  }
+  const string pedigree= ped_os.str();
+  int in_fds[2], out_fds[2];
+  ASSERT_EQ( 0, pipe(in_fds) );
+  ASSERT_EQ( 0, pipe(out_fds) );
+  zrhcstar_t zrhcstar;
+  solve_server_t server(zrhcstar, 2);
+  size_t n_requests= 0;
+  boost::thread serving(boost::bind(&serve_pipes, boost::ref(server),
+												in_fds[0], out_fds[1],
+												boost::ref(n_requests)));
+  {
+	 namespace io= boost::iostreams;
+	 io::stream<io::file_descriptor_sink> to_server(in_fds[1], io::close_handle);
+	 for (size_t i= 0; i < n_pedigrees; ++i)
+		to_server << request(tostr(i), pedigree);
+	 to_server << "QUIT\n";
+  }
+  string responses;
+  {
+	 char buff[4096];
+	 ssize_t n;
+	 while ((n= ::read(out_fds[0], buff, sizeof(buff))) > 0)
+		responses.append(buff, n);
+	 ::close(out_fds[0]);
+  }
+  serving.join();
+  ASSERT_EQ( n_pedigrees, n_requests );
+  map< string, pair<string, string> > ris= read_responses(responses);
+  ASSERT_EQ( n_pedigrees, ris.size() );
+  for (size_t i= 0; i < n_pedigrees; ++i)
+	 ASSERT_EQ( "ZRHC", ris[tostr(i)].first );
+}
+
+#endif // INTERNAL_SAT_SOLVER
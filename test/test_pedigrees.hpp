@@ -0,0 +1,107 @@
+/**
+ *
+ *                              ZRHC-*
+ * Zero-Recombinant Haplotype Configuration with missing genotypes
+ *
+ * Copyright (C) 2010  Yuri Pirola <yuri.pirola(-at-)gmail.com>
+ *
+ * Distributed under the terms of the GNU General Public License (GPL)
+ *
+ *
+ * This file is part of ZRHC-* (ZRHCstar).
+ *
+ * ZRHC-* is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZRHC-* is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZRHC-*.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+/**
+ *
+ * test_pedigrees.hpp
+ *
+ * Pedigrees and fixtures shared by the unit tests.
+ *
+ **/
+
+#ifndef __TEST_PEDIGREES_HPP__
+#define __TEST_PEDIGREES_HPP__
+
+#include <gtest/gtest.h>
+
+#include "zrhc_app.hpp"
+
+#include <sstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+// A feasible family (with missing genotypes) of 5 individuals on 5 loci
+#define FEASIBLE_PEDIGREE_STR											  \
+  "0 1 0 0 1 phenotype 1 1 2 2 2 2 2 2 1 1\n"						  \
+  "0 2 0 0 2 phenotype 2 2 1 1 1 1 1 1 1 1\n"						  \
+  "0 3 1 2 2 phenotype 1 2 0 0 1 2 1 2 1 1\n"						  \
+  "0 4 0 0 1 phenotype 1 2 1 2 1 1 1 1 0 0\n"						  \
+  "0 5 4 3 1 phenotype 1 2 1 2 0 0 1 1 1 2\n"
+
+// Each locus is feasible, but the phases of individual 1 required by
+// individuals 3 and 4 at loci 0 and 1 are different (individual 4 should
+// inherit a recombinant haplotype)
+#define INFEASIBLE_PEDIGREE_STR										  \
+  "0 1 0 0 1 phenotype 1 2 1 2 1 1\n"							  \
+  "0 2 0 0 2 phenotype 1 1 1 1 1 1\n"							  \
+  "0 3 1 2 1 phenotype 1 2 1 2 1 1\n"							  \
+  "0 4 1 2 2 phenotype 1 2 1 1 1 1\n"
+
+// Individual 3 has Mendelian errors at loci 0 (mother 2/2), 1 (both
+// parents 1/1) and 3 (father 1/1)
+#define INCONSISTENT_PEDIGREE_STR									  \
+  "0 1 0 0 1 phenotype 1 1 1 1 1 2 1 1\n"								  \
+  "0 2 0 0 2 phenotype 2 2 1 1 1 2 0 0\n"								  \
+  "0 3 1 2 2 phenotype 1 1 1 2 2 2 2 2\n"
+
+typedef zrhcstar_t::pedigree_t mped_t;
+
+inline void
+read_pedigree(const std::string& str, mped_t& ped,
+				  const zrhcstar_t& zrhcstar= zrhcstar_t()) {
+  std::istringstream is(str);
+  zrhcstar.read_pedigree(is, ped);
+}
+
+// Read the pedigree and encode it with 'zrhcstar'
+inline pedcnf_t*
+prepare_cnf(const std::string& str, mped_t& ped,
+				const zrhcstar_t& zrhcstar= zrhcstar_t()) {
+  read_pedigree(str, ped, zrhcstar);
+  pedcnf_t* cnf;
+  zrhcstar.prepare_sat(ped, cnf);
+  return cnf;
+}
+
+// Fixture that provides a path in the temporary directory, which is
+// removed (with its content) after each test
+class temp_path_test_t: public ::testing::Test {
+protected:
+  boost::filesystem::path tmp_path;
+
+  virtual void SetUp() {
+	 tmp_path= boost::filesystem::temp_directory_path() /
+		boost::filesystem::unique_path("zrhc-test-%%%%-%%%%-%%%%");
+  }
+
+  virtual void TearDown() {
+	 boost::system::error_code ec;
+	 boost::filesystem::remove_all(tmp_path, ec);
+  }
+};
+
+#endif // __TEST_PEDIGREES_HPP__